@@ -13,12 +13,14 @@
 #include "wrappers/WrapperIncludes.h"
 #include "wrappers/ExampleWrapper.h"
 #include "wrappers/KCoreWrapper.h"
+#include "wrappers/KCoreMaintenanceWrapper.h"
 #include "wrappers/NodePageRankWrapper.h"
 #include "wrappers/BFSMomentsWrapper.h"
 #include "wrappers/ClusteringCoefficientWrapper.h"
 #include "wrappers/MotifWrapper.h"
 #include "wrappers/AttractionBasinWrapper.h"
 #include "wrappers/FlowWrapper.h"
+#include "wrappers/ClosenessWrapper.h"
 
 #ifdef __NVCC__
 // GPU features
@@ -42,12 +44,14 @@ BOOST_PYTHON_MODULE(_features)
 	// Regular features
 	BoostDefExampleCalculator();
 	BoostDefKCore();
+	BoostDefKCoreMaintenance();
 	BoostDefNodePageRank();
 	BoostDefClusteringCoefficient();
 	BoostDefBFSMoments();
 	BoostDefMotif();
 	BoostDefAttractionBasinCalculator();
 	BoostDefFlowCalculator();
+	BoostDefCloseness();
 
 #ifdef __NVCC__	
 	BoostDefGPUMotifCalculator();
@@ -113,6 +113,25 @@ def benchmark_feature_erdos_renyi(feature_name, python=False, p=0.8):
         if python:
             timer.stop()
 
+def benchmark_motif_neighbor_index(level=4, m=10):
+    """
+    Benchmark the motif calculation with and without the neighbor index of the CacheGraph.
+    The graphs are scale free, so the hubs get their neighbors indexed.
+    """
+    nodes = [100, 500, 1000, 2000, 5000, 10000]
+    titles = ['Conversion Time', 'Feature calculation time']
+
+    for use_index in [False, True]:
+        timer = FeatureTimer('Motif{}_{}_benchmark'.format(level, 'index' if use_index else 'no_index'),
+                             titles=titles)
+        for n in nodes:
+            G = nx.barabasi_albert_graph(n, m, seed=SEED)
+            run_id = '{}_nodes_and_{}_edges'.format(n, G.size())
+            print(run_id)
+            timer.start(run_id)
+            motif(G, level=level, timer=timer, neighbor_index=use_index)
+
+
 def run_all_feature_with_gpu_tests_regular_graphs():
 	for feature_name in matching_python_functions.keys():
 		print(feature_name)
@@ -1,5 +1,10 @@
 from src.accelerated_graph_features.graph_converter import convert_graph_to_db_dict
 
+# The node orderings the C++ code can relabel the graph with for cache locality (see NodeOrdering).
+# The results are always returned in the original order of the nodes, and don't depend on the
+# ordering (the C++ tests check this for the directed k-core and clustering too).
+NODE_ORDERINGS = {'original': 0, 'degree': 1, 'rcm': 2, 'community': 3}
+
 
 class FeatureWrapper(object):
     """
@@ -7,6 +12,7 @@ class FeatureWrapper(object):
     The decorator is responsible for doing the tasks that are common to all wrapper functions:
          - Converting the nx.Graph object to a converted graph dictionary.
          - Marking the time for conversion and calculation (if timer is given)
+         - Selecting the node ordering the graph is relabeled with (the 'reorder' argument)
     """
 
     def __init__(self, func):
@@ -17,6 +23,11 @@ class FeatureWrapper(object):
         cast_to_directed = kwargs.get('cast_to_directed', False)
 
         converted_graph = convert_graph_to_db_dict(graph, with_weights, cast_to_directed)
+        reorder = kwargs.get('reorder', 'original')
+        if reorder not in NODE_ORDERINGS:
+            raise ValueError("Unknown node ordering '{}', expected one of {}".format(
+                reorder, sorted(NODE_ORDERINGS)))
+        converted_graph['ordering'] = NODE_ORDERINGS[reorder]
         if 'timer' in kwargs:
             kwargs['timer'].mark()
 
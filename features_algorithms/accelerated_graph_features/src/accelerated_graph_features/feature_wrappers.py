@@ -25,13 +25,33 @@ def example_feature(graph, **kargs):
 
 @FeatureWrapper
 def clustering_coefficient(graph, **kwargs):
+    """
+    The average clustering coefficient of the graph, or with per_node=True the list of the local
+    clustering coefficients of the nodes.
+    Directed graphs get Fagiolo's clustering and weighted graphs (with_weights=True) Onnela's, as in networkx.
+    For a directed graph, per_node=True can also take the 'clustering_type' argument: 'total' (the default),
+    'cycle', 'middleman', 'in' or 'out'.
+    """
     import src.accelerated_graph_features._features as feat
 
+    if kwargs.get('per_node', False):
+        types = ['total', 'cycle', 'middleman', 'in', 'out']
+        return feat.local_clustering_coefficient(graph, types.index(kwargs.get('clustering_type', 'total')))
+
     res = feat.clustering_coefficient(graph)
 
     return res
 
 
+@FeatureWrapper
+def transitivity(graph, **kwargs):
+    import src.accelerated_graph_features._features as feat
+
+    res = feat.transitivity(graph)
+
+    return res
+
+
 @FeatureWrapper
 def k_core(graph, **kwargs):
     import src.accelerated_graph_features._features as feat
@@ -41,22 +61,74 @@ def k_core(graph, **kwargs):
     return res
 
 
+@FeatureWrapper
+def k_core_maintenance(graph, **kwargs):
+    """
+    Returns a KCoreMaintenance object that keeps the core numbers of the graph up to date:
+    call insert_edges / remove_edges with lists of (source, target) tuples, and cores() for the current core numbers.
+    """
+    import src.accelerated_graph_features._features as feat
+
+    return feat.KCoreMaintenance(graph)
+
+
 @FeatureWrapper
 def node_page_rank(graph, **kwargs):
     import src.accelerated_graph_features._features as feat
 
     dumping = kwargs.get('dumping', 0.85)
     max_iter = kwargs.get('max_iters', 100)
+    tolerance = kwargs.get('tolerance', 1e-6)
 
-    res = feat.node_page_rank(graph, dumping, max_iter)
+    res = feat.node_page_rank(graph, dumping, max_iter, tolerance)
 
     return res
 
 
+@FeatureWrapper
+def personalized_page_rank(graph, **kwargs):
+    """
+    The personalized page rank for every seed set in the 'seed_sets' argument (a list of lists of nodes).
+    By default all of the seed sets are computed together by power iteration, and a list of rank lists is returned.
+    With push=True the ranks are approximated locally around the seeds (with an L1 error of at most
+    epsilon times the number of edges), and a list of {node: rank} dictionaries is returned.
+    """
+    import src.accelerated_graph_features._features as feat
+
+    seed_sets = [list(seeds) for seeds in kwargs['seed_sets']]
+    dumping = kwargs.get('dumping', 0.85)
+
+    if kwargs.get('push', False):
+        epsilon = kwargs.get('epsilon', 1e-6)
+        return feat.personalized_page_rank_push(graph, seed_sets, dumping, epsilon)
+
+    max_iter = kwargs.get('max_iters', 100)
+    tolerance = kwargs.get('tolerance', 1e-6)
+    return feat.personalized_page_rank(graph, seed_sets, dumping, max_iter, tolerance)
+
+
 @FeatureWrapper
 def bfs_moments(graph, **kwargs):
+    """
+    The (mean, std) of the distances of every node.
+    With k=<number of pivots> the moments are estimated from BFS traversals from k sampled pivots
+    ('seed' picks the sample, and stratified=True samples the pivots by degree), and every node gets
+    (mean, std, mean CI, std CI), the last two being the half widths of the 95% confidence intervals.
+    For graphs too big for either, hyperanf=<log2 of the registers per counter> (4 to 16, 6 is a
+    good start) estimates the number of nodes at every distance with HyperLogLog counters.
+    With with_weights=True the moments are of the (exact) weighted distances.
+    """
     import src.accelerated_graph_features._features as feat
 
+    if kwargs.get('with_weights', False):
+        return feat.bfs_moments_weighted(graph)
+
+    k = kwargs.get('k', 0)
+    if k > 0:
+        return feat.bfs_moments(graph, k, kwargs.get('seed', 0), kwargs.get('stratified', False))
+    if kwargs.get('hyperanf', 0) > 0:
+        return feat.bfs_moments_hyperanf(graph, kwargs['hyperanf'], kwargs.get('seed', 0))
+
     res = feat.bfs_moments(graph)
 
     return res
@@ -64,10 +136,23 @@ def bfs_moments(graph, **kwargs):
 
 @FeatureWrapper
 def attraction_basin(graph, **kwargs):
+    """
+    With k=<number of pivots> the features are estimated from k sampled pivots as in bfs_moments,
+    and every node gets (attraction basin, CI). hyperanf=<log2 of the registers per counter> estimates
+    the features with HyperLogLog counters as in bfs_moments.
+    """
     import src.accelerated_graph_features._features as feat
 
     alpha = kwargs.get('alpha', 2)
-    res = feat.attraction_basin(graph, alpha)
+    k = kwargs.get('k', 0)
+    if k > 0:
+        res = feat.attraction_basin(graph, alpha, k, kwargs.get('seed', 0), kwargs.get('stratified', False))
+        return [(float('nan'), float('nan')) if x < 0 else (x, ci) for x, ci in res]
+
+    if kwargs.get('hyperanf', 0) > 0:
+        res = feat.attraction_basin_hyperanf(graph, alpha, kwargs['hyperanf'], kwargs.get('seed', 0))
+    else:
+        res = feat.attraction_basin(graph, alpha)
     for i, x in enumerate(res):
         if x < 0:
             res[i] = float('nan')
@@ -76,14 +161,33 @@ def attraction_basin(graph, **kwargs):
 
 @FeatureWrapper
 def flow(graph, **kwargs):
+    """
+    With k=<number of pivots> the features are estimated from k sampled pivots as in bfs_moments,
+    and every node gets (flow, CI).
+    """
     import src.accelerated_graph_features._features as feat
 
     t = kwargs.get('threshold', 0)
+    k = kwargs.get('k', 0)
+    if k > 0:
+        return feat.flow(graph, t, k, kwargs.get('seed', 0), kwargs.get('stratified', False))
+
     res = feat.flow(graph, t)
 
     return res
 
 
+@FeatureWrapper
+def closeness_centrality(graph, **kwargs):
+    """
+    The closeness centrality of every node as in networkx (by the distances to the node), with
+    with_weights=True by the weighted distances.
+    """
+    import src.accelerated_graph_features._features as feat
+
+    return feat.closeness_centrality(graph, kwargs.get('with_weights', False))
+
+
 @FeatureWrapper
 def motif(graph, **kwargs):
     import src.accelerated_graph_features._features as feat
@@ -94,6 +198,8 @@ def motif(graph, **kwargs):
         raise AttributeError('Level must be specified!')
 
     gpu = kwargs.get('gpu', False)
+    # The index speeds up the edge checks, it's only turned off for benchmarking
+    graph['neighbor_index'] = kwargs.get('neighbor_index', True)
     if not gpu:
         res = feat.motif(graph, level)
     else:
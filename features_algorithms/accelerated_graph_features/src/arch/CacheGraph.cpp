@@ -8,42 +8,106 @@
  */
 
 #include "../includes/CacheGraph.h"
+#include "../includes/IntersectionUtils.h"
+#include "../includes/ParallelUtils.h"
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-void CacheGraph::Clear() {
+const char CacheGraphFormat::FILE_MAGIC[8] = { 'C', 'G', 'R', 'A', 'P', 'H', '\0',
+		'\0' };
+static const int64 CHECKSUM_SEED = 14695981039346656037ULL;
+template<typename NodeId, typename EdgeOffset>
+const unsigned char CacheGraphT<NodeId, EdgeOffset>::INDEX_LINEAR;
+template<typename NodeId, typename EdgeOffset>
+const unsigned char CacheGraphT<NodeId, EdgeOffset>::INDEX_BITMAP;
+template<typename NodeId, typename EdgeOffset>
+const unsigned int CacheGraphT<NodeId, EdgeOffset>::LINEAR_SEARCH_DEGREE;
+template<typename NodeId, typename EdgeOffset>
+const int64 CacheGraphT<NodeId, EdgeOffset>::PAGE_RANK_BLOCK;
+template<typename NodeId, typename EdgeOffset>
+const unsigned int CacheGraphT<NodeId, EdgeOffset>::PAGE_RANK_LANES;
+template<typename NodeId, typename EdgeOffset>
+const int64 CacheGraphT<NodeId, EdgeOffset>::TRIANGLE_GRAIN;
+
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::Clear() {
+	if (m_Mapping != NULL) {
+		//the arrays point into the mapping, so there is nothing to delete
+		munmap(m_Mapping, m_MappingSize);
+		m_Mapping = NULL;
+		m_MappingSize = 0;
+	} else {
+		delete[] m_Graph;
+		delete[] m_Offsets;
+		delete[] m_Weights;
+	}
+	delete[] m_CompressedControl;
+	delete[] m_CompressedData;
+	delete[] m_CompressedPositions;
+	m_CompressedControl = NULL;
+	m_CompressedData = NULL;
+	m_CompressedPositions = NULL;
 	m_NumberOfNodes = 0;
 	m_NumberOfEdges = 0;
-	delete m_Graph;
 	m_Graph = NULL;
-	delete m_Offsets;
 	m_Offsets = NULL;
+	m_Weights = NULL;
+	weighted = false;
+	m_FileName.clear();
+	m_Sections.clear();
+	//the views belong to the old data
+	delete m_Inverse;
+	m_Inverse = NULL;
+	delete m_Undirected;
+	m_Undirected = NULL;
+	delete m_Degrees;
+	m_Degrees = NULL;
+	delete m_DegreeOrder;
+	m_DegreeOrder = NULL;
+	delete m_NeighborIndex.exchange(NULL);
 }
 
 /*
  Initialize the graph from two lists (the offset list and the adjacency list).
+ The lists are converted to the index widths of the graph, which must fit them (see Fits).
  */
-void CacheGraph::Assign(const std::vector<int64>& NodeOffsets,
-		const std::vector<unsigned int>& Neighbours) {
+template<typename NodeId, typename EdgeOffset>
+template<typename ListId>
+void CacheGraphT<NodeId, EdgeOffset>::Assign(const std::vector<int64>& NodeOffsets,
+		const std::vector<ListId>& Neighbours) {
 	//Clear the graph so we can assign new data
 	Clear();
 
+	if (NodeOffsets.empty())
+		throw std::invalid_argument(
+				"The offset list must have an entry for every node and one past the last");
+	if (!Fits(NodeOffsets.size() - 1, NodeOffsets.back()))
+		throw std::overflow_error(
+				"The graph is too large for the index widths of the CacheGraph");
+
 	//copy the offset list into a new array
-	m_NumberOfNodes = static_cast<unsigned int>(NodeOffsets.size() - 1);
-	m_Offsets = new int64[m_NumberOfNodes + 1];
-	std::memcpy(m_Offsets, &NodeOffsets[0], NodeOffsets.size() * sizeof(int64));
+	m_NumberOfNodes = static_cast<NodeId>(NodeOffsets.size() - 1);
+	m_Offsets = new EdgeOffset[m_NumberOfNodes + 1];
+	std::copy(NodeOffsets.begin(), NodeOffsets.end(), m_Offsets);
 
 	m_NumberOfEdges = m_Offsets[m_NumberOfNodes];
 	//copy the adjacency list into a new array
-	m_Graph = new unsigned int[m_NumberOfEdges];
-	std::memcpy(m_Graph, &Neighbours[0],
-			Neighbours.size() * sizeof(unsigned int));
+	m_Graph = new NodeId[m_NumberOfEdges];
+	std::copy(Neighbours.begin(), Neighbours.end(), m_Graph);
 	/*	LOG(INFO) << m_NumberOfNodes << '\t' << m_Offsets[m_NumberOfNodes];
 	 //std::cout << "Nodes: " << m_NumberOfNodes << " Edges:" << m_NumberOfEdges
 	 << std::endl;*/
 
 }
 
-void CacheGraph::Assign(const std::vector<int64>& NodeOffsets,
-		const std::vector<unsigned int>& Neighbours,
+template<typename NodeId, typename EdgeOffset>
+template<typename ListId>
+void CacheGraphT<NodeId, EdgeOffset>::Assign(const std::vector<int64>& NodeOffsets,
+		const std::vector<ListId>& Neighbours,
 		const std::vector<double>& weights) {
 	this->Assign(NodeOffsets, Neighbours);
 	m_Weights = new double[m_NumberOfEdges];
@@ -51,88 +115,540 @@ void CacheGraph::Assign(const std::vector<int64>& NodeOffsets,
 	weighted = true;
 }
 
+/*
+ Replace the neighbor list with its compressed form (see the description in the header).
+ The encoding is done in two passes: the first finds the position of every node's gaps in the
+ data stream, and the second writes the control codes and the gaps.
+ Returns false if the graph is memory mapped, as the mapped list can't be replaced.
+ */
+template<typename NodeId, typename EdgeOffset>
+bool CacheGraphT<NodeId, EdgeOffset>::Compress() {
+	if (isCompressed())
+		return true;
+	if (isMemoryMapped())
+		return false;
+
+	//the smallest code whose length holds the gap
+	auto GapCode = [](NodeId gap) {
+		unsigned int code = 0;
+		while (code < 3 && gap > CompressedMask(code))
+			++code;
+		return code;
+	};
+
+	int64* positions = new int64[m_NumberOfNodes + 1];
+	positions[0] = 0;
+	ParallelUtils::ParallelFor(0, m_NumberOfNodes, 1024,
+			[&](unsigned int, int64 NodeID) {
+				int64 bytes = 0;
+				NodeId previous = 0;
+				for (EdgeOffset edge = m_Offsets[NodeID];
+						edge < m_Offsets[NodeID + 1]; ++edge) {
+					bytes += CompressedLength(GapCode(m_Graph[edge] - previous));
+					previous = m_Graph[edge];
+				}
+				positions[NodeID + 1] = bytes;
+			});
+	ParallelUtils::InclusiveScan(positions + 1, m_NumberOfNodes);
+
+	//four codes per control byte, and the data is padded for DecodeGap
+	const int64 ControlBytes = m_NumberOfEdges / 4 + 1;
+	unsigned char* control = new unsigned char[ControlBytes]();
+	unsigned char* data = new unsigned char[positions[m_NumberOfNodes]
+			+ sizeof(NodeId)]();
+	//the control bytes are shared between neighboring lists, so this pass is sequential
+	for (NodeId NodeID = 0; NodeID < m_NumberOfNodes; ++NodeID) {
+		unsigned char* out = data + positions[NodeID];
+		NodeId previous = 0;
+		for (EdgeOffset edge = m_Offsets[NodeID]; edge < m_Offsets[NodeID + 1];
+				++edge) {
+			const NodeId gap = m_Graph[edge] - previous;
+			const unsigned int code = GapCode(gap);
+			control[edge >> 2] |= code << ((edge & 3) << 1);
+			std::memcpy(out, &gap, CompressedLength(code));
+			out += CompressedLength(code);
+			previous = m_Graph[edge];
+		}
+	}
+
+	delete[] m_Graph;
+	m_Graph = NULL;
+	m_CompressedControl = control;
+	m_CompressedData = data;
+	m_CompressedPositions = positions;
+	return true;
+}
+
+/*
+ Restore the raw neighbor list of a compressed graph.
+ */
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::Decompress() {
+	if (!isCompressed())
+		return;
+	NodeId* graph = new NodeId[m_NumberOfEdges];
+	ParallelUtils::ParallelFor(0, m_NumberOfNodes, 1024,
+			[&](unsigned int, int64 NodeID) {
+				NodeId* out = graph + m_Offsets[NodeID];
+				for (NodeId neighbor : neighbors(NodeID))
+					*out++ = neighbor;
+			});
+	delete[] m_CompressedControl;
+	delete[] m_CompressedData;
+	delete[] m_CompressedPositions;
+	m_CompressedControl = NULL;
+	m_CompressedData = NULL;
+	m_CompressedPositions = NULL;
+	m_Graph = graph;
+}
+
+/*
+ The neighbor list of a node as an array: the raw list, or if the graph is compressed the list
+ decoded into buffer.
+ */
+template<typename NodeId, typename EdgeOffset>
+const NodeId* CacheGraphT<NodeId, EdgeOffset>::NeighborListOf(NodeId node,
+		std::vector<NodeId>& buffer) const {
+	if (!isCompressed())
+		return m_Graph + m_Offsets[node];
+	buffer.clear();
+	for (NodeId neighbor : neighbors(node))
+		buffer.push_back(neighbor);
+	return buffer.data();
+}
+
+/*
+ A simple 64 bit FNV-1a style checksum, computed a word at a time so that it is cheap
+ compared to reading the data from the disk.
+ */
+int64 CacheGraphFormat::Checksum(const void* data, int64 size, int64 seed) {
+	const int64 PRIME = 1099511628211ULL;
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	int64 hash = seed;
+	int64 NumberOfWords = size / sizeof(int64);
+	for (int64 i = 0; i < NumberOfWords; i++) {
+		int64 word;
+		std::memcpy(&word, bytes + i * sizeof(int64), sizeof(int64));
+		hash = (hash ^ word) * PRIME;
+	}
+	for (int64 i = NumberOfWords * sizeof(int64); i < size; i++)
+		hash = (hash ^ bytes[i]) * PRIME;
+	return hash;
+}
+
+/*
+ Read the header of a graph file, and check that it is a graph file of our version.
+ */
+bool CacheGraphFormat::ReadFileHeader(const std::string& FileName,
+		FileHeader& header) {
+	std::memset(&header, 0, sizeof(FileHeader));
+	FILE* hFile = std::fopen(FileName.c_str(), "rb");
+	if (hFile == NULL)
+		return false;
+	bool success = std::fread(&header, sizeof(FileHeader), 1, hFile) == 1;
+	std::fclose(hFile);
+	hFile = NULL;
+	return success
+			&& std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0
+			&& header.version == FILE_VERSION;
+}
+
+bool CacheGraphFormat::ReadFileWidths(const std::string& FileName,
+		unsigned int& NodeIdSize, unsigned int& OffsetSize) {
+	FileHeader header;
+	if (!ReadFileHeader(FileName, header))
+		return false;
+	NodeIdSize = header.nodeIdSize;
+	OffsetSize = header.offsetSize;
+	return true;
+}
+
 /*
  Save the graph to a binary file.
+ The file consists of a header, a section table and the sections themselves:
+ [header][section table][offsets][neighbors][weights]...[derived sections]
+ DerivedSections is a combination of DerivedSection flags, selecting which derived
+ structures to precompute and save alongside the graph, so that they can be loaded
+ instead of recomputed.
  */
-bool CacheGraph::SaveToFile(const std::string& FileName) const {
+template<typename NodeId, typename EdgeOffset>
+bool CacheGraphT<NodeId, EdgeOffset>::SaveToFile(const std::string& FileName,
+		unsigned int DerivedSections) const {
+	//compute the derived structures we were asked to save
+	CacheGraphT inverse(directed), undirected(false);
+	if (DerivedSections & (SAVE_INVERSE | SAVE_UNDIRECTED))
+		InverseGraph(inverse);
+	if (DerivedSections & SAVE_UNDIRECTED)
+		CreateUndirectedGraph(inverse, undirected);
+	std::vector<NodeId> Degrees;
+	if (DerivedSections & SAVE_DEGREES)
+		Degrees = ComputeNodeDegrees();
+	std::vector<NodeId>* DegreeOrder = NULL;
+	if (DerivedSections & SAVE_DEGREE_ORDER)
+		DegreeOrder = SortedNodesByDegree();
+
+	//the file always holds the raw neighbor list
+	const NodeId* Neighbors = m_Graph;
+	std::vector<NodeId> DecodedNeighbors;
+	if (isCompressed()) {
+		DecodedNeighbors.reserve(m_NumberOfEdges);
+		for (NodeId NodeID = 0; NodeID < m_NumberOfNodes; ++NodeID)
+			for (NodeId neighbor : neighbors(NodeID))
+				DecodedNeighbors.push_back(neighbor);
+		Neighbors = DecodedNeighbors.data();
+	}
+
+	//list all the sections and the data they hold
+	std::vector<FileSection> sections;
+	std::vector<const void*> data;
+	auto AddSection = [&sections, &data](unsigned int kind,
+			unsigned int elementSize, const void* values, int64 count) {
+		FileSection section = { kind, elementSize, 0, count, 0 };
+		sections.push_back(section);
+		data.push_back(values);
+	};
+	AddSection(SECTION_OFFSETS, sizeof(EdgeOffset), m_Offsets,
+			m_NumberOfNodes + 1);
+	AddSection(SECTION_NEIGHBORS, sizeof(NodeId), Neighbors,
+			m_NumberOfEdges);
+	if (weighted)
+		AddSection(SECTION_WEIGHTS, sizeof(double), m_Weights,
+				m_NumberOfEdges);
+	if (DerivedSections & SAVE_INVERSE) {
+		AddSection(SECTION_INVERSE_OFFSETS, sizeof(EdgeOffset),
+				inverse.m_Offsets, m_NumberOfNodes + 1);
+		AddSection(SECTION_INVERSE_NEIGHBORS,
+				sizeof(NodeId), inverse.m_Graph, inverse.m_NumberOfEdges);
+		if (inverse.weighted)
+			AddSection(SECTION_INVERSE_WEIGHTS, sizeof(double),
+					inverse.m_Weights, inverse.m_NumberOfEdges);
+	}
+	if (DerivedSections & SAVE_UNDIRECTED) {
+		AddSection(SECTION_UNDIRECTED_OFFSETS, sizeof(EdgeOffset),
+				undirected.m_Offsets, m_NumberOfNodes + 1);
+		AddSection(SECTION_UNDIRECTED_NEIGHBORS,
+				sizeof(NodeId), undirected.m_Graph,
+				undirected.m_NumberOfEdges);
+		if (undirected.weighted)
+			AddSection(SECTION_UNDIRECTED_WEIGHTS,
+					sizeof(double), undirected.m_Weights,
+					undirected.m_NumberOfEdges);
+	}
+	if (DerivedSections & SAVE_DEGREES)
+		AddSection(SECTION_DEGREES, sizeof(NodeId),
+				Degrees.data(), m_NumberOfNodes);
+	if (DerivedSections & SAVE_DEGREE_ORDER)
+		AddSection(SECTION_DEGREE_ORDER, sizeof(NodeId),
+				DegreeOrder->data(), m_NumberOfNodes);
+
+	//lay the sections out one after the other, each at an aligned position
+	FileHeader header;
+	std::memset(&header, 0, sizeof(FileHeader));
+	std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+	header.version = FILE_VERSION;
+	header.flags = (weighted ? FILE_FLAG_WEIGHTED : 0)
+			| (directed ? FILE_FLAG_DIRECTED : 0);
+	header.nodeIdSize = sizeof(NodeId);
+	header.offsetSize = sizeof(EdgeOffset);
+	header.numberOfNodes = m_NumberOfNodes;
+	header.numberOfEdges = m_NumberOfEdges;
+	header.numberOfSections = sections.size();
+	header.sectionTablePosition = sizeof(FileHeader);
+	int64 position = header.sectionTablePosition
+			+ sections.size() * sizeof(FileSection);
+	for (unsigned int i = 0; i < sections.size(); i++) {
+		int64 size = sections[i].count * sections[i].elementSize;
+		sections[i].position = AlignFilePosition(position);
+		sections[i].checksum = Checksum(data[i], size, CHECKSUM_SEED);
+		position = sections[i].position + size;
+	}
+	header.checksum = Checksum(&sections[0],
+			sections.size() * sizeof(FileSection),
+			Checksum(&header, sizeof(FileHeader), CHECKSUM_SEED));
 
 	//open or create a file of a binary format
 	FILE* hFile = std::fopen(FileName.c_str(), "w+b");
+	bool success = hFile != NULL;
 
-	//write the class variables to the file
-	std::fwrite(&m_NumberOfNodes, sizeof(unsigned int), 1, hFile);
-	std::fwrite(&m_NumberOfEdges, sizeof(int64), 1, hFile);
-	std::fwrite(m_Offsets, sizeof(int64), m_NumberOfNodes + 1, hFile);
-	std::fwrite(m_Graph, sizeof(unsigned int), m_NumberOfEdges, hFile);
-	std::fwrite(&weighted, sizeof(bool), 1, hFile);
-	if (weighted)
-		std::fwrite(m_Weights, sizeof(double), m_NumberOfEdges, hFile);
-	std::fwrite(&directed, sizeof(bool), 1, hFile);
+	//write the header, the section table and then every section at its position
+	success = success
+			&& std::fwrite(&header, sizeof(FileHeader), 1, hFile) == 1
+			&& std::fwrite(&sections[0], sizeof(FileSection), sections.size(),
+					hFile) == sections.size();
+	for (unsigned int i = 0; i < sections.size() && success; i++) {
+		success = std::fseek(hFile, sections[i].position, SEEK_SET) == 0
+				&& std::fwrite(data[i], sections[i].elementSize,
+						sections[i].count, hFile) == (size_t) sections[i].count;
+	}
 
 	//close the file
-	std::fclose(hFile);
+	if (hFile != NULL)
+		success = (std::fclose(hFile) == 0) && success;
 	hFile = NULL;
+	delete DegreeOrder;
 
-	//LOG(INFO) << m_NumberOfNodes << '\t' << m_Offsets[m_NumberOfNodes];
-//	//std::cout << m_NumberOfNodes << '\t' << m_Offsets[m_NumberOfNodes];
+	return success;
 
+}
+
+/*
+ Read the data from the binary file
+ */
+template<typename NodeId, typename EdgeOffset>
+bool CacheGraphT<NodeId, EdgeOffset>::LoadFromFile(const std::string& FileName) {
+	return LoadSections(FileName, false, SECTION_OFFSETS, SECTION_NEIGHBORS,
+			SECTION_WEIGHTS);
+}
+
+/*
+ Map the binary file into memory instead of reading it.
+ The offsets, neighbors and weights arrays point directly into a read-only shared mapping,
+ so loading takes constant time and all the processes that map the same file share
+ a single copy of it in the page cache.
+ The mapping is released when the graph is cleared or destroyed.
+ Note that the checksums of the mapped sections are not verified, as that would require
+ reading the entire file.
+ */
+template<typename NodeId, typename EdgeOffset>
+bool CacheGraphT<NodeId, EdgeOffset>::MapFromFile(const std::string& FileName) {
+	return LoadSections(FileName, true, SECTION_OFFSETS, SECTION_NEIGHBORS,
+			SECTION_WEIGHTS);
+}
+
+/*
+ Load the inverse graph from the file this graph was loaded from, if it was saved there.
+ The inverse graph is loaded in the same way (read or mapped) as this graph.
+ Returns false if there is no such section, in which case the inverse graph should be
+ computed with InverseGraph.
+ */
+template<typename NodeId, typename EdgeOffset>
+bool CacheGraphT<NodeId, EdgeOffset>::LoadInverseGraph(CacheGraphT& InvertedGraph) const {
+	if (FindSection(SECTION_INVERSE_OFFSETS) == NULL)
+		return false;
+	if (!InvertedGraph.LoadSections(m_FileName, isMemoryMapped(),
+			SECTION_INVERSE_OFFSETS, SECTION_INVERSE_NEIGHBORS,
+			SECTION_INVERSE_WEIGHTS))
+		return false;
+	//the derived graph doesn't own the other sections of the file
+	InvertedGraph.directed = directed;
+	InvertedGraph.m_FileName.clear();
+	InvertedGraph.m_Sections.clear();
 	return true;
+}
 
+/*
+ Load the undirected graph from the file this graph was loaded from, if it was saved there.
+ Returns false if there is no such section, in which case the undirected graph should be
+ computed with CreateUndirectedGraph.
+ */
+template<typename NodeId, typename EdgeOffset>
+bool CacheGraphT<NodeId, EdgeOffset>::LoadUndirectedGraph(CacheGraphT& UndirectedGraph) const {
+	if (FindSection(SECTION_UNDIRECTED_OFFSETS) == NULL)
+		return false;
+	if (!UndirectedGraph.LoadSections(m_FileName, isMemoryMapped(),
+			SECTION_UNDIRECTED_OFFSETS, SECTION_UNDIRECTED_NEIGHBORS,
+			SECTION_UNDIRECTED_WEIGHTS))
+		return false;
+	UndirectedGraph.directed = false;
+	UndirectedGraph.m_FileName.clear();
+	UndirectedGraph.m_Sections.clear();
+	return true;
 }
 
 /*
- Read the data from the binary file
+ Load a graph from the sections of the given kinds in a graph file.
+ Only the header, the section table and the requested sections are read; the weights
+ section is optional.
+ If memoryMapped is true, the file is mapped into memory instead of read.
+ Returns false if the file is missing, is not a graph file of our version and layout,
+ or if it is corrupt.
  */
-bool CacheGraph::LoadFromFile(const std::string& FileName) {
+template<typename NodeId, typename EdgeOffset>
+bool CacheGraphT<NodeId, EdgeOffset>::LoadSections(const std::string& FileName, bool memoryMapped,
+		unsigned int offsetsKind, unsigned int graphKind,
+		unsigned int weightsKind) {
 	Clear();
-	FILE* hFile;
-	//if (!Utilities::FileExists(FileName)) { LOG(ERROR) << " Missing network file. Run CacheGraph::LoadFromFile - " << FileName; return false; }
-	//open network file
-	try {
-		hFile = std::fopen(FileName.c_str(), "rb");
-	} catch (std::exception& e) {
-		/*LOG(ERROR) << " Missing network file. Run CacheGraph::LoadFromFile - " << FileName; return false;*/
-//		//std::cout << " Missing network file. Run CacheGraph::LoadFromFile - "
-//				<< FileName;
+	//open the file and read the header and section table
+	FileHeader header;
+	std::memset(&header, 0, sizeof(FileHeader));
+	std::vector<FileSection> sections;
+	int64 FileSize = 0;
+	if (memoryMapped) {
+		int hFile = open(FileName.c_str(), O_RDONLY);
+		if (hFile < 0)
+			return false;
+		struct stat FileStat;
+		if (fstat(hFile, &FileStat) != 0
+				|| FileStat.st_size < (off_t) sizeof(FileHeader)) {
+			close(hFile);
+			return false;
+		}
+		void* Mapping = mmap(NULL, FileStat.st_size, PROT_READ, MAP_SHARED,
+				hFile, 0);
+		//the mapping stays valid after the file is closed
+		close(hFile);
+		if (Mapping == MAP_FAILED)
+			return false;
+		m_Mapping = Mapping;
+		m_MappingSize = FileStat.st_size;
+		FileSize = FileStat.st_size;
+		std::memcpy(&header, m_Mapping, sizeof(FileHeader));
+		if (IsOurHeader(header, sizeof(NodeId), sizeof(EdgeOffset))
+				&& FitsInFile(header.sectionTablePosition,
+						header.numberOfSections, sizeof(FileSection), FileSize)) {
+			sections.resize(header.numberOfSections);
+			std::memcpy(sections.data(),
+					static_cast<char*>(m_Mapping)
+							+ header.sectionTablePosition,
+					header.numberOfSections * sizeof(FileSection));
+		}
+	} else {
+		FILE* hFile = std::fopen(FileName.c_str(), "rb");
+		if (hFile == NULL)
+			return false;
+		long EndPosition = -1;
+		if (std::fseek(hFile, 0, SEEK_END) == 0)
+			EndPosition = std::ftell(hFile);
+		std::rewind(hFile);
+		if (EndPosition < 0) {
+			std::fclose(hFile);
+			return false;
+		}
+		FileSize = EndPosition;
+		if (std::fread(&header, sizeof(FileHeader), 1, hFile) == 1
+				&& IsOurHeader(header, sizeof(NodeId), sizeof(EdgeOffset))
+				&& FitsInFile(header.sectionTablePosition,
+						header.numberOfSections, sizeof(FileSection), FileSize)) {
+			sections.resize(header.numberOfSections);
+			if (std::fseek(hFile, header.sectionTablePosition, SEEK_SET) != 0
+					|| std::fread(sections.data(), sizeof(FileSection),
+							sections.size(), hFile) != sections.size())
+				sections.clear();
+		}
+		std::fclose(hFile);
+		hFile = NULL;
+	}
+
+	//validate the header and the section table
+	int64 HeaderChecksum = header.checksum;
+	header.checksum = 0;
+	bool valid = IsOurHeader(header, sizeof(NodeId), sizeof(EdgeOffset))
+			&& sections.size() == header.numberOfSections
+			&& HeaderChecksum
+					== Checksum(sections.data(),
+							sections.size() * sizeof(FileSection),
+							Checksum(&header, sizeof(FileHeader),
+									CHECKSUM_SEED));
+	for (unsigned int i = 0; i < sections.size() && valid; i++)
+		valid = sections[i].position % FILE_ALIGNMENT == 0
+				&& FitsInFile(sections[i].position, sections[i].count,
+						sections[i].elementSize, FileSize);
+	if (!valid) {
+		Clear();
 		return false;
 	}
+	m_FileName = FileName;
+	m_Sections = sections;
 
-	//read the number of nodes
-	std::fread(&m_NumberOfNodes, sizeof(unsigned int), 1, hFile);
-
-	//read the number of edges
-	int64 NumberOfEdges = 0;
-	std::fread(&NumberOfEdges, sizeof(int64), 1, hFile);
-	m_NumberOfEdges = NumberOfEdges;
-	//create an array to store the indices (offsets) of the nodes in the graph array and read into it
-	m_Offsets = new int64[m_NumberOfNodes + 1];
-	std::fread(m_Offsets, sizeof(int64), m_NumberOfNodes + 1, hFile);
-
-	//create the main array containing the lists of neighbors.
-	/*
-	 NOTE:
-	 Here there is an assumption of a directed graph.
-	 An undirected graph is created by having two edges saved in the file for each edge
-	 in the network.
-	 */
-	m_Graph = new unsigned int[NumberOfEdges];
-	std::fread(m_Graph, sizeof(unsigned int), NumberOfEdges, hFile);
-	std::fread(&weighted, sizeof(bool), 1, hFile);
-	if (weighted)
-		std::fread(m_Weights, sizeof(double), m_NumberOfEdges, hFile);
-	std::fread(&directed, sizeof(bool), 1, hFile);
+	//we must have the offsets and neighbors, the weights are optional
+	const FileSection* offsets = FindSection(offsetsKind);
+	const FileSection* graph = FindSection(graphKind);
+	const FileSection* weights = FindSection(weightsKind);
+	if (offsets == NULL || graph == NULL
+			|| offsets->count != header.numberOfNodes + 1
+			|| offsets->elementSize != sizeof(EdgeOffset)
+			|| graph->elementSize != sizeof(NodeId)
+			|| (weights != NULL
+					&& (weights->count != graph->count
+							|| weights->elementSize != sizeof(double)))) {
+		Clear();
+		return false;
+	}
+	m_NumberOfNodes = static_cast<NodeId>(header.numberOfNodes);
+	m_NumberOfEdges = graph->count;
+	directed = (header.flags & FILE_FLAG_DIRECTED) != 0;
+	weighted = weights != NULL;
 
+	bool success = true;
+	if (memoryMapped) {
+		char* base = static_cast<char*>(m_Mapping);
+		m_Offsets = reinterpret_cast<EdgeOffset*>(base + offsets->position);
+		m_Graph = reinterpret_cast<NodeId*>(base + graph->position);
+		if (weighted)
+			m_Weights = reinterpret_cast<double*>(base + weights->position);
+	} else {
+		//create an array to store the indices (offsets) of the nodes in the graph array and read into it
+		m_Offsets = new EdgeOffset[m_NumberOfNodes + 1];
+		success = ReadSection(offsetsKind, m_Offsets, m_NumberOfNodes + 1);
+
+		//create the main array containing the lists of neighbors.
+		/*
+		 NOTE:
+		 Here there is an assumption of a directed graph.
+		 An undirected graph is created by having two edges saved in the file for each edge
+		 in the network.
+		 */
+		m_Graph = new NodeId[m_NumberOfEdges];
+		success = success
+				&& ReadSection(graphKind, m_Graph, m_NumberOfEdges);
+		if (weighted) {
+			m_Weights = new double[m_NumberOfEdges];
+			success = success
+					&& ReadSection(weightsKind, m_Weights, m_NumberOfEdges);
+		}
+	}
+	if (!success)
+		Clear();
+	return success;
+}
+
+template<typename NodeId, typename EdgeOffset>
+const typename CacheGraphT<NodeId, EdgeOffset>::FileSection* CacheGraphT<NodeId, EdgeOffset>::FindSection(
+		unsigned int kind) const {
+	for (unsigned int i = 0; i < m_Sections.size(); i++)
+		if (m_Sections[i].kind == kind)
+			return &m_Sections[i];
+	return NULL;
+}
+
+/*
+ Copy count elements of the section of the given kind into destination.
+ When the graph isn't mapped, the section is read from the file and its checksum is verified.
+ Returns false if the file has no such section, if its size doesn't match, or if it is corrupt.
+ */
+template<typename NodeId, typename EdgeOffset>
+bool CacheGraphT<NodeId, EdgeOffset>::ReadSection(unsigned int kind, void* destination,
+		int64 count) const {
+	const FileSection* section = FindSection(kind);
+	if (section == NULL || section->count != count)
+		return false;
+	int64 size = section->count * section->elementSize;
+	if (size == 0)
+		return true;
+	if (m_Mapping != NULL) {
+		std::memcpy(destination,
+				static_cast<const char*>(m_Mapping) + section->position, size);
+		return true;
+	}
+
+	FILE* hFile = std::fopen(m_FileName.c_str(), "rb");
+	if (hFile == NULL)
+		return false;
+	bool success = std::fseek(hFile, section->position, SEEK_SET) == 0
+			&& std::fread(destination, section->elementSize, section->count,
+					hFile) == (size_t) section->count;
 	std::fclose(hFile);
 	hFile = NULL;
-	return true;
-
+	return success
+			&& Checksum(destination, size, CHECKSUM_SEED) == section->checksum;
 }
 
 /*
  Utility function: create the full path from the directory and the file name and then call the
  overloaded function.
  */
-bool CacheGraph::LoadFromFile(const std::string& DirectroyName,
+template<typename NodeId, typename EdgeOffset>
+bool CacheGraphT<NodeId, EdgeOffset>::LoadFromFile(const std::string& DirectroyName,
 		const std::string& BaseFileName) {
 	std::string FileName = GetFileNameFromFolder(DirectroyName, BaseFileName);
 	return LoadFromFile(FileName);
@@ -141,7 +657,8 @@ bool CacheGraph::LoadFromFile(const std::string& DirectroyName,
 /*
  Utility function: append the directory and file names into one string
  */
-std::string CacheGraph::GetFileNameFromFolder(const std::string& DirectroyName,
+template<typename NodeId, typename EdgeOffset>
+std::string CacheGraphT<NodeId, EdgeOffset>::GetFileNameFromFolder(const std::string& DirectroyName,
 		const std::string& BaseFileName) {
 	std::stringstream FileName;
 	FileName << DirectroyName << BaseFileName << "_" << std::setfill('0')
@@ -149,220 +666,714 @@ std::string CacheGraph::GetFileNameFromFolder(const std::string& DirectroyName,
 	return FileName.str();
 }
 
+/*
+ The inverse of the graph, see InverseGraph.
+ */
+template<typename NodeId, typename EdgeOffset>
+const CacheGraphT<NodeId, EdgeOffset>& CacheGraphT<NodeId, EdgeOffset>::inverse() const {
+	std::lock_guard<std::recursive_mutex> lock(m_ViewsMutex);
+	if (m_Inverse == NULL) {
+		CacheGraphT* InvertedGraph = new CacheGraphT(directed);
+		if (!LoadInverseGraph(*InvertedGraph))
+			InverseGraph(*InvertedGraph);
+		m_Inverse = InvertedGraph;
+	}
+	return *m_Inverse;
+}
+
+/*
+ The undirected version of the graph, see CreateUndirectedGraph.
+ */
+template<typename NodeId, typename EdgeOffset>
+const CacheGraphT<NodeId, EdgeOffset>& CacheGraphT<NodeId, EdgeOffset>::undirected() const {
+	std::lock_guard<std::recursive_mutex> lock(m_ViewsMutex);
+	if (m_Undirected == NULL) {
+		CacheGraphT* UndirectedGraph = new CacheGraphT(false);
+		if (!LoadUndirectedGraph(*UndirectedGraph))
+			CreateUndirectedGraph(inverse(), *UndirectedGraph);
+		m_Undirected = UndirectedGraph;
+	}
+	return *m_Undirected;
+}
+
+/*
+ The (out) degree of every node, see ComputeNodeDegrees.
+ */
+template<typename NodeId, typename EdgeOffset>
+const std::vector<NodeId>& CacheGraphT<NodeId, EdgeOffset>::degrees() const {
+	std::lock_guard<std::recursive_mutex> lock(m_ViewsMutex);
+	if (m_Degrees == NULL)
+		m_Degrees = new std::vector<NodeId>(ComputeNodeDegrees());
+	return *m_Degrees;
+}
+
+/*
+ The nodes sorted in descending order of degree, see SortedNodesByDegree.
+ */
+template<typename NodeId, typename EdgeOffset>
+const std::vector<NodeId>& CacheGraphT<NodeId, EdgeOffset>::degreeOrder() const {
+	std::lock_guard<std::recursive_mutex> lock(m_ViewsMutex);
+	if (m_DegreeOrder == NULL)
+		m_DegreeOrder = SortedNodesByDegree();
+	return *m_DegreeOrder;
+}
+
 /*
  Assuming our graph is directed, generate the inverted graph.
  i.e. change every edge e=(a,b) to (b,a) in the inverted graph.
+ The weights (if any) move with their edges, and the neighbor lists of the inverted graph
+ are sorted, as areNeighbors requires.
+
+ The inversion runs in parallel: every thread handles a contiguous range of source nodes
+ (balanced by the number of edges) and counts the in-degrees it contributes in its own histogram.
+ The histograms are then turned into the offsets of the inverted graph and into a starting
+ position for every thread within every inverted list, so the threads can scatter their edges
+ without synchronization. Since the ranges are ordered by the thread index, and each thread scans
+ its sources in order, every inverted list comes out sorted.
  */
-void CacheGraph::InverseGraph(CacheGraph& InvertedGraph) const {
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::InverseGraph(CacheGraphT& InvertedGraph) const {
 	//get the number of edges in the graph
 	const int64 NumberOfEdges = m_Offsets[m_NumberOfNodes];
 	//clear the inverted graph
 	InvertedGraph.Clear();
 	//assign the member variables to the inverted graph
 	InvertedGraph.m_NumberOfNodes = m_NumberOfNodes;
+	InvertedGraph.m_NumberOfEdges = NumberOfEdges;
 	//allocate the needed memory
-	InvertedGraph.m_Offsets = new int64[m_NumberOfNodes + 1];
-	InvertedGraph.m_Graph = new unsigned int[NumberOfEdges];
-//	InvertedGraph.m_Weights = new double[NumberOfEdges]; // TODO M_WEIGHTS
-
-	//invert the adjancency list
-	unsigned int* InDegrees = new unsigned int[m_NumberOfNodes];
-	std::memset(InDegrees, 0, m_NumberOfNodes * sizeof(unsigned int));
-	for (const unsigned int* p = m_Graph; p < m_Graph + NumberOfEdges; ++p) {
-		++InDegrees[*p];
-	}
-	InvertedGraph.m_Offsets[0] = 0;
-	std::partial_sum(InDegrees, InDegrees + m_NumberOfNodes,
-			InvertedGraph.m_Offsets + 1);
-	for (unsigned int NodeID = 0; NodeID < m_NumberOfNodes; ++NodeID) {
-//		for (const unsigned int* peer = m_Graph + m_Offsets[NodeID];
-//				peer < m_Graph + m_Offsets[NodeID + 1]; ++peer) {
-		for (int peerIndex = m_Offsets[NodeID];
-				peerIndex < m_Offsets[NodeID + 1]; peerIndex++) {
-			unsigned int peer = m_Graph[peerIndex];
-			InvertedGraph.m_Graph[InvertedGraph.m_Offsets[peer]] = NodeID;
-//			InvertedGraph.m_Weights[InvertedGraph.m_Offsets[peer]] = m_Weights[peerIndex];  // TODO M_WEIGHTS
-			++InvertedGraph.m_Offsets[peer];
-		}
+	InvertedGraph.m_Offsets = new EdgeOffset[m_NumberOfNodes + 1];
+	InvertedGraph.m_Graph = new NodeId[NumberOfEdges];
+	if (weighted) {
+		InvertedGraph.m_Weights = new double[NumberOfEdges];
+		InvertedGraph.weighted = true;
 	}
-	InvertedGraph.m_Offsets[0] = 0;
-	std::partial_sum(InDegrees, InDegrees + m_NumberOfNodes,
-			InvertedGraph.m_Offsets + 1);
-	//clear memory
-	delete[] InDegrees;
-	InDegrees = NULL;
+	EdgeOffset* InvertedOffsets = InvertedGraph.m_Offsets;
+	NodeId* InvertedNeighbors = InvertedGraph.m_Graph;
+	double* InvertedWeights = InvertedGraph.m_Weights;
+
+	//every thread holds a histogram of all the nodes, so we limit the number of threads
+	//to keep the histograms no larger than the neighbor list
+	const unsigned int NumberOfThreads = static_cast<unsigned int>(std::min<
+			int64>(ParallelUtils::ThreadsForWork(NumberOfEdges),
+			std::max<int64>(1, NumberOfEdges / std::max<int64>(m_NumberOfNodes, 1))));
+	std::vector<NodeId> SourceBounds(NumberOfThreads + 1,
+			m_NumberOfNodes);
+	for (unsigned int t = 0; t < NumberOfThreads; t++)
+		SourceBounds[t] = std::lower_bound(m_Offsets,
+				m_Offsets + m_NumberOfNodes, NumberOfEdges * t / NumberOfThreads)
+				- m_Offsets;
+
+	//count the in-degrees contributed by each thread's range of sources
+	std::vector<std::vector<NodeId> > Histograms(NumberOfThreads);
+	ParallelUtils::RunThreads(NumberOfThreads,
+			[&](unsigned int t, unsigned int) {
+				std::vector<NodeId>& InDegrees = Histograms[t];
+				InDegrees.assign(m_NumberOfNodes, 0);
+				for (NodeId NodeID = SourceBounds[t];
+						NodeID < SourceBounds[t + 1]; ++NodeID)
+					for (NodeId peer : neighbors(NodeID))
+						++InDegrees[peer];
+			});
+
+	//sum the histograms into the in-degrees, and replace every thread's count with the position
+	//its edges start at within the inverted list
+	InvertedOffsets[0] = 0;
+	ParallelUtils::ParallelForRanges(0, m_NumberOfNodes,
+			[&](unsigned int, unsigned int, int64 begin, int64 end) {
+				for (int64 NodeID = begin; NodeID < end; ++NodeID) {
+					NodeId InDegree = 0;
+					for (unsigned int t = 0; t < NumberOfThreads; t++) {
+						NodeId count = Histograms[t][NodeID];
+						Histograms[t][NodeID] = InDegree;
+						InDegree += count;
+					}
+					InvertedOffsets[NodeID + 1] = InDegree;
+				}
+			});
+	ParallelUtils::InclusiveScan(InvertedOffsets + 1, m_NumberOfNodes);
 
+	//scatter the edges into the inverted lists
+	ParallelUtils::RunThreads(NumberOfThreads,
+			[&](unsigned int t, unsigned int) {
+				std::vector<NodeId>& Cursors = Histograms[t];
+				for (NodeId NodeID = SourceBounds[t];
+						NodeID < SourceBounds[t + 1]; ++NodeID) {
+					const NeighborRange list = neighbors(NodeID);
+					for (NeighborIterator it = list.begin(); it != list.end(); ++it) {
+						NodeId peer = *it;
+						EdgeOffset position = InvertedOffsets[peer] + Cursors[peer]++;
+						InvertedNeighbors[position] = NodeID;
+						if (InvertedWeights != NULL)
+							InvertedWeights[position] = m_Weights[it.edge()];
+					}
+				}
+			});
 }
 
 /*
  * Create the undirected version of the graph represented in this instance.
- * Essentially, we're combining the directed graph and it's inverse.
+ * Essentially, we're combining the directed graph and it's inverse: the neighbor list of every
+ * node is the sorted merge of its out-list and in-list, with every bi-directional edge kept once.
+ * If both graphs are weighted, the weights are merged along with the neighbors, and a bi-directional
+ * edge keeps the weight of the out-edge.
+ *
+ * The graph is built in two parallel passes: the first counts the size of every merged list, and
+ * after a prefix sum over the counts the second merges the lists straight into the final arrays.
  */
-void CacheGraph::CureateUndirectedGraph(const CacheGraph& InvertedGraph,
-		CacheGraph& UndirectedGraph) const {
-	//calculate the number of edges in the graph
-	int64 NumberOfEdges = m_Offsets[m_NumberOfNodes];
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::CreateUndirectedGraph(const CacheGraphT& InvertedGraph,
+		CacheGraphT& UndirectedGraph) const {
 	//clear the new graph
 	UndirectedGraph.Clear();
 	//assign member variables
 	UndirectedGraph.m_NumberOfNodes = m_NumberOfNodes;
-	//allocate memory
-	UndirectedGraph.m_Offsets = new int64[m_NumberOfNodes + 1];
-	std::memset(UndirectedGraph.m_Offsets, 0,
-			(m_NumberOfNodes) * sizeof(int64));
-	//note that in an undirected graph, there are twice as many edges in the
-	//adjacency list as in a directed graph.
-	unsigned int* temp_Graph = new unsigned int[2 * NumberOfEdges];
-//	double* temp_weights = new double[2 * NumberOfEdges];  // TODO M_WEIGHTS
-	std::memset(temp_Graph, 0, 2 * NumberOfEdges * sizeof(unsigned int));
-	unsigned int *temp_graph_pointer = temp_Graph;
-//	double* temp_weight_pointer = temp_weights;     // TODO M_WEIGHTS
-
-	//combine the inverted and normal graphs into an undirected one.
-	for (unsigned int NodeID = 0; NodeID < m_NumberOfNodes; ++NodeID) {
-		auto p1 = m_Graph + m_Offsets[NodeID]; //current neighbor
-		auto p2 = InvertedGraph.m_Graph + InvertedGraph.m_Offsets[NodeID]; //inverted current neighbor
-
-//		auto w1 = m_Weights + m_Offsets[NodeID]; //current weight  // TODO M_WEIGHTS
-//		auto w2 = InvertedGraph.m_Weights + InvertedGraph.m_Offsets[NodeID]; //inverted current weight // TODO M_WEIGHTS
-
-		while (p1 < m_Graph + m_Offsets[NodeID + 1]
-				&& p2
-						< InvertedGraph.m_Graph
-								+ InvertedGraph.m_Offsets[NodeID + 1]) { //while we are in both neighbor lists
-			if (*p1 == *p2) { //bi-directional edge
-				*temp_graph_pointer = *p1;
-//				*temp_weight_pointer = *w1;  // TODO M_WEIGHTS
-				++p1;
-				++p2;
-//				++w1;                        // TODO M_WEIGHTS
-//				++w2;                        // TODO M_WEIGHTS
-			} else if (*p1 < *p2) {
-				*temp_graph_pointer = *p1;
-//				*temp_weight_pointer = *w1;  // TODO M_WEIGHTS
-				++p1;
-//				++w1;                        // TODO M_WEIGHTS
-			} else // if (*p1>*p2)
-			{
-				*temp_graph_pointer = *p2;
-//				*temp_weight_pointer = *w2;  // TODO M_WEIGHTS
-				++p2;
-//				++w2;                        // TODO M_WEIGHTS
-			}
-			++temp_graph_pointer;
-		} //END WHILE
-		if (p1 < m_Graph + m_Offsets[NodeID + 1]) { //if we haven't read all of the neighbors of the node
-			int64 RemainingElements = m_Graph + m_Offsets[NodeID + 1] - p1;
-			std::memcpy(temp_graph_pointer, p1,
-					sizeof(unsigned int) * RemainingElements);
-//			std::memcpy(temp_weight_pointer, p1,
-//					sizeof(double) * RemainingElements);     // TODO M_WEIGHTS
-			temp_graph_pointer += RemainingElements;
-//			temp_weight_pointer += RemainingElements;        // TODO M_WEIGHTS
-		} else if (p2
-				< InvertedGraph.m_Graph + InvertedGraph.m_Offsets[NodeID + 1]) { //or if we haven't read all the neighbors in the inverted graph
-			int64 RemainingElements = InvertedGraph.m_Graph
-					+ InvertedGraph.m_Offsets[NodeID + 1] - p2;
-			std::memcpy(temp_graph_pointer, p2,
-					sizeof(unsigned int) * RemainingElements);
-//			std::memcpy(temp_weight_pointer, p2,
-//					sizeof(double) * RemainingElements);      // TODO M_WEIGHTS
-			temp_graph_pointer += RemainingElements;
-//			temp_weight_pointer += RemainingElements;         // TODO M_WEIGHTS
+	UndirectedGraph.directed = false;
+	UndirectedGraph.m_Offsets = new EdgeOffset[m_NumberOfNodes + 1];
+	EdgeOffset* UndirectedOffsets = UndirectedGraph.m_Offsets;
+	const bool MergeWeights = weighted && InvertedGraph.weighted;
+	const int64 grain = 1024;
+	//if either graph is compressed, every thread decodes the lists into its own buffers
+	std::vector<std::vector<NodeId> > Buffers(
+			2 * ParallelUtils::GetNumberOfThreads());
 
-		}
-		//Otherwise - we've read all neighbors
+	//count the size of the merged neighbor list of every node
+	UndirectedOffsets[0] = 0;
+	ParallelUtils::ParallelFor(0, m_NumberOfNodes, grain,
+			[&](unsigned int t, int64 NodeID) {
+				const NodeId* OutList = NeighborListOf(NodeID, Buffers[2 * t]);
+				const NodeId* InList = InvertedGraph.NeighborListOf(NodeID,
+						Buffers[2 * t + 1]);
+				UndirectedOffsets[NodeID + 1] = MergeNeighborLists(OutList,
+						OutList + (m_Offsets[NodeID + 1] - m_Offsets[NodeID]), NULL,
+						InList,
+						InList + (InvertedGraph.m_Offsets[NodeID + 1]
+								- InvertedGraph.m_Offsets[NodeID]), NULL, NULL,
+						NULL);
+			});
+	ParallelUtils::InclusiveScan(UndirectedOffsets + 1, m_NumberOfNodes);
+	UndirectedGraph.m_NumberOfEdges = UndirectedOffsets[m_NumberOfNodes];
 
-		UndirectedGraph.m_Offsets[NodeID + 1] = temp_graph_pointer - temp_Graph;
+	//allocate the exact amount of memory and merge the lists into it
+	UndirectedGraph.m_Graph = new NodeId[UndirectedGraph.m_NumberOfEdges];
+	if (MergeWeights) {
+		UndirectedGraph.m_Weights =
+				new double[UndirectedGraph.m_NumberOfEdges];
+		UndirectedGraph.weighted = true;
 	}
+	NodeId* UndirectedNeighbors = UndirectedGraph.m_Graph;
+	double* UndirectedWeights = UndirectedGraph.m_Weights;
+	ParallelUtils::ParallelFor(0, m_NumberOfNodes, grain,
+			[&](unsigned int t, int64 NodeID) {
+				const NodeId* OutList = NeighborListOf(NodeID, Buffers[2 * t]);
+				const NodeId* InList = InvertedGraph.NeighborListOf(NodeID,
+						Buffers[2 * t + 1]);
+				MergeNeighborLists(OutList,
+						OutList + (m_Offsets[NodeID + 1] - m_Offsets[NodeID]),
+						MergeWeights ? m_Weights + m_Offsets[NodeID] : NULL,
+						InList,
+						InList + (InvertedGraph.m_Offsets[NodeID + 1]
+								- InvertedGraph.m_Offsets[NodeID]),
+						MergeWeights ?
+								InvertedGraph.m_Weights
+										+ InvertedGraph.m_Offsets[NodeID] :
+								NULL,
+						UndirectedNeighbors + UndirectedOffsets[NodeID],
+						MergeWeights ?
+								UndirectedWeights + UndirectedOffsets[NodeID] :
+								NULL);
+			});
+}
 
-	UndirectedGraph.m_NumberOfEdges =
-			UndirectedGraph.m_Offsets[m_NumberOfNodes];
-
-	// Copy neighbor list from temp
-	UndirectedGraph.m_Graph = new unsigned int[UndirectedGraph.m_NumberOfEdges];
-	std::memcpy(UndirectedGraph.m_Graph, temp_Graph,
-			UndirectedGraph.m_NumberOfEdges * sizeof(unsigned int));
-
-	//Copy weights from temp
-	UndirectedGraph.m_Weights = new double[UndirectedGraph.m_NumberOfEdges];
-//	std::memcpy(UndirectedGraph.m_Weights,temp_weights,UndirectedGraph.m_NumberOfEdges*sizeof(double));  // TODO M_WEIGHTS
-	//clear memory
-	delete[] temp_Graph;
+/*
+ Merge two sorted neighbor lists [p1,end1) and [p2,end2), keeping the neighbors that appear
+ in both lists once.
+ If out is NULL the lists are only counted. Otherwise, the merged list is written into out, and if
+ outWeights isn't NULL the weights w1 and w2 of the lists are merged into it (a neighbor that
+ appears in both lists gets its weight from w1).
+ Returns the size of the merged list.
+ */
+template<typename NodeId, typename EdgeOffset>
+int64 CacheGraphT<NodeId, EdgeOffset>::MergeNeighborLists(const NodeId* p1,
+		const NodeId* end1, const double* w1, const NodeId* p2,
+		const NodeId* end2, const double* w2, NodeId* out, double* outWeights) {
+	const int64 size1 = end1 - p1, size2 = end2 - p2;
+	int64 i = 0, j = 0, size = 0;
+	while (i < size1 && j < size2) { //while we are in both neighbor lists
+		if (p1[i] <= p2[j]) {
+			if (out != NULL) {
+				out[size] = p1[i];
+				if (outWeights != NULL)
+					outWeights[size] = w1[i];
+			}
+			if (p1[i] == p2[j]) //bi-directional edge
+				++j;
+			++i;
+		} else {
+			if (out != NULL) {
+				out[size] = p2[j];
+				if (outWeights != NULL)
+					outWeights[size] = w2[j];
+			}
+			++j;
+		}
+		++size;
+	} //END WHILE
+	//copy whatever is left of the list we haven't finished
+	int64 RemainingElements = (size1 - i) + (size2 - j);
+	if (out != NULL && RemainingElements > 0) {
+		std::memcpy(out + size, (i < size1) ? p1 + i : p2 + j,
+				sizeof(NodeId) * RemainingElements);
+		if (outWeights != NULL)
+			std::memcpy(outWeights + size, (i < size1) ? w1 + i : w2 + j,
+					sizeof(double) * RemainingElements);
+	}
+	return size + RemainingElements;
 }
 
-std::vector<unsigned int> CacheGraph::ComputeNodeDegrees() const {
-	std::vector<unsigned int> Degrees(m_NumberOfNodes, 0);
-	for (unsigned int NodeID = 0; NodeID < m_NumberOfNodes; ++NodeID) {
-		Degrees[NodeID] = static_cast<unsigned int>(m_Offsets[NodeID + 1]
+template<typename NodeId, typename EdgeOffset>
+std::vector<NodeId> CacheGraphT<NodeId, EdgeOffset>::ComputeNodeDegrees() const {
+	std::vector<NodeId> Degrees(m_NumberOfNodes, 0);
+	//use the precomputed degrees if they were saved with the graph
+	if (ReadSection(SECTION_DEGREES, Degrees.data(), m_NumberOfNodes))
+		return Degrees;
+	for (NodeId NodeID = 0; NodeID < m_NumberOfNodes; ++NodeID) {
+		Degrees[NodeID] = static_cast<NodeId>(m_Offsets[NodeID + 1]
 				- m_Offsets[NodeID]);
 	}
 	return Degrees;
 }
 
-std::vector<float> CacheGraph::ComputeNodePageRank(float dumping,
+template<typename NodeId, typename EdgeOffset>
+std::vector<float> CacheGraphT<NodeId, EdgeOffset>::ComputeNodePageRank(float dumping,
 		unsigned int NumberOfIterations) const {
+	return ComputeNodePageRank(dumping, NumberOfIterations, 1e-6);
+}
 
-	std::random_device rng;
-	std::mt19937 urng(rng());
-	std::vector<float> PageRank(m_NumberOfNodes, 1.0F - dumping);
-	while (NumberOfIterations > 0) {
-		std::vector<int> NodeIDs(m_NumberOfNodes); // vector with 100 ints.
-		std::iota(std::begin(NodeIDs), std::end(NodeIDs), 0);
-		std::shuffle(NodeIDs.begin(), NodeIDs.end(), urng);
-		for (unsigned int index = 0; index < m_NumberOfNodes; ++index) {
-			const unsigned int NodeID = NodeIDs[index];
-			float friends_contribution = 0.0;
-			for (auto p = m_Graph + m_Offsets[NodeID];
-					p < m_Graph + m_Offsets[NodeID + 1]; ++p) {
-				friends_contribution += PageRank[*p]
-						/ (m_Offsets[*p + 1] - m_Offsets[*p]);
-			}
-			PageRank[NodeID] = (1.0F - dumping)
-					+ dumping * friends_contribution;
-		}
-		--NumberOfIterations;
+/*
+ The page rank is computed by (Jacobi) power iteration, in the same normalization as networkx:
+ the ranks sum to 1, and the rank of the dangling nodes (which have no out edges) is spread
+ evenly over all of the nodes.
+ Every iteration first divides each rank by the node's out degree, and then every node pulls
+ the contributions of its in neighbors (the neighbors in the inverse graph), in parallel.
+ The iterations stop once the L1 distance between two successive rank vectors is below
+ tolerance times the number of nodes, or after MaxIterations iterations.
+ The sums are always taken over the same blocks of nodes in the same order, so the result doesn't
+ depend on the number of threads.
+ */
+template<typename NodeId, typename EdgeOffset>
+std::vector<float> CacheGraphT<NodeId, EdgeOffset>::ComputeNodePageRank(float dumping,
+		unsigned int MaxIterations, double tolerance) const {
+	const int64 NumberOfNodes = m_NumberOfNodes;
+	if (NumberOfNodes == 0)
+		return std::vector<float>();
+	const CacheGraphT& InGraph = directed ? inverse() : *this;
+	const std::vector<NodeId>& OutDegrees = degrees();
+	const int64 NumberOfBlocks = (NumberOfNodes + PAGE_RANK_BLOCK - 1)
+			/ PAGE_RANK_BLOCK;
+	std::vector<double> Rank(NumberOfNodes, 1.0 / NumberOfNodes);
+	std::vector<double> NextRank(NumberOfNodes), Contribution(NumberOfNodes);
+	std::vector<double> BlockSums(NumberOfBlocks);
+
+	for (unsigned int iteration = 0; iteration < MaxIterations; ++iteration) {
+		ParallelUtils::ParallelFor(0, NumberOfBlocks, 1,
+				[&](unsigned int, int64 block) {
+					const int64 last = std::min(NumberOfNodes, (block + 1) * PAGE_RANK_BLOCK);
+					double DanglingRank = 0;
+					for (int64 node = block * PAGE_RANK_BLOCK; node < last; ++node) {
+						if (OutDegrees[node] > 0)
+							Contribution[node] = Rank[node] / OutDegrees[node];
+						else {
+							Contribution[node] = 0;
+							DanglingRank += Rank[node];
+						}
+					}
+					BlockSums[block] = DanglingRank;
+				});
+		const double DanglingRank = std::accumulate(BlockSums.begin(),
+				BlockSums.end(), 0.0);
+		const double base = (1.0 - dumping + dumping * DanglingRank)
+				/ NumberOfNodes;
+
+		ParallelUtils::ParallelFor(0, NumberOfBlocks, 1,
+				[&](unsigned int, int64 block) {
+					const int64 last = std::min(NumberOfNodes, (block + 1) * PAGE_RANK_BLOCK);
+					double residual = 0;
+					for (int64 node = block * PAGE_RANK_BLOCK; node < last; ++node) {
+						double sum = 0;
+						for (NodeId peer : InGraph.neighbors(static_cast<NodeId>(node)))
+							sum += Contribution[peer];
+						NextRank[node] = base + dumping * sum;
+						residual += std::fabs(NextRank[node] - Rank[node]);
+					}
+					BlockSums[block] = residual;
+				});
+		Rank.swap(NextRank);
+		const double residual = std::accumulate(BlockSums.begin(),
+				BlockSums.end(), 0.0);
+		if (residual < NumberOfNodes * tolerance)
+			break;
 	}
-	return PageRank;
+	return std::vector<float>(Rank.begin(), Rank.end());
 }
 
-std::vector<unsigned short> CacheGraph::ComputeKCore() const {
-	const unsigned short UNSET_K_CORE = static_cast<unsigned short>(-1);
-	std::vector<unsigned short> KShell(m_NumberOfNodes, UNSET_K_CORE);
-	std::vector<unsigned int> Degrees(m_NumberOfNodes, 0);
-	for (unsigned int NodeID = 0; NodeID < m_NumberOfNodes; ++NodeID) {
-		Degrees[NodeID] = static_cast<unsigned int>(m_Offsets[NodeID + 1]
-				- m_Offsets[NodeID]);
-		if (Degrees[NodeID] == 0) {
-			KShell[NodeID] = 0;
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::CheckSeeds(
+		const std::vector<std::vector<NodeId> >& SeedSets) const {
+	for (const std::vector<NodeId>& seeds : SeedSets)
+		for (NodeId seed : seeds)
+			if (seed >= m_NumberOfNodes)
+				throw std::out_of_range("Seed node out of range");
+}
+
+/*
+ The personalized page ranks are computed like ComputeNodePageRank, only the ranks of the nodes
+ are a dense block with a row of all of the seed sets per node (in groups of PAGE_RANK_LANES),
+ so that pulling the contributions of a neighbor adds it to the ranks of all of the seed sets.
+ The rank of the dangling nodes is given to the seeds, as in networkx.
+ The iterations stop once all of the seed sets converged.
+ */
+template<typename NodeId, typename EdgeOffset>
+std::vector<std::vector<float> > CacheGraphT<NodeId, EdgeOffset>::ComputePersonalizedPageRank(
+		const std::vector<std::vector<NodeId> >& SeedSets, float dumping,
+		unsigned int MaxIterations, double tolerance) const {
+	CheckSeeds(SeedSets);
+	const int64 NumberOfNodes = m_NumberOfNodes;
+	const int64 NumberOfSets = SeedSets.size();
+	const int64 groups = (NumberOfSets + PAGE_RANK_LANES - 1) / PAGE_RANK_LANES;
+	std::vector<std::vector<float> > PageRanks(NumberOfSets,
+			std::vector<float>(NumberOfNodes, 0.0F));
+	if (NumberOfNodes == 0 || NumberOfSets == 0)
+		return PageRanks;
+	const CacheGraphT& InGraph = directed ? inverse() : *this;
+	const std::vector<NodeId>& OutDegrees = degrees();
+	const int64 NumberOfBlocks = (NumberOfNodes + PAGE_RANK_BLOCK - 1)
+			/ PAGE_RANK_BLOCK;
+	const PageRankLanes ZERO = { };
+
+	//the restart distribution of every seed set, which is also the initial rank
+	std::vector<PageRankLanes> Restart(NumberOfNodes * groups, ZERO);
+	for (int64 set = 0; set < NumberOfSets; ++set)
+		for (NodeId seed : SeedSets[set])
+			Restart[seed * groups + set / PAGE_RANK_LANES][set % PAGE_RANK_LANES] +=
+					1.0F / SeedSets[set].size();
+	std::vector<PageRankLanes> Rank(Restart), NextRank(NumberOfNodes * groups);
+	std::vector<PageRankLanes> Contribution(NumberOfNodes * groups);
+	std::vector<PageRankLanes> BlockSums(NumberOfBlocks * groups);
+
+	for (unsigned int iteration = 0; iteration < MaxIterations; ++iteration) {
+		ParallelUtils::ParallelFor(0, NumberOfBlocks, 1,
+				[&](unsigned int, int64 block) {
+					const int64 last = std::min(NumberOfNodes, (block + 1) * PAGE_RANK_BLOCK);
+					PageRankLanes* DanglingRank = &BlockSums[block * groups];
+					std::fill(DanglingRank, DanglingRank + groups, ZERO);
+					for (int64 node = block * PAGE_RANK_BLOCK; node < last; ++node) {
+						const PageRankLanes* rank = &Rank[node * groups];
+						PageRankLanes* contribution = &Contribution[node * groups];
+						const float share = OutDegrees[node] > 0 ? 1.0F / OutDegrees[node] : 0.0F;
+						for (int64 g = 0; g < groups; ++g) {
+							contribution[g] = rank[g] * share;
+							if (OutDegrees[node] == 0)
+								DanglingRank[g] += rank[g];
+						}
+					}
+				});
+		//every seed set restarts with its own share of the dangling rank
+		std::vector<PageRankLanes> base(groups, ZERO);
+		for (int64 block = 0; block < NumberOfBlocks; ++block)
+			for (int64 g = 0; g < groups; ++g)
+				base[g] += BlockSums[block * groups + g];
+		for (int64 g = 0; g < groups; ++g)
+			base[g] = (1.0F - dumping) + dumping * base[g];
+
+		ParallelUtils::ParallelFor(0, NumberOfBlocks, 1,
+				[&](unsigned int, int64 block) {
+					const int64 last = std::min(NumberOfNodes, (block + 1) * PAGE_RANK_BLOCK);
+					PageRankLanes* residual = &BlockSums[block * groups];
+					std::fill(residual, residual + groups, ZERO);
+					std::vector<PageRankLanes> sum(groups);
+					for (int64 node = block * PAGE_RANK_BLOCK; node < last; ++node) {
+						std::fill(sum.begin(), sum.end(), ZERO);
+						for (NodeId peer : InGraph.neighbors(static_cast<NodeId>(node))) {
+							const PageRankLanes* contribution = &Contribution[peer * groups];
+							for (int64 g = 0; g < groups; ++g)
+								sum[g] += contribution[g];
+						}
+						for (int64 g = 0; g < groups; ++g) {
+							const int64 position = node * groups + g;
+							NextRank[position] = base[g] * Restart[position] + dumping * sum[g];
+							const PageRankLanes change = NextRank[position] - Rank[position];
+							for (unsigned int lane = 0; lane < PAGE_RANK_LANES; ++lane)
+								residual[g][lane] += std::fabs(change[lane]);
+						}
+					}
+				});
+		Rank.swap(NextRank);
+		float MaxResidual = 0;
+		for (int64 g = 0; g < groups; ++g) {
+			PageRankLanes residual = ZERO;
+			for (int64 block = 0; block < NumberOfBlocks; ++block)
+				residual += BlockSums[block * groups + g];
+			for (unsigned int lane = 0; lane < PAGE_RANK_LANES; ++lane)
+				MaxResidual = std::max(MaxResidual, residual[lane]);
 		}
+		if (MaxResidual < NumberOfNodes * tolerance)
+			break;
 	}
-	unsigned short CurrentShell = 1;
-	bool NodesInShell = false;
-	do {
-		NodesInShell = false;
-		bool any_degree_changed = false;
-		do {
-			any_degree_changed = false;
-			for (unsigned int NodeID = 0; NodeID < m_NumberOfNodes; ++NodeID) {
-
-				if (KShell[NodeID] == UNSET_K_CORE
-						&& Degrees[NodeID] <= CurrentShell) {
-					KShell[NodeID] = CurrentShell;
-					NodesInShell = true;
-					for (auto p = m_Graph + m_Offsets[NodeID];
-							p < m_Graph + m_Offsets[NodeID + 1]; ++p) {
-						if (KShell[*p] == UNSET_K_CORE) {
-							--Degrees[*p];
-							any_degree_changed = true;
-						}
+
+	for (int64 set = 0; set < NumberOfSets; ++set)
+		for (int64 node = 0; node < NumberOfNodes; ++node)
+			PageRanks[set][node] = Rank[node * groups + set / PAGE_RANK_LANES][set
+					% PAGE_RANK_LANES];
+	return PageRanks;
+}
+
+/*
+ The forward push (Andersen, Chung and Lang): every seed set starts with a residual of 1 spread
+ over its seeds, and a node whose residual is at least epsilon times its degree keeps 1 - dumping
+ of it as rank and pushes the rest evenly to its neighbors (or back to the seeds, if it has none).
+ The seed sets are pushed in parallel. Every thread keeps dense arrays of the ranks and the
+ residuals, and resets only the nodes it touched before moving on to its next seed set.
+ */
+template<typename NodeId, typename EdgeOffset>
+std::vector<std::vector<std::pair<NodeId, float> > > CacheGraphT<NodeId,
+		EdgeOffset>::ApproximatePersonalizedPageRank(
+		const std::vector<std::vector<NodeId> >& SeedSets, float dumping,
+		double epsilon) const {
+	CheckSeeds(SeedSets);
+	const std::vector<NodeId>& OutDegrees = degrees();
+	std::vector<std::vector<std::pair<NodeId, float> > > PageRanks(
+			SeedSets.size());
+	struct PushState {
+		std::vector<double> rank, residual;
+		std::vector<bool> queued;
+		std::vector<NodeId> touched, queue;
+	};
+	std::vector<PushState> states(ParallelUtils::GetNumberOfThreads());
+
+	ParallelUtils::ParallelFor(0, SeedSets.size(), 1,
+			[&](unsigned int t, int64 set) {
+				const std::vector<NodeId>& seeds = SeedSets[set];
+				if (seeds.empty())
+					return;
+				PushState& state = states[t];
+				if (state.rank.empty()) {
+					state.rank.assign(m_NumberOfNodes, 0.0);
+					state.residual.assign(m_NumberOfNodes, 0.0);
+					state.queued.assign(m_NumberOfNodes, false);
+				}
+				auto add = [&](NodeId node, double value) {
+					if (state.rank[node] == 0 && state.residual[node] == 0)
+						state.touched.push_back(node);
+					state.residual[node] += value;
+					if (!state.queued[node]
+							&& state.residual[node] >= epsilon * std::max<NodeId>(OutDegrees[node], 1)) {
+						state.queued[node] = true;
+						state.queue.push_back(node);
+					}
+				};
+				for (NodeId seed : seeds)
+					add(seed, 1.0 / seeds.size());
+				//the queue is used as a stack, which keeps the pushes local
+				while (!state.queue.empty()) {
+					const NodeId node = state.queue.back();
+					state.queue.pop_back();
+					state.queued[node] = false;
+					const double residual = state.residual[node];
+					state.residual[node] = 0;
+					state.rank[node] += (1.0 - dumping) * residual;
+					if (OutDegrees[node] == 0) {
+						for (NodeId seed : seeds)
+							add(seed, dumping * residual / seeds.size());
+						continue;
 					}
+					const double share = dumping * residual / OutDegrees[node];
+					for (NodeId peer : neighbors(node))
+						add(peer, share);
 				}
-			}
-		} while (any_degree_changed);
-		++CurrentShell;
-	} while (NodesInShell);
-	return KShell;
+
+				std::sort(state.touched.begin(), state.touched.end());
+				std::vector<std::pair<NodeId, float> >& result = PageRanks[set];
+				for (NodeId node : state.touched) {
+					if (state.rank[node] > 0)
+						result.push_back(std::make_pair(node, static_cast<float>(state.rank[node])));
+					state.rank[node] = 0;
+					state.residual[node] = 0;
+				}
+				state.touched.clear();
+			});
+	return PageRanks;
+}
+
+/*
+ The degree of every node in the k-core decomposition, and the neighbors it's peeled from.
+ As in networkx, a directed graph is decomposed by the total (in + out) degree, and self loops
+ are ignored.
+ */
+template<typename NodeId, typename EdgeOffset>
+std::vector<NodeId> CacheGraphT<NodeId, EdgeOffset>::KCoreDegrees() const {
+	std::vector<NodeId> Degrees(m_NumberOfNodes, 0);
+	const CacheGraphT* InGraph = directed ? &inverse() : NULL;
+	ParallelUtils::ParallelFor(0, m_NumberOfNodes, PAGE_RANK_BLOCK,
+			[&](unsigned int, int64 node) {
+				const NodeId v = static_cast<NodeId>(node);
+				NodeId degree = 0;
+				for (NodeId peer : neighbors(v))
+					degree += (peer != v);
+				if (InGraph != NULL)
+					for (NodeId peer : InGraph->neighbors(v))
+						degree += (peer != v);
+				Degrees[v] = degree;
+			});
+	return Degrees;
+}
+
+/*
+ The core number of every node, by the O(E) algorithm of Batagelj and Zaversnik: the nodes are
+ bucket sorted by degree, and are removed in increasing order of degree, moving each neighbor whose
+ degree drops to the previous bucket.
+ */
+template<typename NodeId, typename EdgeOffset>
+std::vector<NodeId> CacheGraphT<NodeId, EdgeOffset>::ComputeKCore() const {
+	const int64 NumberOfNodes = m_NumberOfNodes;
+	std::vector<NodeId> Degrees = KCoreDegrees();
+	if (NumberOfNodes == 0)
+		return Degrees;
+	const CacheGraphT* InGraph = directed ? &inverse() : NULL;
+	const NodeId MaxDegree = *std::max_element(Degrees.begin(), Degrees.end());
+
+	//Bins[d] is the position of the first node of degree d in Sorted
+	std::vector<int64> Bins(static_cast<int64>(MaxDegree) + 2, 0);
+	for (int64 node = 0; node < NumberOfNodes; ++node)
+		++Bins[Degrees[node] + 1];
+	std::partial_sum(Bins.begin(), Bins.end(), Bins.begin());
+	std::vector<NodeId> Sorted(NumberOfNodes);
+	std::vector<int64> Positions(NumberOfNodes);
+	{
+		std::vector<int64> next(Bins.begin(), Bins.end() - 1);
+		for (int64 node = 0; node < NumberOfNodes; ++node) {
+			Positions[node] = next[Degrees[node]]++;
+			Sorted[Positions[node]] = static_cast<NodeId>(node);
+		}
+	}
+
+	auto peel = [&](NodeId node, NodeId peer) {
+		if (peer == node || Degrees[peer] <= Degrees[node])
+			return;
+		//swap peer with the first node of its bin, and move the bin past it
+		const NodeId degree = Degrees[peer];
+		const int64 first = Bins[degree];
+		const NodeId FirstNode = Sorted[first];
+		std::swap(Sorted[first], Sorted[Positions[peer]]);
+		Positions[FirstNode] = Positions[peer];
+		Positions[peer] = first;
+		++Bins[degree];
+		--Degrees[peer];
+	};
+	for (int64 i = 0; i < NumberOfNodes; ++i) {
+		const NodeId node = Sorted[i];
+		for (NodeId peer : neighbors(node))
+			peel(node, peer);
+		if (InGraph != NULL)
+			for (NodeId peer : InGraph->neighbors(node))
+				peel(node, peer);
+	}
+	//the degree a node had when it was removed is its core number
+	return Degrees;
+}
+
+/*
+ The core number of every node by parallel level synchronous peeling (in the style of the PKC
+ algorithm of Kabir and Madduri). Every level, the threads collect the remaining nodes whose degree
+ dropped to the level, and remove them, decrementing their neighbors' degrees atomically (but never
+ below the level); a neighbor whose degree drops to the level is removed in the same level by the
+ thread that decremented it. The levels no remaining node has are skipped.
+ The result is the same as ComputeKCore's.
+ */
+template<typename NodeId, typename EdgeOffset>
+std::vector<NodeId> CacheGraphT<NodeId, EdgeOffset>::ComputeKCoreParallel() const {
+	const int64 NumberOfNodes = m_NumberOfNodes;
+	std::vector<NodeId> Cores = KCoreDegrees();
+	const CacheGraphT* InGraph = directed ? &inverse() : NULL;
+	std::vector<std::atomic<NodeId> > Degrees(NumberOfNodes);
+	std::vector<std::atomic<bool> > Removed(NumberOfNodes);
+	for (int64 node = 0; node < NumberOfNodes; ++node) {
+		Degrees[node].store(Cores[node], std::memory_order_relaxed);
+		Removed[node].store(false, std::memory_order_relaxed);
+	}
+
+	const unsigned int NumberOfThreads = ParallelUtils::ThreadsForWork(
+			static_cast<int64>(m_NumberOfEdges));
+	//every thread keeps the remaining nodes of its own range of nodes
+	std::vector<std::vector<NodeId> > Remaining(NumberOfThreads);
+	std::vector<NodeId> LevelOfThread(NumberOfThreads);
+	std::vector<int64> RemovedByThread(NumberOfThreads);
+	const NodeId NO_LEVEL = std::numeric_limits<NodeId>::max();
+	int64 removed = 0;
+	NodeId level = 0;
+	bool first = true;
+	while (removed < NumberOfNodes) {
+		//drop the nodes removed in the previous level, and find the next level
+		ParallelUtils::RunThreads(NumberOfThreads,
+				[&](unsigned int t, unsigned int) {
+					std::vector<NodeId>& nodes = Remaining[t];
+					if (first)
+						for (int64 node = NumberOfNodes * t / NumberOfThreads;
+								node < NumberOfNodes * (t + 1) / NumberOfThreads; ++node)
+							nodes.push_back(static_cast<NodeId>(node));
+					NodeId MinDegree = NO_LEVEL;
+					size_t kept = 0;
+					for (size_t i = 0; i < nodes.size(); ++i) {
+						if (Removed[nodes[i]].load(std::memory_order_relaxed))
+							continue;
+						nodes[kept++] = nodes[i];
+						MinDegree = std::min(MinDegree,
+								Degrees[nodes[i]].load(std::memory_order_relaxed));
+					}
+					nodes.resize(kept);
+					LevelOfThread[t] = MinDegree;
+				});
+		first = false;
+		level = *std::min_element(LevelOfThread.begin(), LevelOfThread.end());
+
+		ParallelUtils::RunThreads(NumberOfThreads,
+				[&](unsigned int t, unsigned int) {
+					std::vector<NodeId> frontier;
+					//a node reaches the level either in this scan or by a decrement, and whoever
+					//claims it first removes it
+					auto claim = [&](NodeId node) {
+						if (!Removed[node].exchange(true))
+							frontier.push_back(node);
+					};
+					auto peel = [&](NodeId node, NodeId peer) {
+						if (peer == node)
+							return;
+						//never decrement below the level, so the scan sees every node that reached it
+						NodeId degree = Degrees[peer].load(std::memory_order_relaxed);
+						while (degree > level
+								&& !Degrees[peer].compare_exchange_weak(degree, degree - 1))
+							;
+						if (degree == level + 1)
+							claim(peer);
+					};
+					for (NodeId node : Remaining[t])
+						if (Degrees[node].load(std::memory_order_relaxed) == level)
+							claim(node);
+					for (size_t i = 0; i < frontier.size(); ++i) {
+						const NodeId node = frontier[i];
+						for (NodeId peer : neighbors(node))
+							peel(node, peer);
+						if (InGraph != NULL)
+							for (NodeId peer : InGraph->neighbors(node))
+								peel(node, peer);
+					}
+					RemovedByThread[t] = frontier.size();
+				});
+		removed += std::accumulate(RemovedByThread.begin(),
+				RemovedByThread.end(), static_cast<int64>(0));
+	}
+	for (int64 node = 0; node < NumberOfNodes; ++node)
+		Cores[node] = Degrees[node].load(std::memory_order_relaxed);
+	return Cores;
 }
 
 /*
@@ -370,43 +1381,398 @@ std::vector<unsigned short> CacheGraph::ComputeKCore() const {
  For an undirected graph, the order does not matter.
  Input: the two nodes to check
  Output: whether there is an edge p->q
- Note: we are working under the assumption that the list of p's neighbors is ordered,
- and so we use binary search.
- Usage of the binary search keeps the proccess to O(log(V))
- */
-bool CacheGraph::areNeighbors(const unsigned int p,
-		const unsigned int q) const {
-	int first = m_Offsets[p],  //first array element
-			last = m_Offsets[p + 1] - 1,     //last array element
-			middle;                       //mid point of search
-//	std::cout << "In bin search"<<std::endl;
-//	std::cout << "p="<<p<<" q="<<q<<std::endl;
-	while (first <= last) {
-		middle = (int) (first + last) / 2; //this finds the mid point
-//		std::cout << "Binary search: " << first<< " "<< last<< " "<< middle << std::endl;
-		//TODO: fix overflow problem
-		if (m_Graph[middle] == q) {
-			return true;
-		} else if (m_Graph[middle] < q)
-				{
-			first = middle + 1;     //if it's in the upper half
-
-		} else { //m_Graph[middle] < q
-			last = middle - 1; // if it's in the lower half
+ Note: we are working under the assumption that the list of p's neighbors is ordered.
+ If the neighbor index was built, long lists are checked through it in O(1). Otherwise short lists
+ are scanned without branches, and longer ones are binary searched in O(log(V)).
+ */
+template<typename NodeId, typename EdgeOffset>
+bool CacheGraphT<NodeId, EdgeOffset>::areNeighbors(const NodeId p,
+		const NodeId q) const {
+	const NeighborIndex* index = m_NeighborIndex.load(std::memory_order_acquire);
+	if (index != NULL && index->kinds[p] != INDEX_LINEAR) {
+		const int64 position = index->positions[p];
+		if (index->kinds[p] == INDEX_BITMAP)
+			return (index->bitmaps[position + (q >> 6)] >> (q & 63)) & 1;
+		const unsigned int bits = index->kinds[p];
+		const int64 mask = (1ULL << bits) - 1;
+		const NodeId EMPTY = static_cast<NodeId>(-1);
+		for (int64 slot = NeighborHash(q, bits);; slot = (slot + 1) & mask) {
+			const NodeId value = index->hashSets[position + slot];
+			if (value == q)
+				return true;
+			if (value == EMPTY)
+				return false;
+		}
+	}
+	if (isCompressed()) {
+		//the gaps can only be decoded in order, so scan until we pass q
+		for (NodeId neighbor : neighbors(p))
+			if (neighbor >= q)
+				return neighbor == q;
+		return false;
+	}
+	const NodeId* first = m_Graph + m_Offsets[p];
+	const NodeId* last = m_Graph + m_Offsets[p + 1];
+	if (last - first <= LINEAR_SEARCH_DEGREE) {
+		bool found = false;
+		for (; first < last; ++first)
+			found |= (*first == q);
+		return found;
+	}
+	first = std::lower_bound(first, last, q);
+	return first < last && *first == q;
+}
+
+template<typename NodeId, typename EdgeOffset>
+int64 CacheGraphT<NodeId, EdgeOffset>::CountCommonNeighbors(const NodeId p,
+		const NodeId q) const {
+	std::vector<NodeId> BufferP, BufferQ;
+	return IntersectionUtils::Count(NeighborListOf(p, BufferP),
+			static_cast<int64>(m_Offsets[p + 1] - m_Offsets[p]),
+			NeighborListOf(q, BufferQ),
+			static_cast<int64>(m_Offsets[q + 1] - m_Offsets[q]));
+}
+
+template<typename NodeId, typename EdgeOffset>
+int64 CacheGraphT<NodeId, EdgeOffset>::CommonNeighbors(const NodeId p,
+		const NodeId q, std::vector<NodeId>& out) const {
+	std::vector<NodeId> BufferP, BufferQ;
+	const int64 DegreeP = m_Offsets[p + 1] - m_Offsets[p];
+	const int64 DegreeQ = m_Offsets[q + 1] - m_Offsets[q];
+	out.resize(std::min(DegreeP, DegreeQ));
+	const int64 count = IntersectionUtils::Intersect(NeighborListOf(p, BufferP),
+			DegreeP, NeighborListOf(q, BufferQ), DegreeQ, out.data());
+	out.resize(count);
+	return count;
+}
+
+/*
+ Count the triangles of the (undirected version of the) graph.
+ Every edge is oriented from the end that comes first in the degree order (by degree, and then by ID)
+ to the other, which leaves every node with at most sqrt(2E) out neighbors. Every triangle is then
+ found exactly once, as an oriented edge u -> v and a node w in the intersection of the oriented lists
+ of u and v; the nodes are processed in parallel, and the counts are added atomically.
+ NodeTriangles gets the number of triangles of every node, and EdgeTriangles (if not NULL) the number
+ of triangles of every edge, in the order of the neighbor list of this graph.
+ */
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::CountTriangles(
+		std::vector<int64>& NodeTriangles,
+		std::vector<NodeId>* EdgeTriangles) const {
+	const CacheGraphT& graph = directed ? undirected() : *this;
+	const int64 NumberOfNodes = m_NumberOfNodes;
+	const std::vector<NodeId>& Degrees = graph.degrees();
+	auto before = [&Degrees](NodeId p, NodeId q) {
+		return Degrees[p] < Degrees[q] || (Degrees[p] == Degrees[q] && p < q);
+	};
+
+	std::vector<int64> OrientedOffsets(NumberOfNodes + 1, 0);
+	ParallelUtils::ParallelFor(0, NumberOfNodes, TRIANGLE_GRAIN,
+			[&](unsigned int, int64 node) {
+				int64 count = 0;
+				for (NodeId peer : graph.neighbors(static_cast<NodeId>(node)))
+					count += before(static_cast<NodeId>(node), peer);
+				OrientedOffsets[node + 1] = count;
+			});
+	ParallelUtils::InclusiveScan(OrientedOffsets.data() + 1, NumberOfNodes);
+	std::vector<NodeId> Oriented(OrientedOffsets[NumberOfNodes]);
+	ParallelUtils::ParallelFor(0, NumberOfNodes, TRIANGLE_GRAIN,
+			[&](unsigned int, int64 node) {
+				int64 position = OrientedOffsets[node];
+				for (NodeId peer : graph.neighbors(static_cast<NodeId>(node)))
+					if (before(static_cast<NodeId>(node), peer))
+						Oriented[position++] = peer;
+			});
+
+	std::vector<std::atomic<int64> > Triangles(NumberOfNodes);
+	for (int64 node = 0; node < NumberOfNodes; ++node)
+		Triangles[node].store(0, std::memory_order_relaxed);
+	std::vector<std::atomic<NodeId> > OrientedTriangles(
+			EdgeTriangles != NULL ? Oriented.size() : 0);
+	for (size_t edge = 0; edge < OrientedTriangles.size(); ++edge)
+		OrientedTriangles[edge].store(0, std::memory_order_relaxed);
+	std::vector<std::vector<NodeId> > Common(
+			ParallelUtils::GetNumberOfThreads());
+
+	ParallelUtils::ParallelFor(0, NumberOfNodes, TRIANGLE_GRAIN,
+			[&](unsigned int t, int64 node) {
+				const NodeId* first = Oriented.data() + OrientedOffsets[node];
+				const int64 FirstSize = OrientedOffsets[node + 1] - OrientedOffsets[node];
+				std::vector<NodeId>& common = Common[t];
+				for (int64 i = 0; i < FirstSize; ++i) {
+					const NodeId peer = first[i];
+					const NodeId* second = Oriented.data() + OrientedOffsets[peer];
+					const int64 SecondSize = OrientedOffsets[peer + 1] - OrientedOffsets[peer];
+					common.resize(std::min(FirstSize, SecondSize));
+					const int64 count = IntersectionUtils::Intersect(first, FirstSize,
+							second, SecondSize, common.data());
+					if (count == 0)
+						continue;
+					Triangles[node].fetch_add(count, std::memory_order_relaxed);
+					Triangles[peer].fetch_add(count, std::memory_order_relaxed);
+					for (int64 j = 0; j < count; ++j)
+						Triangles[common[j]].fetch_add(1, std::memory_order_relaxed);
+					if (EdgeTriangles == NULL)
+						continue;
+					//the other two edges of every triangle, found in increasing order in both lists
+					OrientedTriangles[OrientedOffsets[node] + i].fetch_add(count,
+							std::memory_order_relaxed);
+					const NodeId* InFirst = first;
+					const NodeId* InSecond = second;
+					for (int64 j = 0; j < count; ++j) {
+						InFirst = std::lower_bound(InFirst, first + FirstSize, common[j]);
+						InSecond = std::lower_bound(InSecond, second + SecondSize, common[j]);
+						OrientedTriangles[InFirst - Oriented.data()].fetch_add(1,
+								std::memory_order_relaxed);
+						OrientedTriangles[InSecond - Oriented.data()].fetch_add(1,
+								std::memory_order_relaxed);
+					}
+				}
+			});
+
+	NodeTriangles.resize(NumberOfNodes);
+	for (int64 node = 0; node < NumberOfNodes; ++node)
+		NodeTriangles[node] = Triangles[node].load(std::memory_order_relaxed);
+	if (EdgeTriangles == NULL)
+		return;
+	EdgeTriangles->assign(m_NumberOfEdges, 0);
+	ParallelUtils::ParallelFor(0, NumberOfNodes, TRIANGLE_GRAIN,
+			[&](unsigned int, int64 node) {
+				const NodeId p = static_cast<NodeId>(node);
+				const NeighborRange range = neighbors(p);
+				for (NeighborIterator it = range.begin(); it != range.end(); ++it) {
+					const NodeId q = *it;
+					if (p == q)
+						continue;
+					const NodeId from = before(p, q) ? p : q;
+					const NodeId to = before(p, q) ? q : p;
+					const NodeId* list = Oriented.data();
+					const NodeId* position = std::lower_bound(list + OrientedOffsets[from],
+							list + OrientedOffsets[from + 1], to);
+					(*EdgeTriangles)[it.edge()] = OrientedTriangles[position
+							- Oriented.data()].load(std::memory_order_relaxed);
+				}
+			});
+}
+
+/*
+ Call visit with the positions of every node two neighbor lists have in common.
+ */
+template<typename NodeId, typename Visitor>
+static void VisitCommonNeighbors(const NodeId* a, int64 SizeA, const NodeId* b,
+		int64 SizeB, Visitor visit) {
+	int64 i = 0, j = 0;
+	while (i < SizeA && j < SizeB) {
+		if (a[i] == b[j])
+			visit(i++, j++);
+		else if (a[i] < b[j])
+			++i;
+		else
+			++j;
+	}
+}
+
+/*
+ Compute the local clustering coefficients of all of the nodes in one parallel pass.
+ With A the adjacency matrix (of the weights' cube roots, for a weighted graph) and the in
+ neighbors taken from the inverse graph, the triangles of node i of every kind are
+	cycle (A^3)ii, middleman (A A^T A)ii, in (A^T A^2)ii and out (A^2 A^T)ii,
+ each of them a sum over the neighbors j of i of the products along the intersection of a list of
+ j with a list of i. Their numbers of possible triangles are din*dout - d<->, din(din-1),
+ dout(dout-1), and dtot(dtot-1) - 2d<-> for the total of the four, where d<-> is the number of
+ reciprocal neighbors. An undirected graph only needs the out triangles, over d(d-1).
+ Self loops are ignored, and a node without possible triangles gets 0.
+ */
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::ComputeClustering(
+		std::vector<std::vector<float> >& Clustering) const {
+	const CacheGraphT& InGraph = directed ? inverse() : *this;
+	const int64 NumberOfNodes = m_NumberOfNodes;
+	std::vector<double> OutWeights, InWeights;
+	if (weighted) {
+		double MaxWeight = 0;
+		for (EdgeOffset edge = 0; edge < m_NumberOfEdges; ++edge)
+			MaxWeight = std::max(MaxWeight, m_Weights[edge]);
+		if (MaxWeight <= 0)
+			MaxWeight = 1;
+		OutWeights.resize(m_NumberOfEdges);
+		for (EdgeOffset edge = 0; edge < m_NumberOfEdges; ++edge)
+			OutWeights[edge] = std::cbrt(m_Weights[edge] / MaxWeight);
+		if (directed) {
+			InWeights.resize(InGraph.m_NumberOfEdges);
+			for (EdgeOffset edge = 0; edge < InGraph.m_NumberOfEdges; ++edge)
+				InWeights[edge] = std::cbrt(InGraph.m_Weights[edge] / MaxWeight);
 		}
 	}
-	return false;  // not found
+	const double* OutW = weighted ? OutWeights.data() : NULL;
+	const double* InW = weighted && directed ? InWeights.data() : OutW;
+	auto weight = [](const double* weights, int64 edge) {
+		return weights != NULL ? weights[edge] : 1.0;
+	};
 
+	Clustering.assign(NUMBER_OF_CLUSTERING_TYPES,
+			std::vector<float>(NumberOfNodes, 0.0f));
+	std::vector<std::vector<NodeId> > Buffers(
+			4 * ParallelUtils::GetNumberOfThreads());
+	ParallelUtils::ParallelFor(0, NumberOfNodes, TRIANGLE_GRAIN,
+			[&](unsigned int t, int64 node) {
+				const NodeId i = static_cast<NodeId>(node);
+				const int64 OutBase = m_Offsets[i], InBase = InGraph.m_Offsets[i];
+				const int64 OutSize = m_Offsets[i + 1] - OutBase;
+				const int64 InSize = InGraph.m_Offsets[i + 1] - InBase;
+				const NodeId* Out = NeighborListOf(i, Buffers[4 * t]);
+				const NodeId* In = InGraph.NeighborListOf(i, Buffers[4 * t + 1]);
+				double cycles = 0, middlemen = 0, ins = 0, outs = 0;
+				for (int64 a = 0; a < OutSize; ++a) {
+					const NodeId j = Out[a];
+					if (j == i)
+						continue;
+					const int64 OutBaseJ = m_Offsets[j];
+					const int64 OutSizeJ = m_Offsets[j + 1] - OutBaseJ;
+					const NodeId* OutJ = NeighborListOf(j, Buffers[4 * t + 2]);
+					double sum = 0;
+					VisitCommonNeighbors(OutJ, OutSizeJ, Out, OutSize,
+							[&](int64 x, int64 y) {
+								if (OutJ[x] != i && OutJ[x] != j)
+									sum += weight(OutW, OutBaseJ + x) * weight(OutW, OutBase + y);
+							});
+					outs += weight(OutW, OutBase + a) * sum;
+					if (!directed)
+						continue;
+					sum = 0;
+					VisitCommonNeighbors(OutJ, OutSizeJ, In, InSize,
+							[&](int64 x, int64 y) {
+								if (OutJ[x] != i && OutJ[x] != j)
+									sum += weight(OutW, OutBaseJ + x) * weight(InW, InBase + y);
+							});
+					cycles += weight(OutW, OutBase + a) * sum;
+					const int64 InBaseJ = InGraph.m_Offsets[j];
+					const int64 InSizeJ = InGraph.m_Offsets[j + 1] - InBaseJ;
+					const NodeId* InJ = InGraph.NeighborListOf(j, Buffers[4 * t + 3]);
+					sum = 0;
+					VisitCommonNeighbors(InJ, InSizeJ, In, InSize,
+							[&](int64 x, int64 y) {
+								if (InJ[x] != i && InJ[x] != j)
+									sum += weight(InW, InBaseJ + x) * weight(InW, InBase + y);
+							});
+					middlemen += weight(OutW, OutBase + a) * sum;
+				}
+
+				const int64 SelfLoop = std::binary_search(Out, Out + OutSize, i);
+				const double OutDegree = OutSize - SelfLoop;
+				if (!directed) {
+					const double pairs = OutDegree * (OutDegree - 1);
+					for (int type = 0; type < NUMBER_OF_CLUSTERING_TYPES; ++type)
+						Clustering[type][node] = pairs > 0 ? static_cast<float>(outs / pairs) : 0.0f;
+					return;
+				}
+				for (int64 b = 0; b < InSize; ++b) {
+					const NodeId j = In[b];
+					if (j == i)
+						continue;
+					const int64 OutBaseJ = m_Offsets[j];
+					const int64 OutSizeJ = m_Offsets[j + 1] - OutBaseJ;
+					const NodeId* OutJ = NeighborListOf(j, Buffers[4 * t + 2]);
+					double sum = 0;
+					VisitCommonNeighbors(OutJ, OutSizeJ, In, InSize,
+							[&](int64 x, int64 y) {
+								if (OutJ[x] != i && OutJ[x] != j)
+									sum += weight(OutW, OutBaseJ + x) * weight(InW, InBase + y);
+							});
+					ins += weight(InW, InBase + b) * sum;
+				}
+				const double InDegree = InSize - SelfLoop;
+				const double reciprocal = IntersectionUtils::Count(Out, OutSize, In, InSize)
+						- SelfLoop;
+				const double TotalDegree = InDegree + OutDegree;
+				const double possible[NUMBER_OF_CLUSTERING_TYPES] = {
+						TotalDegree * (TotalDegree - 1) - 2 * reciprocal,
+						InDegree * OutDegree - reciprocal,
+						InDegree * OutDegree - reciprocal,
+						InDegree * (InDegree - 1),
+						OutDegree * (OutDegree - 1) };
+				const double found[NUMBER_OF_CLUSTERING_TYPES] = {
+						cycles + middlemen + ins + outs, cycles, middlemen, ins, outs };
+				for (int type = 0; type < NUMBER_OF_CLUSTERING_TYPES; ++type)
+					Clustering[type][node] = possible[type] > 0 ?
+							static_cast<float>(found[type] / possible[type]) : 0.0f;
+			});
 }
 
-std::vector<unsigned int>* CacheGraph::SortedNodesByDegree() const {
-	std::vector<unsigned int>* sortedNodes = new std::vector<unsigned int>();
+/*
+ Build the neighbor index (see the header): the kind and size of every node's index is chosen by
+ its degree, and then the hash sets and bitmaps are filled in parallel.
+ A node gets a bitmap when it's no larger than the hash set it would otherwise get, so the index
+ takes at most 2 * sizeof(NodeId) bytes per edge.
+ */
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::BuildNeighborIndex() const {
+	std::lock_guard<std::recursive_mutex> lock(m_ViewsMutex);
+	if (hasNeighborIndex())
+		return;
+	NeighborIndex* index = new NeighborIndex();
+	index->kinds.assign(m_NumberOfNodes, INDEX_LINEAR);
+	index->positions.assign(m_NumberOfNodes, 0);
+	const int64 BitmapWords = (static_cast<int64>(m_NumberOfNodes) + 63) / 64;
+	int64 HashSetsSize = 0, BitmapsSize = 0;
+	for (NodeId node = 0; node < m_NumberOfNodes; ++node) {
+		const int64 degree = m_Offsets[node + 1] - m_Offsets[node];
+		if (degree <= LINEAR_SEARCH_DEGREE)
+			continue;
+		//a hash set with a load factor of at most a half
+		unsigned int bits = 1;
+		while ((int64(1) << bits) < 2 * degree)
+			++bits;
+		if (BitmapWords * sizeof(int64) <= (1ULL << bits) * sizeof(NodeId)) {
+			index->kinds[node] = INDEX_BITMAP;
+			index->positions[node] = BitmapsSize;
+			BitmapsSize += BitmapWords;
+		} else {
+			index->kinds[node] = static_cast<unsigned char>(bits);
+			index->positions[node] = HashSetsSize;
+			HashSetsSize += int64(1) << bits;
+		}
+	}
+	index->hashSets.assign(HashSetsSize, static_cast<NodeId>(-1));
+	index->bitmaps.assign(BitmapsSize, 0);
+
+	ParallelUtils::ParallelFor(0, m_NumberOfNodes, 1024,
+			[&](unsigned int, int64 node) {
+				const unsigned char kind = index->kinds[node];
+				const int64 position = index->positions[node];
+				if (kind == INDEX_LINEAR)
+					return;
+				for (NodeId neighbor : neighbors(node)) {
+					if (kind == INDEX_BITMAP) {
+						index->bitmaps[position + (neighbor >> 6)] |= 1ULL
+								<< (neighbor & 63);
+						continue;
+					}
+					const int64 mask = (1ULL << kind) - 1;
+					int64 slot = NeighborHash(neighbor, kind);
+					while (index->hashSets[position + slot] != static_cast<NodeId>(-1)
+							&& index->hashSets[position + slot] != neighbor)
+						slot = (slot + 1) & mask;
+					index->hashSets[position + slot] = neighbor;
+				}
+			});
+	m_NeighborIndex.store(index, std::memory_order_release);
+}
+
+template<typename NodeId, typename EdgeOffset>
+std::vector<NodeId>* CacheGraphT<NodeId, EdgeOffset>::SortedNodesByDegree() const {
+	std::vector<NodeId>* sortedNodes = new std::vector<NodeId>();
+	//use the precomputed order if it was saved with the graph
+	sortedNodes->resize(m_NumberOfNodes);
+	if (ReadSection(SECTION_DEGREE_ORDER, sortedNodes->data(), m_NumberOfNodes))
+		return sortedNodes;
+	sortedNodes->clear();
 	sortedNodes->reserve(m_NumberOfNodes);
 
-	std::vector<unsigned int> nodeDegrees = ComputeNodeDegrees();
+	const std::vector<NodeId>& nodeDegrees = degrees();
 	std::vector<NodeWithDegree> nodesWithDegrees;
 	nodesWithDegrees.reserve(m_NumberOfNodes);
-	for (unsigned int node = 0; node < m_NumberOfNodes; node++)
+	for (NodeId node = 0; node < m_NumberOfNodes; node++)
 		nodesWithDegrees.push_back( { node, nodeDegrees[node] });
 
 	std::sort(nodesWithDegrees.begin(), nodesWithDegrees.end(),
@@ -416,3 +1782,217 @@ std::vector<unsigned int>* CacheGraph::SortedNodesByDegree() const {
 		sortedNodes->push_back(nd.node);
 	return sortedNodes;
 }
+
+/*
+ Compute a new ID for every node, so that nodes that are accessed together are stored together.
+ Returns NewIds, where NewIds[node] is the new ID of node (see NodeOrdering for the orderings).
+ */
+template<typename NodeId, typename EdgeOffset>
+std::vector<NodeId> CacheGraphT<NodeId, EdgeOffset>::ComputeNodeOrdering(
+		NodeOrdering Ordering) const {
+	//the old IDs of the nodes, in their new order
+	std::vector<NodeId> Order;
+	Order.reserve(m_NumberOfNodes);
+	if (Ordering == ORDER_DEGREE) {
+		Order = degreeOrder();
+	} else if (Ordering == ORDER_RCM) {
+		ReverseCuthillMcKeeOrder(Order);
+	} else if (Ordering == ORDER_COMMUNITY) {
+		CommunityOrder(Order);
+	} else {
+		Order.resize(m_NumberOfNodes);
+		std::iota(Order.begin(), Order.end(), 0);
+	}
+
+	std::vector<NodeId> NewIds(m_NumberOfNodes);
+	for (NodeId index = 0; index < m_NumberOfNodes; ++index)
+		NewIds[Order[index]] = index;
+	return NewIds;
+}
+
+/*
+ Reverse Cuthill-McKee: a BFS over the undirected graph, that starts every connected component at
+ a node of the smallest degree and visits the neighbors of every node by ascending degree.
+ The BFS order is then reversed.
+ */
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::ReverseCuthillMcKeeOrder(
+		std::vector<NodeId>& Order) const {
+	const CacheGraphT& graph = directed ? undirected() : *this;
+	const std::vector<NodeId>& Degrees = graph.degrees();
+	auto ByDegree = [&Degrees](NodeId lhs, NodeId rhs) {
+		return Degrees[lhs] < Degrees[rhs];
+	};
+
+	std::vector<NodeId> Starts(m_NumberOfNodes);
+	std::iota(Starts.begin(), Starts.end(), 0);
+	std::stable_sort(Starts.begin(), Starts.end(), ByDegree);
+
+	std::vector<bool> visited(m_NumberOfNodes, false);
+	std::vector<NodeId> Neighbors;
+	Order.clear();
+	for (NodeId start : Starts) {
+		if (visited[start])
+			continue;
+		visited[start] = true;
+		Order.push_back(start);
+		for (size_t head = Order.size() - 1; head < Order.size(); ++head) {
+			Neighbors.clear();
+			for (NodeId neighbor : graph.neighbors(Order[head]))
+				if (!visited[neighbor]) {
+					visited[neighbor] = true;
+					Neighbors.push_back(neighbor);
+				}
+			std::stable_sort(Neighbors.begin(), Neighbors.end(), ByDegree);
+			Order.insert(Order.end(), Neighbors.begin(), Neighbors.end());
+		}
+	}
+	std::reverse(Order.begin(), Order.end());
+}
+
+/*
+ Group the nodes by community, in the spirit of Rabbit Order but with a single level of
+ communities: the communities are found by label propagation over the undirected graph (every node
+ repeatedly takes the most common label among its neighbors, preferring its own label and then the
+ smallest one on ties). The communities are ordered by their first node, and the nodes within a
+ community keep their original order.
+ */
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::CommunityOrder(
+		std::vector<NodeId>& Order) const {
+	const unsigned int MAX_ITERATIONS = 20;
+	const CacheGraphT& graph = directed ? undirected() : *this;
+	std::vector<NodeId> Labels(m_NumberOfNodes);
+	std::iota(Labels.begin(), Labels.end(), 0);
+
+	std::vector<NodeId> NeighborLabels;
+	bool changed = true;
+	for (unsigned int iteration = 0; iteration < MAX_ITERATIONS && changed;
+			++iteration) {
+		changed = false;
+		for (NodeId node = 0; node < m_NumberOfNodes; ++node) {
+			NeighborLabels.clear();
+			for (NodeId neighbor : graph.neighbors(node))
+				if (neighbor != node)
+					NeighborLabels.push_back(Labels[neighbor]);
+			if (NeighborLabels.empty())
+				continue;
+			std::sort(NeighborLabels.begin(), NeighborLabels.end());
+			//find the most common label, the sort makes the smallest label win ties
+			NodeId BestLabel = Labels[node];
+			size_t BestCount = std::count(NeighborLabels.begin(),
+					NeighborLabels.end(), BestLabel);
+			for (size_t first = 0, last; first < NeighborLabels.size();
+					first = last) {
+				for (last = first;
+						last < NeighborLabels.size()
+								&& NeighborLabels[last] == NeighborLabels[first];
+						++last)
+					;
+				if (last - first > BestCount) {
+					BestLabel = NeighborLabels[first];
+					BestCount = last - first;
+				}
+			}
+			if (BestLabel != Labels[node]) {
+				Labels[node] = BestLabel;
+				changed = true;
+			}
+		}
+	}
+
+	//number the communities by their first node, and sort the nodes by community
+	const NodeId UNSET = static_cast<NodeId>(-1);
+	std::vector<NodeId> Community(m_NumberOfNodes, UNSET);
+	NodeId NumberOfCommunities = 0;
+	for (NodeId node = 0; node < m_NumberOfNodes; ++node)
+		if (Community[Labels[node]] == UNSET)
+			Community[Labels[node]] = NumberOfCommunities++;
+	Order.resize(m_NumberOfNodes);
+	std::iota(Order.begin(), Order.end(), 0);
+	std::stable_sort(Order.begin(), Order.end(),
+			[&Community, &Labels](NodeId lhs, NodeId rhs) {
+				return Community[Labels[lhs]] < Community[Labels[rhs]];
+			});
+}
+
+/*
+ Build the graph with the nodes relabeled to NewIds (see ComputeNodeOrdering).
+ The neighbor lists (and weights) are relabeled and sorted again, in parallel.
+ */
+template<typename NodeId, typename EdgeOffset>
+void CacheGraphT<NodeId, EdgeOffset>::Relabel(const std::vector<NodeId>& NewIds,
+		CacheGraphT& RelabeledGraph) const {
+	RelabeledGraph.Clear();
+	RelabeledGraph.directed = directed;
+	RelabeledGraph.m_NumberOfNodes = m_NumberOfNodes;
+	RelabeledGraph.m_NumberOfEdges = m_NumberOfEdges;
+	std::vector<NodeId> Order(m_NumberOfNodes);
+	for (NodeId node = 0; node < m_NumberOfNodes; ++node)
+		Order[NewIds[node]] = node;
+
+	EdgeOffset* offsets = new EdgeOffset[m_NumberOfNodes + 1];
+	offsets[0] = 0;
+	for (NodeId index = 0; index < m_NumberOfNodes; ++index)
+		offsets[index + 1] = m_Offsets[Order[index] + 1] - m_Offsets[Order[index]];
+	ParallelUtils::InclusiveScan(offsets + 1, m_NumberOfNodes);
+	NodeId* graph = new NodeId[m_NumberOfEdges];
+	double* weights = weighted ? new double[m_NumberOfEdges] : NULL;
+
+	std::vector<std::vector<std::pair<NodeId, double> > > Buffers(
+			ParallelUtils::GetNumberOfThreads());
+	ParallelUtils::ParallelFor(0, m_NumberOfNodes, 1024,
+			[&](unsigned int t, int64 index) {
+				const NeighborRange list = neighbors(Order[index]);
+				if (weights == NULL) {
+					NodeId* out = graph + offsets[index];
+					for (NodeId neighbor : list)
+						*out++ = NewIds[neighbor];
+					std::sort(graph + offsets[index], out);
+					return;
+				}
+				std::vector<std::pair<NodeId, double> >& Buffer = Buffers[t];
+				Buffer.clear();
+				for (NeighborIterator it = list.begin(); it != list.end(); ++it)
+					Buffer.push_back(std::make_pair(NewIds[*it], m_Weights[it.edge()]));
+				std::sort(Buffer.begin(), Buffer.end());
+				for (size_t i = 0; i < Buffer.size(); ++i) {
+					graph[offsets[index] + i] = Buffer[i].first;
+					weights[offsets[index] + i] = Buffer[i].second;
+				}
+			});
+
+	RelabeledGraph.m_Offsets = offsets;
+	RelabeledGraph.m_Graph = graph;
+	RelabeledGraph.m_Weights = weights;
+	RelabeledGraph.weighted = weighted;
+}
+
+template class CacheGraphT<unsigned int, unsigned int> ;
+template class CacheGraphT<unsigned int, int64> ;
+template class CacheGraphT<int64, int64> ;
+//the lists can hold 32 or 64 bit node IDs
+template void CompactCacheGraph::Assign<unsigned int>(const std::vector<int64>&,
+		const std::vector<unsigned int>&);
+template void CompactCacheGraph::Assign<unsigned int>(const std::vector<int64>&,
+		const std::vector<unsigned int>&, const std::vector<double>&);
+template void CompactCacheGraph::Assign<int64>(const std::vector<int64>&,
+		const std::vector<int64>&);
+template void CompactCacheGraph::Assign<int64>(const std::vector<int64>&,
+		const std::vector<int64>&, const std::vector<double>&);
+template void CacheGraph::Assign<unsigned int>(const std::vector<int64>&,
+		const std::vector<unsigned int>&);
+template void CacheGraph::Assign<unsigned int>(const std::vector<int64>&,
+		const std::vector<unsigned int>&, const std::vector<double>&);
+template void CacheGraph::Assign<int64>(const std::vector<int64>&,
+		const std::vector<int64>&);
+template void CacheGraph::Assign<int64>(const std::vector<int64>&,
+		const std::vector<int64>&, const std::vector<double>&);
+template void LargeCacheGraph::Assign<unsigned int>(const std::vector<int64>&,
+		const std::vector<unsigned int>&);
+template void LargeCacheGraph::Assign<unsigned int>(const std::vector<int64>&,
+		const std::vector<unsigned int>&, const std::vector<double>&);
+template void LargeCacheGraph::Assign<int64>(const std::vector<int64>&,
+		const std::vector<int64>&);
+template void LargeCacheGraph::Assign<int64>(const std::vector<int64>&,
+		const std::vector<int64>&, const std::vector<double>&);
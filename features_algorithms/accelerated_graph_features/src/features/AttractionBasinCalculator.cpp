@@ -6,186 +6,278 @@
  */
 
 #include "../includes/AttractionBasinCalculator.h"
-#include <iostream>
+#include "../includes/ParallelUtils.h"
+#include "../includes/PivotSampling.h"
+#include "../includes/HyperAnf.h"
+#include <limits>
 
-AttractionBasinCalculator::AttractionBasinCalculator(int alpha) :
-		alpha(alpha), ab_in_dist(NULL), ab_out_dist(NULL), average_out_per_dist(
-		NULL), average_in_per_dist(NULL), features(NULL) {
+template<typename GraphT>
+const unsigned int AttractionBasinCalculatorT<GraphT>::SOURCES_PER_BFS;
+
+template<typename GraphT>
+AttractionBasinCalculatorT<GraphT>::AttractionBasinCalculatorT(int alpha) :
+		alpha(alpha), numOfPivots(0), log2Registers(0), seed(0), stratified(false) {
 }
-AttractionBasinCalculator::AttractionBasinCalculator() :
-		AttractionBasinCalculator(2) {
+template<typename GraphT>
+AttractionBasinCalculatorT<GraphT>::AttractionBasinCalculatorT() :
+		AttractionBasinCalculatorT(2) {
 }
 
-void AttractionBasinCalculator::printVars() {
-	int i = 0;
-	std::cout << "ab_out_dist" << std::endl;
-	for (auto& m : *(this->ab_out_dist)) {
-		std::cout << "Map at " << i++ << std::endl;
-		for (auto& x : *m)
-			std::cout << x.first << " : " << x.second << std::endl;
-
-	}
-	i = 0;
-	std::cout << "ab_in_dist" << std::endl;
-	for (auto& m : *(this->ab_in_dist)) {
-		std::cout << "Map at " << i++ << std::endl;
-		for (auto& x : *m)
-			std::cout << x.first << " : " << x.second << std::endl;
-
-	}
-
-	std::cout << "avg_out" << std::endl;
-	for (auto& x : *average_out_per_dist)
-		std::cout << x.first << " : " << x.second << std::endl;
+template<typename GraphT>
+void AttractionBasinCalculatorT<GraphT>::SetPivotSampling(
+		unsigned int NumberOfPivots, unsigned int seed, bool stratified) {
+	this->numOfPivots = NumberOfPivots;
+	this->seed = seed;
+	this->stratified = stratified;
+}
 
-	std::cout << "avg_in" << std::endl;
-	for (auto& x : *average_in_per_dist)
-		std::cout << x.first << " : " << x.second << std::endl;
+template<typename GraphT>
+void AttractionBasinCalculatorT<GraphT>::SetHyperAnf(unsigned int Log2Registers,
+		unsigned int seed) {
+	this->log2Registers = Log2Registers;
+	this->seed = seed;
 }
 
-std::vector<double>* AttractionBasinCalculator::Calculate() {
-	//std::cout << "Begin"<<std::endl;
-	this->calc_attraction_basin_dists();
-	//std::cout << "After dists"<<std::endl;
-	this->calc_average_per_dist();
-	//std::cout << "After avg"<<std::endl;
-	unsigned int numOfNodes = mGraph->GetNumberOfNodes();
-	//std::cout <<"alpha:"<<alpha<<std::endl;
-	//printVars();
-
-	features = new std::vector<double>();
-	for (unsigned int node = 0; node < numOfNodes; node++) {
-		auto out_dist = ab_out_dist->at(node);
-		auto in_dist = ab_in_dist->at(node);
-
-		features->push_back(-1);
-
-		double numerator = 0, denominator = 0;
-		for (auto& x : *out_dist) {
-			auto dist = x.first;
-			auto occurances = x.second;
-
-			//	std::cout <<"\tdist: " <<dist<<std::endl;
-			//	std::cout <<"\toccurances: " <<occurances<<std::endl;
-			//	std::cout << "\tavg at dist: " <<average_out_per_dist->at(dist)<<std::endl;
-			//	std::cout <<"\tpow: "<<1/(double) pow(alpha,dist)<<std::endl;
-			denominator += (occurances / average_out_per_dist->at(dist))
-					* (1 / (double) pow(alpha, dist));
-
-		} //end summing loop
-
-//	std::cout << "denom : "<<denominator<<std::endl;
-		if (denominator != 0) {
-			for (auto& x : *in_dist) {
-				auto dist = x.first;
-				auto occurances = x.second;
-
-				numerator += (occurances / average_in_per_dist->at(dist))
-						* (1 / (double) pow(alpha, dist));
-			} //end summing loop
-			(*features)[node] = numerator / denominator;
-		} //end if
+template<typename GraphT>
+std::vector<double>* AttractionBasinCalculatorT<GraphT>::Calculate() {
+	const GraphT& graph = *this->mGraph;
+	confidenceIntervals.clear();
+	if (numOfPivots > 0)
+		return CalculateApproximate();
+	if (log2Registers > 0)
+		return CalculateHyperAnf();
+	this->calc_attraction_basin_dists(graph, ab_out_dist, average_out_per_dist);
+	if (graph.isDirected())
+		this->calc_attraction_basin_dists(graph.inverse(), ab_in_dist,
+				average_in_per_dist);
+	else {
+		ab_in_dist = ab_out_dist;
+		average_in_per_dist = average_out_per_dist;
 	}
 
-	return this->features;
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	std::vector<double>* features = new std::vector<double>(numOfNodes, -1);
+	ParallelUtils::ParallelFor(0, numOfNodes, SOURCES_PER_BFS,
+			[&](unsigned int, int64 node) {
+				const int64 batch = node / SOURCES_PER_BFS;
+				const int64 i = node % SOURCES_PER_BFS;
+				const int64 batchSize = std::min<int64>(SOURCES_PER_BFS,
+						numOfNodes - batch * SOURCES_PER_BFS);
+				auto decayed_sum = [&](const std::vector<int64>& counts,
+						const std::vector<double>& average) {
+					double sum = 0, decay = 1;
+					//distance 0 is the node itself
+					for (size_t dist = 1; dist * batchSize < counts.size(); dist++) {
+						decay /= alpha;
+						sum += (counts[dist * batchSize + i] / average[dist]) * decay;
+					}
+					return sum;
+				};
+				const double denominator = decayed_sum(ab_out_dist[batch],
+						average_out_per_dist);
+				if (denominator != 0)
+					(*features)[node] = decayed_sum(ab_in_dist[batch],
+							average_in_per_dist) / denominator;
+			});
+
+	return features;
 }
 
-void AttractionBasinCalculator::calc_attraction_basin_dists() {
-
-	unsigned int numOfNodes = mGraph->GetNumberOfNodes();
-	this->ab_in_dist = new std::vector<std::map<unsigned int, unsigned int>*>();
-	this->ab_out_dist =
-			new std::vector<std::map<unsigned int, unsigned int>*>();
-
-// Build a distance matrix
-	std::vector<std::vector<unsigned int>*> dists;
-	dists.reserve(numOfNodes);
-	for (unsigned int node = 0; node < numOfNodes; node++) {
-		auto bfsDist = DistanceUtils::BfsSingleSourceShortestPath(mGraph, node);
-		dists.push_back(
-				new std::vector<unsigned int>(bfsDist.begin(), bfsDist.end()));
-		ab_out_dist->push_back(new std::map<unsigned int, unsigned int>());
-		ab_in_dist->push_back(new std::map<unsigned int, unsigned int>());
+/*
+ The averages per distance are estimated from the counts of the pivots in both directions (every
+ pair of nodes at distance d is counted once by each), so that every distance a pivot's BFS
+ reaches has an average. Every pivot p then adds alpha^-d / average[d] (expanded by its weight)
+ to the in sum of the node at distance d from p, and to the out sum of the node at distance d
+ to p. Distance 1, which has the largest terms, is counted exactly from the neighbor lists.
+ */
+template<typename GraphT>
+std::vector<double>* AttractionBasinCalculatorT<GraphT>::CalculateApproximate() {
+	const GraphT& graph = *this->mGraph;
+	const GraphT& inverseGraph = graph.isDirected() ? graph.inverse() : graph;
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	std::vector<NodeId> pivots;
+	std::vector<double> weights;
+	PivotSampling::SamplePivots(graph, numOfPivots, seed, stratified, pivots, weights);
+	const int64 k = pivots.size();
+
+	this->calc_attraction_basin_dists(graph, ab_out_dist, average_out_per_dist,
+			&pivots, &weights);
+	this->calc_attraction_basin_dists(inverseGraph, ab_in_dist, average_in_per_dist,
+			&pivots, &weights);
+	//the neighbors of every node, without self loops
+	std::vector<int64> out_neighbors(numOfNodes, 0), in_neighbors(numOfNodes, 0);
+	int64 numOfEdges = 0;
+	for (int64 node = 0; node < numOfNodes; node++)
+		for (NodeId neighbor : graph.neighbors(static_cast<NodeId>(node)))
+			if (neighbor != node) {
+				out_neighbors[node]++;
+				in_neighbors[neighbor]++;
+				numOfEdges++;
+			}
+	std::vector<double> decayed_average(
+			std::max<size_t>(2, std::max(average_out_per_dist.size(), average_in_per_dist.size())),
+			0);
+	decayed_average[1] = numOfEdges > 0 ? numOfNodes / (double) (alpha * numOfEdges) : 0;
+	double decay = 1.0 / alpha;
+	for (size_t dist = 2; dist < decayed_average.size(); dist++) {
+		decay /= alpha;
+		const double average = ((dist < average_out_per_dist.size() ?
+				average_out_per_dist[dist] : 0)
+				+ (dist < average_in_per_dist.size() ? average_in_per_dist[dist] : 0)) / 2;
+		decayed_average[dist] = decay / average;
 	}
+	//the counts are only needed for the averages
+	ab_out_dist.clear();
+	ab_in_dist.clear();
+
+	std::vector<PivotTotals<2> > totals(numOfNodes);
+	const unsigned int batchSize = PivotSampling::BatchSize();
+	std::vector<BfsWorkspaceT<GraphT> > fromPivot(batchSize), toPivot(batchSize);
+	PivotSampling::RunPivots(k, numOfNodes,
+			[&](unsigned int slot, int64 pivot) {
+				DistanceUtils::Bfs(graph, pivots[pivot], fromPivot[slot]);
+				if (graph.isDirected())
+					DistanceUtils::Bfs(inverseGraph, pivots[pivot], toPivot[slot]);
+			},
+			[&](int64 node, unsigned int slot, int64 pivot) {
+				const unsigned int inDist = fromPivot[slot].GetDistances()[node];
+				const unsigned int outDist = (graph.isDirected() ? toPivot[slot] :
+						fromPivot[slot]).GetDistances()[node];
+				const bool in = inDist != BfsWorkspaceT<GraphT>::UNREACHABLE && inDist > 1;
+				const bool out = outDist != BfsWorkspaceT<GraphT>::UNREACHABLE && outDist > 1;
+				if (!in && !out)
+					return;
+				const double expansion = k * weights[pivot];
+				const double contribution[2] = { in ? expansion * decayed_average[inDist] : 0,
+						out ? expansion * decayed_average[outDist] : 0 };
+				totals[node].Add(contribution);
+			});
+
+	std::vector<double>* features = new std::vector<double>(numOfNodes, -1);
+	confidenceIntervals.assign(numOfNodes, std::numeric_limits<double>::quiet_NaN());
+	ParallelUtils::ParallelFor(0, numOfNodes, PivotSampling::ACCUMULATE_GRAIN,
+			[&](unsigned int, int64 node) {
+				const double denominator = out_neighbors[node] * decayed_average[1]
+						+ totals[node].Total(1, k);
+				if (denominator == 0)
+					return;
+				const double feature = (in_neighbors[node] * decayed_average[1]
+						+ totals[node].Total(0, k)) / denominator;
+				const double gradient[2] = { 1 / denominator, -feature / denominator };
+				(*features)[node] = feature;
+				confidenceIntervals[node] = totals[node].HalfWidth(gradient, k, numOfNodes);
+			});
+	return features;
+}
 
-//std:cout << ab_out_dist->size()<<std::endl;
-
-	for (unsigned int src = 0; src < numOfNodes; src++) {
-		for (unsigned int dest = 0; dest < numOfNodes; dest++) {
-			unsigned int d = dists.at(src)->at(dest);
-			if (d > 0) {
-				(*((*ab_out_dist)[src]))[d] =
-						(ab_out_dist->at(src)->count(d) == 1) ?
-								ab_out_dist->at(src)->at(d) + 1 : 1;
-
-				(*(*ab_in_dist)[dest])[d] =
-						(ab_in_dist->at(dest)->find(d)
-								!= ab_in_dist->at(dest)->end()) ?
-								ab_in_dist->at(dest)->at(d) + 1 : 1;
-
-			} // end if
-		}  // end dest loop
-	} //end src loop
+template<typename GraphT>
+std::vector<double>* AttractionBasinCalculatorT<GraphT>::CalculateHyperAnf() {
+	const GraphT& graph = *this->mGraph;
+	std::vector<double> out_sums, in_sums;
+	this->hyperanf_decayed_sums(graph, out_sums);
+	if (graph.isDirected())
+		this->hyperanf_decayed_sums(graph.inverse(), in_sums);
+	else
+		in_sums = out_sums;
+
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	std::vector<double>* features = new std::vector<double>(numOfNodes, -1);
+	for (int64 node = 0; node < numOfNodes; node++)
+		if (out_sums[node] != 0)
+			(*features)[node] = in_sums[node] / out_sums[node];
+	return features;
+}
 
-	for (auto& p : dists)
-		delete p;
+/*
+ The estimated count at distance d of a node is the growth of its estimated ball from distance
+ d - 1, and all of the counts at distance d are known together, with their average.
+ */
+template<typename GraphT>
+void AttractionBasinCalculatorT<GraphT>::hyperanf_decayed_sums(const GraphT& graph,
+		std::vector<double>& sums) {
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	std::vector<double> previous, counts(numOfNodes);
+	std::vector<double> totals(ParallelUtils::GetNumberOfThreads());
+	sums.assign(numOfNodes, 0);
+	double decay = 1;
+	HyperAnf::BallSizes(graph, log2Registers, seed,
+			[&](unsigned int distance, const std::vector<double>& balls) {
+				if (distance == 0) {
+					previous = balls;
+					return;
+				}
+				std::fill(totals.begin(), totals.end(), 0);
+				ParallelUtils::ParallelFor(0, numOfNodes, HyperAnf::MERGE_GRAIN,
+						[&](unsigned int t, int64 node) {
+							counts[node] = std::max(balls[node] - previous[node], 0.0);
+							previous[node] = std::max(balls[node], previous[node]);
+							totals[t] += counts[node];
+						});
+				decay /= alpha;
+				double total = 0;
+				for (double threadTotal : totals)
+					total += threadTotal;
+				if (total == 0)
+					return;
+				const double factor = decay * numOfNodes / total;
+				ParallelUtils::ParallelFor(0, numOfNodes, HyperAnf::MERGE_GRAIN,
+						[&](unsigned int, int64 node) {
+							sums[node] += counts[node] * factor;
+						});
+			});
 }
 
-void AttractionBasinCalculator::calc_average_per_dist() {
-	average_in_per_dist = new std::map<unsigned int, double>();
-	average_out_per_dist = new std::map<unsigned int, double>();
-
-	unsigned int numOfNodes = mGraph->GetNumberOfNodes();
-	for (unsigned int src = 0; src < numOfNodes; src++) {
-
-		// Unify the in distance counters
-		auto counter = ab_in_dist->at(src);
-		for (auto& x : *counter) {
-			auto dist = x.first;
-			auto occurances = x.second;
-			(*average_in_per_dist)[dist] =
-					(average_in_per_dist->find(dist)
-							!= average_in_per_dist->end()) ?
-							average_in_per_dist->at(dist) + occurances :
-							occurances;
-		}
-
-		// Unify the out distances
-		counter = ab_out_dist->at(src);
-		for (auto& x : *counter) {
-			auto dist = x.first;
-			auto occurances = x.second;
-			(*average_out_per_dist)[dist] =
-					(average_out_per_dist->find(dist)
-							!= average_out_per_dist->end()) ?
-							average_out_per_dist->at(dist) + occurances :
-							occurances;
-		}
-
-	} // End src loop
-
-	for (auto& d : *average_out_per_dist) {
-		(*average_out_per_dist)[d.first] = d.second / (double) numOfNodes;
-	}
-	for (auto& d : *average_in_per_dist) {
-		(*average_in_per_dist)[d.first] = d.second / (double) numOfNodes;
+/*
+ Count the nodes at every distance from every source, batch by batch, and the average of these
+ counts over all of the nodes.
+ */
+template<typename GraphT>
+void AttractionBasinCalculatorT<GraphT>::calc_attraction_basin_dists(
+		const GraphT& graph, std::vector<std::vector<int64> >& counts,
+		std::vector<double>& average_per_dist, const std::vector<NodeId>* sources,
+		const std::vector<double>* weights) {
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	const int64 numOfSources = sources ? sources->size() : numOfNodes;
+	const int64 numOfBatches = (numOfSources + SOURCES_PER_BFS - 1) / SOURCES_PER_BFS;
+	counts.assign(numOfBatches, std::vector<int64>());
+
+	const unsigned int numOfThreads = ParallelUtils::GetNumberOfThreads();
+	std::vector<MultiSourceBfsWorkspaceT<GraphT> > workspaces(numOfThreads);
+	std::vector<std::vector<NodeId> > batchSources(numOfThreads);
+	std::vector<std::vector<double> > totals(numOfThreads);
+	ParallelUtils::ParallelFor(0, numOfBatches, 1,
+			[&](unsigned int t, int64 batch) {
+				const int64 first = batch * SOURCES_PER_BFS;
+				const unsigned int batchSize = std::min<int64>(SOURCES_PER_BFS,
+						numOfSources - first);
+				batchSources[t].clear();
+				for (int64 i = first; i < first + batchSize; i++)
+					batchSources[t].push_back(sources ? (*sources)[i] : static_cast<NodeId>(i));
+				const unsigned int numOfLevels = DistanceUtils::MultiSourceLevelCounts(graph,
+						batchSources[t].data(), batchSize, workspaces[t], counts[batch]);
+				if (totals[t].size() < numOfLevels)
+					totals[t].resize(numOfLevels, 0);
+				for (unsigned int level = 0; level < numOfLevels; level++)
+					for (unsigned int i = 0; i < batchSize; i++)
+						totals[t][level] += counts[batch][level * batchSize + i]
+								* (weights ? (*weights)[first + i] : 1);
+			});
+
+	average_per_dist.clear();
+	for (const std::vector<double>& threadTotals : totals) {
+		if (average_per_dist.size() < threadTotals.size())
+			average_per_dist.resize(threadTotals.size(), 0);
+		for (size_t dist = 0; dist < threadTotals.size(); dist++)
+			average_per_dist[dist] += threadTotals[dist];
 	}
-
+	for (double& average : average_per_dist)
+		average /= numOfNodes;
 }
 
-AttractionBasinCalculator::~AttractionBasinCalculator() {
-	// TODO Auto-generated destructor stub
-
-	for (int i = 0; i < this->ab_in_dist->size(); i++)
-		delete ab_in_dist->at(i);
-
-	delete ab_in_dist;
-
-	for (int i = 0; i < this->ab_out_dist->size(); i++)
-		delete ab_out_dist->at(i);
-	delete ab_out_dist;
-
-	delete average_out_per_dist;
-	delete average_in_per_dist;
-
+template<typename GraphT>
+AttractionBasinCalculatorT<GraphT>::~AttractionBasinCalculatorT() {
 }
+
+template class AttractionBasinCalculatorT<CompactCacheGraph> ;
+template class AttractionBasinCalculatorT<CacheGraph> ;
+template class AttractionBasinCalculatorT<LargeCacheGraph> ;
@@ -1,59 +1,214 @@
 #include "../includes/BfsMomentsCalculator.h"
+#include "../includes/ParallelUtils.h"
+#include "../includes/PivotSampling.h"
+#include "../includes/HyperAnf.h"
+#include <cmath>
 
-BfsMomentsCalculator::BfsMomentsCalculator() {
-}
-
-vector<floatTuple> BfsMomentsCalculator::Calculate() {
-
-	const int numOfNodes = mGraph->GetNumberOfNodes();
-	vector<floatTuple> features(numOfNodes);
-
-	for (int i = 0; i < numOfNodes; i++) {
-//		std::cout << "In main loop iter " << i << std::endl;
+template<typename GraphT>
+const unsigned int BfsMomentsCalculatorT<GraphT>::SOURCES_PER_BFS;
 
-		//calculate BFS distances
-		std::vector<unsigned int> distances = DistanceUtils::BfsSingleSourceShortestPath(
-				mGraph, i);
+template<typename GraphT>
+BfsMomentsCalculatorT<GraphT>::BfsMomentsCalculatorT() :
+		numOfPivots(0), log2Registers(0), seed(0), stratified(false), weighted(false) {
+}
 
-//		std::cout<<"After DistanceUtils"<<std::endl;
-//		std::cout<<"Distances: "<<std::endl;
-//		for(int k=0;k<distances.size();k++)
-//			std::cout<<k<<" "<<distances[k]<<std::endl;
+template<typename GraphT>
+void BfsMomentsCalculatorT<GraphT>::SetPivotSampling(
+		unsigned int NumberOfPivots, unsigned int seed, bool stratified) {
+	this->numOfPivots = NumberOfPivots;
+	this->seed = seed;
+	this->stratified = stratified;
+}
 
-//count the number of times each distance exists
-		std::unordered_map<unsigned int, int> distCounter;
+template<typename GraphT>
+void BfsMomentsCalculatorT<GraphT>::SetHyperAnf(unsigned int Log2Registers,
+		unsigned int seed) {
+	this->log2Registers = Log2Registers;
+	this->seed = seed;
+}
 
-		for (int j = 0; j < distances.size(); j++) {
-//			std::cout<<"In internal loop iter "<<j<<" of "<<distances.size()<<std::endl;
-			if (distCounter.find(distances[j]) == distCounter.end())
-				//distance[j] hasn't been counted before
-				distCounter[distances[j]] = 0;
-			distCounter[distances[j]] += 1;
-		}
+template<typename GraphT>
+vector<floatTuple> BfsMomentsCalculatorT<GraphT>::Calculate() {
+	typedef typename GraphT::node_type NodeId;
+	confidenceIntervals.clear();
+	if (weighted)
+		return CalculateWeighted();
+	if (numOfPivots > 0)
+		return CalculateApproximate();
+	if (log2Registers > 0)
+		return CalculateHyperAnf();
+	const int64 numOfNodes = this->mGraph->GetNumberOfNodes();
+	const int64 numOfBatches = (numOfNodes + SOURCES_PER_BFS - 1) / SOURCES_PER_BFS;
+	vector<floatTuple> features(numOfNodes);
 
-		std::vector<float> dists(distCounter.size()), weights(
-				distCounter.size());
+	const unsigned int numOfThreads = ParallelUtils::GetNumberOfThreads();
+	std::vector<MultiSourceBfsWorkspaceT<GraphT> > workspaces(numOfThreads);
+	//the numbers of nodes the sources of the batch of every thread reach at every level
+	std::vector<std::vector<int64> > histograms(numOfThreads);
+	std::vector<std::vector<NodeId> > sources(numOfThreads);
+	ParallelUtils::ParallelFor(0, numOfBatches, 1,
+			[&](unsigned int t, int64 batch) {
+				std::vector<int64>& histogram = histograms[t];
+				std::vector<NodeId>& batchSources = sources[t];
+				batchSources.clear();
+				for (int64 node = batch * SOURCES_PER_BFS;
+						node < std::min<int64>(numOfNodes, (batch + 1) * SOURCES_PER_BFS); node++)
+					batchSources.push_back(static_cast<NodeId>(node));
+				const unsigned int numOfSources = batchSources.size();
+				const unsigned int numOfLevels = DistanceUtils::MultiSourceLevelCounts(*this->mGraph,
+						batchSources.data(), numOfSources, workspaces[t], histogram);
+
+				for (unsigned int i = 0; i < numOfSources; i++) {
+					//Welford's update, with all of the nodes of a level at once
+					double count = 0, mean = 0, squares = 0;
+					for (unsigned int level = 0; level < numOfLevels; level++) {
+						const int64 levelCount = histogram[level * numOfSources + i];
+						if (levelCount == 0)
+							continue;
+						const double distance = level + 1;
+						count += levelCount;
+						const double delta = distance - mean;
+						mean += delta * levelCount / count;
+						squares += delta * levelCount * (distance - mean);
+					}
+					features[batch * SOURCES_PER_BFS + i] = std::make_tuple(
+							static_cast<float>(mean),
+							static_cast<float>(std::sqrt(squares / count)));
+				}
+			});
 
-		for (const auto& n : distCounter) {
-//			std::cout<<n.first <<" "<<n.second<<std::endl;
-			dists.push_back((float) n.first + 1); // the key is the distance, which needs adjustment
-			weights.push_back((float) n.second); //the value is the number of times it has been counted
-		}
+	return features;
+}
 
-//		for (int k = 0; k < dists.size(); k++)
-//			std::cout << dists[k] << " " << weights[k] << std::endl;
+/*
+	Every pivot p that a node u reaches adds 1, d + 1 and (d + 1)^2 (expanded by its weight) to the
+	totals of u, where d is the distance from u to p; u itself and its neighbors (distance 1) are
+	added exactly, as they dominate the moments of the nodes that reach few others. The mean is the
+	ratio of the second total to the first, and the variance the ratio of the third to the first
+	minus the squared mean.
+*/
+template<typename GraphT>
+vector<floatTuple> BfsMomentsCalculatorT<GraphT>::CalculateApproximate() {
+	typedef typename GraphT::node_type NodeId;
+	const GraphT& graph = *this->mGraph;
+	const GraphT& inverseGraph = graph.isDirected() ? graph.inverse() : graph;
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	std::vector<NodeId> pivots;
+	std::vector<double> weights;
+	PivotSampling::SamplePivots(graph, numOfPivots, seed, stratified, pivots, weights);
+	const int64 k = pivots.size();
+
+	std::vector<PivotTotals<3> > totals(numOfNodes);
+	std::vector<BfsWorkspaceT<GraphT> > workspaces(PivotSampling::BatchSize());
+	PivotSampling::RunPivots(k, numOfNodes,
+			[&](unsigned int slot, int64 pivot) {
+				DistanceUtils::Bfs(inverseGraph, pivots[pivot], workspaces[slot]);
+			},
+			[&](int64 node, unsigned int slot, int64 pivot) {
+				const unsigned int dist = workspaces[slot].GetDistances()[node];
+				if (dist == BfsWorkspaceT<GraphT>::UNREACHABLE || dist <= 1)
+					return;
+				const double expansion = k * weights[pivot], value = dist + 1;
+				const double contribution[3] = { expansion, expansion * value,
+						expansion * value * value };
+				totals[node].Add(contribution);
+			});
 
+	vector<floatTuple> features(numOfNodes);
+	confidenceIntervals.assign(numOfNodes, floatTuple(0, 0));
+	ParallelUtils::ParallelFor(0, numOfNodes, PivotSampling::ACCUMULATE_GRAIN,
+			[&](unsigned int, int64 node) {
+				const PivotTotals<3>& total = totals[node];
+				int64 neighbors = 0;
+				for (NodeId neighbor : graph.neighbors(static_cast<NodeId>(node)))
+					neighbors += neighbor != node;
+				const double reached = 1 + neighbors + total.Total(0, k);
+				const double mean = (1 + 2 * neighbors + total.Total(1, k)) / reached;
+				const double squares = (1 + 4 * neighbors + total.Total(2, k)) / reached;
+				const double std = std::sqrt(std::max(squares - mean * mean, 0.0));
+				const double meanGradient[3] = { -mean / reached, 1 / reached, 0 };
+				double stdGradient[3] = { 0, 0, 0 };
+				if (std > 0) {
+					stdGradient[0] = (2 * mean * mean - squares) / (2 * std * reached);
+					stdGradient[1] = -mean / (std * reached);
+					stdGradient[2] = 1 / (2 * std * reached);
+				}
+				features[node] = std::make_tuple(static_cast<float>(mean),
+						static_cast<float>(std));
+				confidenceIntervals[node] = std::make_tuple(
+						static_cast<float>(total.HalfWidth(meanGradient, k, numOfNodes)),
+						static_cast<float>(total.HalfWidth(stdGradient, k, numOfNodes)));
+			});
+	return features;
+}
 
-		std::cout<<MathUtils::calculateMeanWithoutZeroes(weights)<<std::endl;
-		features[i] = std::make_tuple(
-				MathUtils::calculateWeightedAverage(dists,weights),
-				MathUtils::calculateWeightedStd(dists,weights));
+/*
+	The estimated number of nodes at distance d from a node is the growth of its estimated ball
+	from distance d - 1 (the node itself is counted exactly), and the moments are kept as sums
+	over the distances.
+*/
+template<typename GraphT>
+vector<floatTuple> BfsMomentsCalculatorT<GraphT>::CalculateHyperAnf() {
+	const int64 numOfNodes = this->mGraph->GetNumberOfNodes();
+	std::vector<double> previous(numOfNodes), count(numOfNodes, 1), sum(numOfNodes, 1),
+			squares(numOfNodes, 1);
+	HyperAnf::BallSizes(*this->mGraph, log2Registers, seed,
+			[&](unsigned int distance, const std::vector<double>& balls) {
+				if (distance == 0) {
+					previous = balls;
+					return;
+				}
+				const double value = distance + 1;
+				ParallelUtils::ParallelFor(0, numOfNodes, HyperAnf::MERGE_GRAIN,
+						[&](unsigned int, int64 node) {
+							if (balls[node] <= previous[node])
+								return;
+							const double levelCount = balls[node] - previous[node];
+							previous[node] = balls[node];
+							count[node] += levelCount;
+							sum[node] += levelCount * value;
+							squares[node] += levelCount * value * value;
+						});
+			});
 
-//		cout<<std::get<0>(features[i]) << " "<<std::get<1>(features[i])<<std::endl;
+	vector<floatTuple> features(numOfNodes);
+	for (int64 node = 0; node < numOfNodes; node++) {
+		const double mean = sum[node] / count[node];
+		features[node] = std::make_tuple(static_cast<float>(mean), static_cast<float>(
+				std::sqrt(std::max(squares[node] / count[node] - mean * mean, 0.0))));
 	}
+	return features;
+}
 
+template<typename GraphT>
+vector<floatTuple> BfsMomentsCalculatorT<GraphT>::CalculateWeighted() {
+	typedef typename GraphT::node_type NodeId;
+	const int64 numOfNodes = this->mGraph->GetNumberOfNodes();
+	vector<floatTuple> features(numOfNodes);
+	std::vector<DijkstraWorkspaceT<GraphT> > workspaces(ParallelUtils::GetNumberOfThreads());
+	ParallelUtils::ParallelFor(0, numOfNodes, 16,
+			[&](unsigned int t, int64 node) {
+				DijkstraWorkspaceT<GraphT>& workspace = workspaces[t];
+				DistanceUtils::Dijkstra(*this->mGraph, static_cast<NodeId>(node), workspace);
+				const NodeId* reached = workspace.GetReached();
+				double count = 0, mean = 0, squares = 0;
+				for (int64 i = 0; i < workspace.GetNumberOfReached(); i++) {
+					const double distance = workspace.GetDistances()[reached[i]] + 1;
+					count++;
+					const double delta = distance - mean;
+					mean += delta / count;
+					squares += delta * (distance - mean);
+				}
+				features[node] = std::make_tuple(static_cast<float>(mean),
+						static_cast<float>(std::sqrt(squares / count)));
+			});
 	return features;
 }
 
-BfsMomentsCalculator::~BfsMomentsCalculator() {
+template<typename GraphT>
+BfsMomentsCalculatorT<GraphT>::~BfsMomentsCalculatorT() {
 }
+
+template class BfsMomentsCalculatorT<CompactCacheGraph> ;
+template class BfsMomentsCalculatorT<CacheGraph> ;
+template class BfsMomentsCalculatorT<LargeCacheGraph> ;
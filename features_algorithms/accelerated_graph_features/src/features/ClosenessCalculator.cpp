@@ -0,0 +1,57 @@
+/*
+ * ClosenessCalculator.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "../includes/ClosenessCalculator.h"
+#include "../includes/ParallelUtils.h"
+
+template<typename GraphT>
+ClosenessCalculatorT<GraphT>::ClosenessCalculatorT(bool weighted) :
+		weighted(weighted) {
+}
+
+template<typename GraphT>
+std::vector<double>* ClosenessCalculatorT<GraphT>::Calculate() {
+	typedef typename GraphT::node_type NodeId;
+	const GraphT& graph = *this->mGraph;
+	const GraphT& inverseGraph = graph.isDirected() ? graph.inverse() : graph;
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	std::vector<double>* features = new std::vector<double>(numOfNodes, 0);
+
+	const unsigned int numOfThreads = ParallelUtils::GetNumberOfThreads();
+	std::vector<BfsWorkspaceT<GraphT> > bfsWorkspaces(weighted ? 0 : numOfThreads);
+	std::vector<DijkstraWorkspaceT<GraphT> > dijkstraWorkspaces(weighted ? numOfThreads : 0);
+	ParallelUtils::ParallelFor(0, numOfNodes, 16,
+			[&](unsigned int t, int64 node) {
+				const NodeId src = static_cast<NodeId>(node);
+				double sum = 0;
+				int64 reached;
+				if (weighted) {
+					DijkstraWorkspaceT<GraphT>& workspace = dijkstraWorkspaces[t];
+					DistanceUtils::Dijkstra(inverseGraph, src, workspace);
+					reached = workspace.GetNumberOfReached();
+					for (int64 i = 0; i < reached; i++)
+						sum += workspace.GetDistances()[workspace.GetReached()[i]];
+				} else {
+					BfsWorkspaceT<GraphT>& workspace = bfsWorkspaces[t];
+					DistanceUtils::Bfs(inverseGraph, src, workspace);
+					reached = workspace.GetNumberOfReached();
+					const std::vector<int64>& levels = workspace.GetLevels();
+					for (size_t dist = 1; dist + 1 < levels.size(); dist++)
+						sum += static_cast<double>(dist) * (levels[dist + 1] - levels[dist]);
+				}
+				if (sum > 0 && numOfNodes > 1)
+					(*features)[node] = (reached - 1) / sum * (reached - 1) / (numOfNodes - 1);
+			});
+	return features;
+}
+
+template<typename GraphT>
+ClosenessCalculatorT<GraphT>::~ClosenessCalculatorT() {
+}
+
+template class ClosenessCalculatorT<CompactCacheGraph> ;
+template class ClosenessCalculatorT<CacheGraph> ;
+template class ClosenessCalculatorT<LargeCacheGraph> ;
@@ -1,74 +1,61 @@
 #include "../includes/ClusteringCoefficientCalculator.h"
 
 
-ClusteringCoefficientCalculator::ClusteringCoefficientCalculator()
+template<typename GraphT>
+ClusteringCoefficientCalculatorT<GraphT>::ClusteringCoefficientCalculatorT() :
+		transitivity(0)
 {
 }
 
 /*
-	Calculate the average CC of the network
+	Calculate the local CC of every node, the transitivity and the average CC of the network.
+	A node with d neighbors (in the undirected graph, without self loops) and t triangles has a
+	local CC of 2t / (d(d-1)), and the transitivity is the total of the triangles over the total of
+	the d(d-1)/2 pairs of neighbors.
+	The local CC of a directed or weighted network are computed by CacheGraphT::ComputeClustering.
 */
-float ClusteringCoefficientCalculator::Calculate()
+template<typename GraphT>
+float ClusteringCoefficientCalculatorT<GraphT>::Calculate()
 {
-	//The clustering average
-	float clusteringCoef = 0;
-
-	//Get the neighbors and offsets
-	const unsigned int* neighborList = mGraph->GetNeighborList();
-	const int64* offsetList = mGraph->GetOffsetList();
-	
-	//sum all of the local clustering coefficients
-	unsigned int numOfNodes = mGraph->GetNumberOfNodes();
-	int64 begin_offset, end_offset;
-	for (unsigned int i = 0; i < numOfNodes; i++) {
-		begin_offset = offsetList[i];
-		end_offset = offsetList[i + 1];
-		clusteringCoef += LocalClusteringCoefficient(i,begin_offset,end_offset,neighborList);
+	typedef typename GraphT::node_type NodeId;
+	this->mGraph->CountTriangles(triangles, NULL);
+	const GraphT& graph =
+			this->mGraph->isDirected() ?
+					this->mGraph->undirected() : *this->mGraph;
+	const bool simple = !this->mGraph->isDirected() && !this->mGraph->isWeighted();
+	variants.clear();
+	if (!simple) {
+		this->mGraph->ComputeClustering(variants);
+		localClustering = variants[CLUSTERING_TOTAL];
 	}
-	//return the average
-	return clusteringCoef/numOfNodes;
-}
-
-/*
-	A function to calculate the local CC of the node i.
-	Input: the node index
-	Output: the local CC of the node.
-	Parameters:
-		i - the index of the node for which we calculate the local CC
-		begin_offset,end_offset - the beginning and ending indices of the section in the neighborhood list of i's neighbors
-		neighborList - the list of neighbors for each node. Sorted by nodes and with the neighbors themselves sorted.
-
-*/
-float ClusteringCoefficientCalculator::LocalClusteringCoefficient(unsigned int i,unsigned int begin_offset, unsigned int end_offset, const unsigned int* neighborList) {
 
-	//The Clustering Coefficient
-	float cc = 0;
-
-	//The nighborhood of i is now neighborList[begin:end]
-	//Moreover, the size of that neighborhood is given by the following:
-	unsigned int neighborhoodSize = static_cast<unsigned int>(end_offset - begin_offset);
-	
-	//This is the critical part of the formula. We need to count the number of neigbors that are also connected to each other.
-	unsigned int connectedNeighbors = 0;
-
-	for (auto p = neighborList + begin_offset; p < neighborList + end_offset; ++p)
-	{
-		//p is a pointer to the nodes in the adjacency list.
-		//Example usage: the offset of the current node is offsetList[*p]
-		for (auto q = neighborList + begin_offset; q < p; ++q) {
-			//We need to go over all the pairs, but we don't want to count every edge twice, so we only iterate over q<p.
-			if (mGraph->areNeighbors(*p, *q))
-				connectedNeighbors++;
+	const int64 numOfNodes = this->mGraph->GetNumberOfNodes();
+	if (simple)
+		localClustering.assign(numOfNodes, 0.0f);
+	double clusteringSum = 0, trianglesSum = 0, pairsSum = 0;
+	for (int64 i = 0; i < numOfNodes; i++) {
+		int64 degree = 0;
+		for (NodeId peer : graph.neighbors(static_cast<NodeId>(i)))
+			degree += (peer != i);
+		if (degree >= 2) {
+			const double pairs = 0.5 * degree * (degree - 1);
+			if (simple)
+				localClustering[i] = static_cast<float>(triangles[i] / pairs);
+			trianglesSum += triangles[i];
+			pairsSum += pairs;
 		}
+		clusteringSum += localClustering[i];
 	}
-
-	//calculate the coefficient
-	cc = (float) 2 * connectedNeighbors / (neighborhoodSize*(neighborhoodSize - 1));
-
-	return cc;
+	transitivity = pairsSum > 0 ? static_cast<float>(trianglesSum / pairsSum) : 0.0f;
+	//return the average
+	return numOfNodes > 0 ? static_cast<float>(clusteringSum / numOfNodes) : 0.0f;
 }
 
-
-ClusteringCoefficientCalculator::~ClusteringCoefficientCalculator()
+template<typename GraphT>
+ClusteringCoefficientCalculatorT<GraphT>::~ClusteringCoefficientCalculatorT()
 {
 }
+
+template class ClusteringCoefficientCalculatorT<CompactCacheGraph> ;
+template class ClusteringCoefficientCalculatorT<CacheGraph> ;
+template class ClusteringCoefficientCalculatorT<LargeCacheGraph> ;
@@ -6,116 +6,165 @@
  */
 
 #include "../includes/FlowCalculator.h"
+#include "../includes/ParallelUtils.h"
+#include "../includes/PivotSampling.h"
 
-FlowCalculator::FlowCalculator(double threshold) :
-		numOfNodes(0), threshold(threshold), features(NULL) {
+template<typename GraphT>
+FlowCalculatorT<GraphT>::FlowCalculatorT(double threshold) :
+		threshold(threshold), numOfPivots(0), seed(0), stratified(false) {
 
 }
-void FlowCalculator::init() {
-	numOfNodes = mGraph->GetNumberOfNodes();
 
-	mGraph->InverseGraph(inverse);
-	mGraph->CureateUndirectedGraph(inverse, undirectedGraph);
-
-	directed_dists.reserve(numOfNodes);
-
-	undirected_dists.reserve(numOfNodes);
-
-	b_u.reserve(numOfNodes);
-	features = new std::vector<double>();
-	features->reserve(numOfNodes);
-}
-
-void FlowCalculator::CalcDists() {
-	for (unsigned int node = 0; node < numOfNodes; node++) {
-		auto directedBfsDist = DistanceUtils::BfsSingleSourceShortestPath(
-				mGraph, node);
-		directed_dists.push_back(
-				new std::vector<unsigned int>(directedBfsDist.begin(),
-						directedBfsDist.end()));
-
-		auto undirectedBfsDist = DistanceUtils::BfsSingleSourceShortestPath(
-				&undirectedGraph, node);
-		undirected_dists.push_back(
-				new std::vector<unsigned int>(undirectedBfsDist.begin(),
-						undirectedBfsDist.end()));
-
-	}
+template<typename GraphT>
+void FlowCalculatorT<GraphT>::SetPivotSampling(unsigned int NumberOfPivots,
+		unsigned int seed, bool stratified) {
+	this->numOfPivots = NumberOfPivots;
+	this->seed = seed;
+	this->stratified = stratified;
 }
 
-void FlowCalculator::CountReachables() {
-
-	for (unsigned int src = 0; src < numOfNodes; src++) {
-		b_u[src] = 0;
-		for (unsigned int dest = 0; dest < numOfNodes; dest++) {
-			if (directed_dists[src]->at(dest) > 0)
-				b_u[src]++;
-			else if (directed_dists[dest]->at(src) > 0) {
-				b_u[src]++;
-			}
-		}
-	}
-
-}
-
-void FlowCalculator::printVars() {
-	std::cout << "directed dists" << std::endl;
-	for (auto node_vec : directed_dists) {
-		for (auto d : *node_vec)
-			std::cout << d << "\t";
-		std::cout << std::endl;
-	}
-
-	std::cout << "undirected dists" << std::endl;
-	for (auto node_vec : undirected_dists) {
-		for (auto d : *node_vec)
-			std::cout << d << "\t";
-		std::cout << std::endl;
-	}
-
-	std::cout << "b_u" << std::endl;
-	for (int i = 0; i < numOfNodes; i++)
-		std::cout << i << " : " << b_u[i] << std::endl;
-}
-
-std::vector<double>* FlowCalculator::Calculate() {
-	CalcDists();
-	CountReachables();
-
-//	printVars();
-
-	double max_b_u = (double) (*std::max_element(b_u.begin(), b_u.end()));
-
-	for (unsigned int node = 0; node < numOfNodes; node++) {
-		features->push_back(0);
+template<typename GraphT>
+std::vector<double>* FlowCalculatorT<GraphT>::Calculate() {
+	typedef typename GraphT::node_type NodeId;
+	const GraphT& graph = *this->mGraph;
+	confidenceIntervals.clear();
+	if (numOfPivots > 0)
+		return CalculateApproximate();
+	const GraphT& undirectedGraph = graph.isDirected() ? graph.undirected() : graph;
+	const GraphT& inverseGraph = graph.isDirected() ? graph.inverse() : graph;
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	b_u.assign(numOfNodes, 0);
+	ratios.assign(numOfNodes, 0);
+
+	struct Workspaces {
+		BfsWorkspaceT<GraphT> undirected, directed, inverse;
+		// the nodes the source reaches
+		std::vector<int64> reached;
+	};
+	std::vector<Workspaces> workspaces(ParallelUtils::GetNumberOfThreads());
+	ParallelUtils::ParallelFor(0, numOfNodes, 16,
+			[&](unsigned int t, int64 node) {
+				const NodeId src = static_cast<NodeId>(node);
+				Workspaces& ws = workspaces[t];
+				if (ws.reached.empty())
+					ws.reached.assign((numOfNodes + 63) / 64, 0);
+				DistanceUtils::Bfs(undirectedGraph, src, ws.undirected);
+				DistanceUtils::Bfs(graph, src, ws.directed);
+				DistanceUtils::Bfs(inverseGraph, src, ws.inverse);
+				const std::vector<unsigned int>& udists = ws.undirected.GetDistances();
+
+				//level 0 is the source itself
+				const std::vector<int64>& levels = ws.directed.GetLevels();
+				const NodeId* descendants = ws.directed.GetReached();
+				double sum = 0;
+				for (size_t dist = 1; dist + 1 < levels.size(); dist++)
+					for (int64 i = levels[dist]; i < levels[dist + 1]; i++) {
+						const NodeId v = descendants[i];
+						sum += (double) udists[v] / dist;
+						ws.reached[v >> 6] |= 1ULL << (v & 63);
+					}
+				int64 count = ws.directed.GetNumberOfReached() - 1;
+				const NodeId* ancestors = ws.inverse.GetReached();
+				for (int64 i = 1; i < ws.inverse.GetNumberOfReached(); i++)
+					count += !(ws.reached[ancestors[i] >> 6] & (1ULL << (ancestors[i] & 63)));
+				for (int64 i = 1; i < ws.directed.GetNumberOfReached(); i++)
+					ws.reached[descendants[i] >> 6] = 0;
+				b_u[node] = count;
+				ratios[node] = sum;
+			});
+
+	const double max_b_u = numOfNodes > 0 ? (double) *std::max_element(b_u.begin(), b_u.end()) : 0;
+	std::vector<double>* features = new std::vector<double>(numOfNodes, 0);
+	for (int64 node = 0; node < numOfNodes; node++) {
 		// Check threshold
-		if ((b_u[node] / max_b_u) <= threshold) {
+		if ((b_u[node] / max_b_u) <= threshold || b_u[node] == 0)
 			continue;
-		}
-		auto udists = undirected_dists[node];
-		auto dists = directed_dists[node];
-
-		double sum = 0;
-
-		for (unsigned int n = 0; n < numOfNodes; n++) {
-			if (dists->at(n) == 0) {
-				continue;
-			}
-
-			sum += (double) udists->at(n) / dists->at(n);
-			(*features)[node] = sum / (double) b_u[node];
-		}
-
+		(*features)[node] = ratios[node] / (double) b_u[node];
 	}
 	return features;
 
 }
 
-FlowCalculator::~FlowCalculator() {
-	for (auto p : directed_dists)
-		delete p;
+/*
+ Every pivot p that u reaches adds udist(u, p) / dist(u, p) to the ratios of u, and every pivot
+ that u reaches or that reaches u adds 1 to b_u (expanded by its weight). The out neighbors of u,
+ with a ratio of 1, are added exactly instead, and the threshold is applied to the estimated b_u.
+ */
+template<typename GraphT>
+std::vector<double>* FlowCalculatorT<GraphT>::CalculateApproximate() {
+	typedef typename GraphT::node_type NodeId;
+	const GraphT& graph = *this->mGraph;
+	const GraphT& undirectedGraph = graph.isDirected() ? graph.undirected() : graph;
+	const GraphT& inverseGraph = graph.isDirected() ? graph.inverse() : graph;
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	std::vector<NodeId> pivots;
+	std::vector<double> weights;
+	PivotSampling::SamplePivots(graph, numOfPivots, seed, stratified, pivots, weights);
+	const int64 k = pivots.size();
+
+	std::vector<PivotTotals<2> > totals(numOfNodes);
+	struct Workspaces {
+		BfsWorkspaceT<GraphT> undirected, directed, inverse;
+	};
+	std::vector<Workspaces> workspaces(PivotSampling::BatchSize());
+	PivotSampling::RunPivots(k, numOfNodes,
+			[&](unsigned int slot, int64 pivot) {
+				Workspaces& ws = workspaces[slot];
+				DistanceUtils::Bfs(inverseGraph, pivots[pivot], ws.inverse);
+				if (graph.isDirected()) {
+					DistanceUtils::Bfs(undirectedGraph, pivots[pivot], ws.undirected);
+					DistanceUtils::Bfs(graph, pivots[pivot], ws.directed);
+				}
+			},
+			[&](int64 node, unsigned int slot, int64 pivot) {
+				const Workspaces& ws = workspaces[slot];
+				const unsigned int toPivot = ws.inverse.GetDistances()[node];
+				const unsigned int fromPivot = (graph.isDirected() ? ws.directed :
+						ws.inverse).GetDistances()[node];
+				if (toPivot <= 1 || (toPivot == BfsWorkspaceT<GraphT>::UNREACHABLE
+						&& fromPivot == BfsWorkspaceT<GraphT>::UNREACHABLE))
+					return;
+				const double expansion = k * weights[pivot];
+				double contribution[2] = { 0, expansion };
+				if (toPivot != BfsWorkspaceT<GraphT>::UNREACHABLE)
+					contribution[0] = expansion * (graph.isDirected() ?
+							ws.undirected : ws.inverse).GetDistances()[node] / toPivot;
+				totals[node].Add(contribution);
+			});
+
+	std::vector<int64> out_neighbors(numOfNodes, 0);
+	for (int64 node = 0; node < numOfNodes; node++)
+		for (NodeId neighbor : graph.neighbors(static_cast<NodeId>(node)))
+			out_neighbors[node] += neighbor != node;
+	std::vector<double> estimated_b_u(numOfNodes);
+	double max_b_u = 0;
+	for (int64 node = 0; node < numOfNodes; node++) {
+		estimated_b_u[node] = out_neighbors[node] + totals[node].Total(1, k);
+		max_b_u = std::max(max_b_u, estimated_b_u[node]);
+	}
+	b_u.assign(numOfNodes, 0);
+	ratios.assign(numOfNodes, 0);
+	std::vector<double>* features = new std::vector<double>(numOfNodes, 0);
+	confidenceIntervals.assign(numOfNodes, 0);
+	ParallelUtils::ParallelFor(0, numOfNodes, PivotSampling::ACCUMULATE_GRAIN,
+			[&](unsigned int, int64 node) {
+				b_u[node] = static_cast<int64>(estimated_b_u[node] + 0.5);
+				ratios[node] = out_neighbors[node] + totals[node].Total(0, k);
+				if ((estimated_b_u[node] / max_b_u) <= threshold || estimated_b_u[node] == 0)
+					return;
+				const double feature = ratios[node] / estimated_b_u[node];
+				const double gradient[2] = { 1 / estimated_b_u[node],
+						-feature / estimated_b_u[node] };
+				(*features)[node] = feature;
+				confidenceIntervals[node] = totals[node].HalfWidth(gradient, k, numOfNodes);
+			});
+	return features;
+}
 
-	for (auto p : undirected_dists)
-		delete p;
+template<typename GraphT>
+FlowCalculatorT<GraphT>::~FlowCalculatorT() {
 }
 
+template class FlowCalculatorT<CompactCacheGraph> ;
+template class FlowCalculatorT<CacheGraph> ;
+template class FlowCalculatorT<LargeCacheGraph> ;
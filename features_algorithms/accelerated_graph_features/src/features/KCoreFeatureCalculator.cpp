@@ -6,18 +6,30 @@
  */
 
 #include "../includes/KCoreFeatureCalculator.h"
+#include "../includes/ParallelUtils.h"
 
-KCoreFeatureCalculator::KCoreFeatureCalculator() {
+template<typename GraphT>
+const int64 KCoreFeatureCalculatorT<GraphT>::PARALLEL_EDGES;
 
+template<typename GraphT>
+KCoreFeatureCalculatorT<GraphT>::KCoreFeatureCalculatorT() {
 
-}
 
-std::vector<unsigned short> KCoreFeatureCalculator::Calculate() {
+}
 
-	return mGraph->ComputeKCore();
+template<typename GraphT>
+std::vector<typename GraphT::node_type> KCoreFeatureCalculatorT<GraphT>::Calculate() {
+	const int64 edges = this->mGraph->GetNumberOfEdges();
+	if (edges >= PARALLEL_EDGES && ParallelUtils::ThreadsForWork(edges) > 1)
+		return this->mGraph->ComputeKCoreParallel();
+	return this->mGraph->ComputeKCore();
 
 }
 
-KCoreFeatureCalculator::~KCoreFeatureCalculator() {
+template<typename GraphT>
+KCoreFeatureCalculatorT<GraphT>::~KCoreFeatureCalculatorT() {
 }
 
+template class KCoreFeatureCalculatorT<CompactCacheGraph> ;
+template class KCoreFeatureCalculatorT<CacheGraph> ;
+template class KCoreFeatureCalculatorT<LargeCacheGraph> ;
@@ -0,0 +1,173 @@
+/*
+ * KCoreMaintenance.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "../includes/KCoreMaintenance.h"
+#include "../includes/KCoreFeatureCalculator.h"
+#include <algorithm>
+
+template<typename GraphT>
+KCoreMaintenanceT<GraphT>::KCoreMaintenanceT(const GraphT& graph) :
+		m_Directed(graph.isDirected()), m_Epoch(0), m_TouchedNodes(0) {
+	const int64 NumberOfNodes = graph.GetNumberOfNodes();
+	m_Neighbors.resize(NumberOfNodes);
+	if (m_Directed)
+		m_OutNeighbors.resize(NumberOfNodes);
+	for (int64 node = 0; node < NumberOfNodes; ++node) {
+		for (NodeId peer : graph.neighbors(static_cast<NodeId>(node))) {
+			if (peer == node)
+				continue;
+			m_Neighbors[node].push_back(peer);
+			if (m_Directed) {
+				m_Neighbors[peer].push_back(static_cast<NodeId>(node));
+				m_OutNeighbors[node].push_back(peer);
+			}
+		}
+	}
+
+	KCoreFeatureCalculatorT<GraphT> calc;
+	calc.setGraph(&graph);
+	m_Cores = calc.Calculate();
+	m_Visited.assign(NumberOfNodes, 0);
+	m_CandidateDegrees.assign(NumberOfNodes, 0);
+}
+
+template<typename GraphT>
+int64 KCoreMaintenanceT<GraphT>::InsertEdges(const std::vector<Edge>& edges) {
+	m_TouchedNodes = 0;
+	int64 inserted = 0;
+	for (const Edge& edge : edges)
+		inserted += InsertEdge(edge.first, edge.second);
+	return inserted;
+}
+
+template<typename GraphT>
+int64 KCoreMaintenanceT<GraphT>::RemoveEdges(const std::vector<Edge>& edges) {
+	m_TouchedNodes = 0;
+	int64 removed = 0;
+	for (const Edge& edge : edges)
+		removed += RemoveEdge(edge.first, edge.second);
+	return removed;
+}
+
+template<typename GraphT>
+bool KCoreMaintenanceT<GraphT>::HasEdge(NodeId p, NodeId q) const {
+	const std::vector<NodeId>& list =
+			m_Directed ? m_OutNeighbors[p] : m_Neighbors[p];
+	return std::find(list.begin(), list.end(), q) != list.end();
+}
+
+template<typename GraphT>
+void KCoreMaintenanceT<GraphT>::RemoveOne(std::vector<NodeId>& list,
+		NodeId node) {
+	typename std::vector<NodeId>::iterator it = std::find(list.begin(),
+			list.end(), node);
+	*it = list.back();
+	list.pop_back();
+}
+
+/*
+ Collect the nodes of core number K that are connected to the ends of the edge of core number K
+ through nodes of core number K, and count the neighbors of each of them whose core number is at
+ least K.
+ */
+template<typename GraphT>
+void KCoreMaintenanceT<GraphT>::CollectSubcore(NodeId p, NodeId q, NodeId K) {
+	if (++m_Epoch == 0) {
+		std::fill(m_Visited.begin(), m_Visited.end(), 0);
+		m_Epoch = 1;
+	}
+	m_Subcore.clear();
+	const NodeId roots[2] = { p, q };
+	for (NodeId root : roots)
+		if (m_Cores[root] == K && m_Visited[root] != m_Epoch) {
+			m_Visited[root] = m_Epoch;
+			m_Subcore.push_back(root);
+		}
+	for (size_t i = 0; i < m_Subcore.size(); ++i) {
+		const NodeId node = m_Subcore[i];
+		NodeId degree = 0;
+		for (NodeId peer : m_Neighbors[node]) {
+			if (m_Cores[peer] < K)
+				continue;
+			++degree;
+			if (m_Cores[peer] == K && m_Visited[peer] != m_Epoch) {
+				m_Visited[peer] = m_Epoch;
+				m_Subcore.push_back(peer);
+			}
+		}
+		m_CandidateDegrees[node] = degree;
+	}
+	m_TouchedNodes += m_Subcore.size();
+}
+
+/*
+ After inserting the edge, a node of the subcore gains a core number of K + 1 unless it is peeled:
+ a node with at most K candidate neighbors is peeled, and so are the nodes it leaves with at most K.
+ */
+template<typename GraphT>
+bool KCoreMaintenanceT<GraphT>::InsertEdge(NodeId p, NodeId q) {
+	if (p == q || HasEdge(p, q))
+		return false;
+	m_Neighbors[p].push_back(q);
+	m_Neighbors[q].push_back(p);
+	if (m_Directed)
+		m_OutNeighbors[p].push_back(q);
+
+	const NodeId K = std::min(m_Cores[p], m_Cores[q]);
+	CollectSubcore(p, q, K);
+	//the peeled nodes are moved out of the subcore's epoch
+	std::vector<NodeId> peeled;
+	for (NodeId node : m_Subcore)
+		if (m_CandidateDegrees[node] <= K) {
+			m_Visited[node] = m_Epoch - 1;
+			peeled.push_back(node);
+		}
+	for (size_t i = 0; i < peeled.size(); ++i)
+		for (NodeId peer : m_Neighbors[peeled[i]])
+			if (m_Visited[peer] == m_Epoch && --m_CandidateDegrees[peer] <= K) {
+				m_Visited[peer] = m_Epoch - 1;
+				peeled.push_back(peer);
+			}
+	for (NodeId node : m_Subcore)
+		if (m_Visited[node] == m_Epoch)
+			m_Cores[node] = K + 1;
+	return true;
+}
+
+/*
+ After removing the edge, a node of the subcore with less than K candidate neighbors drops to a
+ core number of K - 1, and so do the nodes it leaves with less than K.
+ */
+template<typename GraphT>
+bool KCoreMaintenanceT<GraphT>::RemoveEdge(NodeId p, NodeId q) {
+	if (p == q || !HasEdge(p, q))
+		return false;
+	RemoveOne(m_Neighbors[p], q);
+	RemoveOne(m_Neighbors[q], p);
+	if (m_Directed)
+		RemoveOne(m_OutNeighbors[p], q);
+
+	const NodeId K = std::min(m_Cores[p], m_Cores[q]);
+	CollectSubcore(p, q, K);
+	std::vector<NodeId> dropped;
+	for (NodeId node : m_Subcore)
+		if (m_CandidateDegrees[node] < K) {
+			m_Cores[node] = K - 1;
+			dropped.push_back(node);
+		}
+	for (size_t i = 0; i < dropped.size(); ++i)
+		for (NodeId peer : m_Neighbors[dropped[i]])
+			if (m_Visited[peer] == m_Epoch && m_Cores[peer] == K
+					&& --m_CandidateDegrees[peer] < K) {
+				m_Cores[peer] = K - 1;
+				dropped.push_back(peer);
+			}
+	return true;
+}
+
+template class KCoreMaintenanceT<CompactCacheGraph> ;
+template class KCoreMaintenanceT<CacheGraph> ;
+template class KCoreMaintenanceT<LargeCacheGraph> ;
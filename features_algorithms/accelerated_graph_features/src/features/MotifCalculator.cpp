@@ -9,9 +9,12 @@
 #include "../includes/MotifVariationConstants.h"
 #include <algorithm>
 void MotifCalculator::init() {
-	CacheGraph inverse(true);
-	mGraph->InverseGraph(inverse);
-	mGraph->CureateUndirectedGraph(inverse, fullGraph);
+	fullGraph = &mGraph->undirected();
+	visits.assign(mGraph->GetNumberOfNodes(), Visit { 0, 0 });
+	visitEpoch = 0;
+	//the edge checks between the nodes of every group go through areNeighbors
+	if (useNeighborIndex)
+		mGraph->BuildNeighborIndex();
 
 	//std::cout << "Load variations" << std::endl;
 	this->LoadMotifVariations(level, directed);
@@ -29,8 +32,8 @@ void MotifCalculator::init() {
 }
 
 MotifCalculator::MotifCalculator(int level, bool directed, string motif_path) :
-		directed(directed), nodeVariations(NULL), allMotifs(NULL), removalIndex(
-		NULL), sortedNodesByDegree(NULL), fullGraph(false) {
+		directed(directed), useNeighborIndex(true), nodeVariations(NULL), allMotifs(
+		NULL), removalIndex(NULL), sortedNodesByDegree(NULL), fullGraph(NULL), visitEpoch(0) {
 	MOTIF_VARIATIONS_PATH = motif_path;
 	//check level
 	if (level != 3 && level != 4)
@@ -108,7 +111,7 @@ void MotifCalculator::SetAllMotifs() {
 }
 
 void MotifCalculator::SetSortedNodes() {
-	this->sortedNodesByDegree = mGraph->SortedNodesByDegree();
+	this->sortedNodesByDegree = &mGraph->degreeOrder();
 }
 /**
  * We iterate over the list of sorted nodes.
@@ -151,18 +154,18 @@ void MotifCalculator::Motif3Subtree(unsigned int root) {
 	// Instead of yield call GroupUpdater function
 	// Don't forget to check each time that the nodes are in the graph (check removal index).
 	int idx_root = this->removalIndex->at(root);// root_idx is also our current iteration -
-	std::map<unsigned int, int> visited_vertices;// every node_idx smaller than root_idx is already handled
-	visited_vertices[root] = 0;
+	StartVisits();// every node_idx smaller than root_idx is already handled
+	MarkVisited(root, 0);
 	int visit_idx = 1;
 
-	const unsigned int* neighbors = fullGraph.GetNeighborList();// all neighbors - ancestors and descendants
-	const int64* offsets = fullGraph.GetOffsetList();
+	const unsigned int* neighbors = fullGraph->GetNeighborList();// all neighbors - ancestors and descendants
+	const int64* offsets = fullGraph->GetOffsetList();
 
 	// TODO problem with dual edges
 	//std::cout << "Mark" << std::endl;
 	for (int64 i = offsets[root]; i < offsets[root + 1]; i++) // loop first neighbors
 		if (this->removalIndex->at(neighbors[i]) > idx_root) // n1 not handled yet
-			visited_vertices[neighbors[i]] = visit_idx++;
+			MarkVisited(neighbors[i], visit_idx++);
 	//std::cout << "Mark" << std::endl;
 	for (int64 n1_idx = offsets[root]; n1_idx < offsets[root + 1]; n1_idx++) { // loop first neighbors
 		unsigned int n1 = neighbors[n1_idx];
@@ -172,12 +175,12 @@ void MotifCalculator::Motif3Subtree(unsigned int root) {
 			unsigned int n2 = neighbors[n2_idx];
 			if (this->removalIndex->at(n2) <= idx_root)	// n2 already handled
 				continue;
-			if (visited_vertices.find(n2) != visited_vertices.end()) { // check if n2 was visited &&
-				if (visited_vertices[n1] < visited_vertices[n2]) // n2 discovered after n1  TODO VERIFY
+			if (Visited(n2)) { // check if n2 was visited &&
+				if (VisitIndex(n1) < VisitIndex(n2)) // n2 discovered after n1  TODO VERIFY
 					this->GroupUpdater(
 							std::vector<unsigned int> { root, n1, n2 }); // update motif counter [r,n1,n2]
 			} else {
-				visited_vertices[n2] = visit_idx++;
+				MarkVisited(n2, visit_idx++);
 
 				this->GroupUpdater(std::vector<unsigned int> { root, n1, n2 }); // update motif counter [r,n1,n2]
 			}	// end ELSE
@@ -195,10 +198,10 @@ void MotifCalculator::Motif3Subtree(unsigned int root) {
 				|| this->removalIndex->at(n2) <= idx_root)// motif already handled
 			continue;
 		//std::cout << "Mark1" << std::endl;
-		//std::cout << (visited_vertices[n1] < visited_vertices[n2]) << std::endl;
+		//std::cout << (VisitIndex(n1) < VisitIndex(n2)) << std::endl;
 		//std::cout << mGraph->areNeighbors(n1, n2) << std::endl;
 		//std::cout << mGraph->areNeighbors(n2, n1) << std::endl;
-		if ((visited_vertices[n1] < visited_vertices[n2])
+		if ((VisitIndex(n1) < VisitIndex(n2))
 				&& !(mGraph->areNeighbors(n1, n2)
 						|| mGraph->areNeighbors(n2, n1)))// check n1, n2 not neighbors
 			//std::cout << "Mark2" << std::endl;
@@ -212,16 +215,16 @@ void MotifCalculator::Motif3Subtree(unsigned int root) {
 
 void MotifCalculator::Motif4Subtree(unsigned int root) {
 	int idx_root = this->removalIndex->at(root);// root_idx is also our current iteration -
-	std::map<unsigned int, int> visited_vertices;// every node_idx smaller than root_idx is already handled
-	visited_vertices[root] = 0;
+	StartVisits();// every node_idx smaller than root_idx is already handled
+	MarkVisited(root, 0);
 
-	const unsigned int* neighbors = fullGraph.GetNeighborList();// all neighbors - ancestors and descendants
-	const int64* offsets = fullGraph.GetOffsetList();
+	const unsigned int* neighbors = fullGraph->GetNeighborList();// all neighbors - ancestors and descendants
+	const int64* offsets = fullGraph->GetOffsetList();
 
 	// TODO problem with dual edges
 	for (int64 i = offsets[root]; i < offsets[root + 1]; i++) // loop first neighbors
 		if (this->removalIndex->at(neighbors[i]) > idx_root) // n1 not handled yet
-			visited_vertices[neighbors[i]] = 1;
+			MarkVisited(neighbors[i], 1);
 
 	// TODO: add combinations_3 for first neighbors
 	/*
@@ -257,8 +260,8 @@ void MotifCalculator::Motif4Subtree(unsigned int root) {
 			unsigned int n2 = neighbors[n2_idx];
 			if (this->removalIndex->at(n2) <= idx_root)	// n2 already handled
 				continue;
-			if (visited_vertices.find(n2) == visited_vertices.end()) { // check if n2 was *not* visited
-				visited_vertices[n2] = 2;
+			if (!Visited(n2)) { // check if n2 was *not* visited
+				MarkVisited(n2, 2);
 
 			} //end if
 		} //end loop SECOND NEIGHBORS
@@ -273,7 +276,7 @@ void MotifCalculator::Motif4Subtree(unsigned int root) {
 				unsigned int n11 = neighbors[n11_idx];
 				if (this->removalIndex->at(n11) <= idx_root) // n2 already handled
 					continue;
-				if (visited_vertices[n2] == 2 && n11 != n1) { //TODO: verify
+				if (VisitIndex(n2) == 2 && n11 != n1) { //TODO: verify
 					bool edgeExists = mGraph->areNeighbors(n2, n11)
 							|| mGraph->areNeighbors(n11, n2);
 					if (!edgeExists || (edgeExists && n1 < n11)) {
@@ -295,7 +298,7 @@ void MotifCalculator::Motif4Subtree(unsigned int root) {
 				if (this->removalIndex->at(n21) <= idx_root
 						|| this->removalIndex->at(n22) <= idx_root) // motif already handled
 					continue;
-				if (2 == visited_vertices[n21] && visited_vertices[n22] == 2) {
+				if (2 == VisitIndex(n21) && VisitIndex(n22) == 2) {
 					this->GroupUpdater(std::vector<unsigned int> { root, n1,
 							n21, n22 }); // update motif counter [r,n1,n21,n22]
 				}
@@ -312,7 +315,7 @@ void MotifCalculator::Motif4Subtree(unsigned int root) {
 			unsigned int n2 = neighbors[n2_idx];
 			if (this->removalIndex->at(n2) <= idx_root)	// n2 already handled
 				continue;
-			if (visited_vertices[n2] == 1)
+			if (VisitIndex(n2) == 1)
 				continue;
 
 			for (int64 n3_idx = offsets[n2]; n3_idx < offsets[n2 + 1];
@@ -322,26 +325,26 @@ void MotifCalculator::Motif4Subtree(unsigned int root) {
 					continue;
 
 
-				if (visited_vertices.find(n3) == visited_vertices.end()) { // check if n3 was *not* visited
-					visited_vertices[n3] = 3;
-					if (visited_vertices[n2] == 2) { // check if n2 is a visited second neighbor
+				if (!Visited(n3)) { // check if n3 was *not* visited
+					MarkVisited(n3, 3);
+					if (VisitIndex(n2) == 2) { // check if n2 is a visited second neighbor
 						this->GroupUpdater(std::vector<unsigned int> { root, n1,
 								n2, n3 }); // update motif counter [r,n1,n2,n3]
 					} // end check if n2 is a visited second neighbor
 				} // end check if n3 was not visited
 
 				else {
-					if (visited_vertices[n3] == 1)
+					if (VisitIndex(n3) == 1)
 						continue;
 
 
-					if (visited_vertices[n3] == 2
+					if (VisitIndex(n3) == 2
 							&& !(mGraph->areNeighbors(n1, n3)
 									|| mGraph->areNeighbors(n3, n1))) {
 						this->GroupUpdater(std::vector<unsigned int> { root, n1,
 								n2, n3 }); // update motif counter [r,n1,n2,n3]
-					} else if (visited_vertices[n3] == 3
-							&& visited_vertices[n2] == 2) { //TODO: verify
+					} else if (VisitIndex(n3) == 3
+							&& VisitIndex(n2) == 2) { //TODO: verify
 						this->GroupUpdater(std::vector<unsigned int> { root, n1,
 								n2, n3 }); // update motif counter [r,n1,n2,n3]
 					} // end if
@@ -414,7 +417,5 @@ MotifCalculator::~MotifCalculator() {
 	delete nodeVariations;
 	//the index in which we remove the node from the graph. Basically, from this index on the node doesen't exist.
 	delete removalIndex;
-	//the nodes, sorted in descending order by the degree.
-	delete sortedNodesByDegree;
 
 }
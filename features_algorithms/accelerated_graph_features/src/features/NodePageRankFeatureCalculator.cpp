@@ -7,18 +7,48 @@
 
 #include "../includes/NodePageRankFeatureCalculator.h"
 
-NodePageRankFeatureCalculator::NodePageRankFeatureCalculator(float dumping,
-		unsigned int numOfIterations) :
-		dumping(dumping), numOfIterations(numOfIterations) {
+template<typename GraphT>
+NodePageRankFeatureCalculatorT<GraphT>::NodePageRankFeatureCalculatorT(
+		float dumping, unsigned int numOfIterations) :
+		dumping(dumping), numOfIterations(numOfIterations), tolerance(1e-6) {
 
 }
 
-std::vector<float> NodePageRankFeatureCalculator::Calculate() {
-	return mGraph->ComputeNodePageRank(this->dumping, this->numOfIterations);
+template<typename GraphT>
+NodePageRankFeatureCalculatorT<GraphT>::NodePageRankFeatureCalculatorT(
+		float dumping, unsigned int numOfIterations, double tolerance) :
+		dumping(dumping), numOfIterations(numOfIterations), tolerance(tolerance) {
 
 }
 
-NodePageRankFeatureCalculator::~NodePageRankFeatureCalculator() {
+template<typename GraphT>
+std::vector<float> NodePageRankFeatureCalculatorT<GraphT>::Calculate() {
+	return this->mGraph->ComputeNodePageRank(this->dumping, this->numOfIterations,
+			this->tolerance);
 
 }
 
+template<typename GraphT>
+std::vector<std::vector<float> > NodePageRankFeatureCalculatorT<GraphT>::CalculatePersonalized(
+		const std::vector<std::vector<typename GraphT::node_type> >& seedSets) {
+	return this->mGraph->ComputePersonalizedPageRank(seedSets, this->dumping,
+			this->numOfIterations, this->tolerance);
+}
+
+template<typename GraphT>
+std::vector<std::vector<std::pair<typename GraphT::node_type, float> > > NodePageRankFeatureCalculatorT<
+		GraphT>::CalculatePersonalizedPush(
+		const std::vector<std::vector<typename GraphT::node_type> >& seedSets,
+		double epsilon) {
+	return this->mGraph->ApproximatePersonalizedPageRank(seedSets,
+			this->dumping, epsilon);
+}
+
+template<typename GraphT>
+NodePageRankFeatureCalculatorT<GraphT>::~NodePageRankFeatureCalculatorT() {
+
+}
+
+template class NodePageRankFeatureCalculatorT<CompactCacheGraph> ;
+template class NodePageRankFeatureCalculatorT<CacheGraph> ;
+template class NodePageRankFeatureCalculatorT<LargeCacheGraph> ;
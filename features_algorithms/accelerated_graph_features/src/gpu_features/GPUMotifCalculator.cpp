@@ -49,9 +49,7 @@ __managed__ unsigned int* globalDeviceFeatures;
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void GPUMotifCalculator::init() {
-	CacheGraph inverse(true);
-	mGraph->InverseGraph(inverse);
-	mGraph->CureateUndirectedGraph(inverse, fullGraph);
+	fullGraph = &mGraph->undirected();
 	this->numOfNodes = this->mGraph->GetNumberOfNodes();
 	this->numOfEdges = this->mGraph->GetNumberOfEdges();
 	//std::cout << "Load variations" << std::endl;
@@ -72,7 +70,7 @@ void GPUMotifCalculator::init() {
 
 GPUMotifCalculator::GPUMotifCalculator(int level, bool directed) :
 		directed(directed), nodeVariations(NULL), allMotifs(NULL), removalIndex(
-		NULL), sortedNodesByDegree(NULL), fullGraph(false), numOfMotifs(0), deviceFeatures(
+		NULL), sortedNodesByDegree(NULL), fullGraph(NULL), numOfMotifs(0), deviceFeatures(
 		NULL) {
 	//check level
 	if (level != 3 && level != 4)
@@ -144,7 +142,7 @@ void GPUMotifCalculator::SetAllMotifs() {
 }
 
 void GPUMotifCalculator::SetSortedNodes() {
-	this->sortedNodesByDegree = mGraph->SortedNodesByDegree();
+	this->sortedNodesByDegree = &mGraph->degreeOrder();
 }
 /**
  * We iterate over the list of sorted nodes.
@@ -248,18 +246,18 @@ void GPUMotifCalculator::CopyAllToDevice() {
 	//	//std::cout << "Checker: " << i++ << std::endl;
 	gpuErrchk(
 			cudaMallocManaged(&deviceFullGraphOffsets,
-					(this->fullGraph.GetNumberOfNodes() + 1) * sizeof(int64)));
+					(this->fullGraph->GetNumberOfNodes() + 1) * sizeof(int64)));
 	//	//std::cout << "Checker: " << i++ << std::endl;
 	gpuErrchk(
 			cudaMallocManaged(&deviceFullGraphNeighbors,
-					(this->fullGraph.GetNumberOfEdges())
+					(this->fullGraph->GetNumberOfEdges())
 							* sizeof(unsigned int)));
 	//	//std::cout << "Checker: " << i++ << std::endl;
-	std::memcpy(deviceFullGraphOffsets, this->fullGraph.GetOffsetList(),
-			(this->fullGraph.GetNumberOfNodes() + 1) * sizeof(int64));
+	std::memcpy(deviceFullGraphOffsets, this->fullGraph->GetOffsetList(),
+			(this->fullGraph->GetNumberOfNodes() + 1) * sizeof(int64));
 	//	//std::cout << "Checker: " << i++ << std::endl;
-	std::memcpy(deviceFullGraphNeighbors, this->fullGraph.GetNeighborList(),
-			(this->fullGraph.GetNumberOfEdges()) * sizeof(unsigned int));
+	std::memcpy(deviceFullGraphNeighbors, this->fullGraph->GetNeighborList(),
+			(this->fullGraph->GetNumberOfEdges()) * sizeof(unsigned int));
 	//	//std::cout << "Checker: " << i++ << std::endl;
 
 	//Assign to global variables
@@ -710,8 +708,6 @@ GPUMotifCalculator::~GPUMotifCalculator() {
 	delete nodeVariations;
 	//the index in which we remove the node from the graph. Basically, from this index on the node doesen't exist.
 	delete removalIndex;
-	//the nodes, sorted in descending order by the degree.
-	delete sortedNodesByDegree;
 
 	// Memory resources
 
@@ -19,6 +19,7 @@ py::list GPUMotifCalculatorWrapper(dict converted_dict,int level) {
 	GPUMotifCalculator calc(level, directed);
 	calc.setGraph(reciever.getCacheGraph());
 	vector<vector<unsigned int>*>* res = calc.Calculate();
+	*res = reciever.toOriginalOrder(*res);
 	py::list motif_counters = convertVectorOfVectorsTo2DList(res);
 	for (auto p : *res) {
 		delete p;
@@ -11,36 +11,79 @@
 #include "FeatureCalculator.h"
 #include "DistanceUtils.h"
 #include <vector>
-#include <map>
 #include <math.h>
 
-class AttractionBasinCalculator: public FeatureCalculator<std::vector<double>*> {
+/*
+ The attraction basin of every node: the number of nodes at every distance to the node over the
+ average over all nodes, decayed by alpha^distance, over the same sum for the nodes at every
+ distance from the node (-1 for a node that reaches no other node).
+ The nodes at every distance from the sources are counted by DistanceUtils::MultiSourceLevelCounts,
+ SOURCES_PER_BFS sources at a time and in parallel, on the graph for the out distances and on the
+ inverse graph for the in distances. Only these counts are kept (O(N * diameter) memory), and
+ the averages and the features are computed from them at the end.
+ With pivot sampling (see PivotSampling), the averages are estimated from the counts of the
+ pivots alone, and the sums of every node from its distances to and from the pivots (by BFS
+ traversals from every pivot in the graph and in the inverse graph); GetConfidenceIntervals has
+ the half widths of the 95% confidence intervals of the features.
+ With HyperANF (see HyperAnf), the counts at every distance are estimated from HyperLogLog
+ counters in the graph and in the inverse graph instead, one distance at a time, so that neither
+ the counts nor the distances are kept; this is meant for graphs too big for a BFS from every node.
+ */
+template<typename GraphT>
+class AttractionBasinCalculatorT: public FeatureCalculator<std::vector<double>*, GraphT> {
 public:
-	AttractionBasinCalculator(int alpha);
-	AttractionBasinCalculator();
+	AttractionBasinCalculatorT(int alpha);
+	AttractionBasinCalculatorT();
 
 	virtual std::vector<double>* Calculate();
-	virtual ~AttractionBasinCalculator();
+	virtual ~AttractionBasinCalculatorT();
+
+	// Estimate the features from NumberOfPivots pivots instead (0 goes back to the exact features)
+	void SetPivotSampling(unsigned int NumberOfPivots, unsigned int seed,
+			bool stratified);
+	const std::vector<double>& GetConfidenceIntervals() const {
+		return confidenceIntervals;
+	}
+	// Estimate the features by HyperANF with 2^Log2Registers registers a counter instead (0 goes
+	// back to the exact features)
+	void SetHyperAnf(unsigned int Log2Registers, unsigned int seed);
+
+	static const unsigned int SOURCES_PER_BFS = 128;
 
 private:
-	void calc_attraction_basin_dists();
-	void calc_average_per_dist();
-	void printVars();
+	typedef typename GraphT::node_type NodeId;
+
+	std::vector<double>* CalculateApproximate();
+	std::vector<double>* CalculateHyperAnf();
+	// The decayed sum of the estimated counts over their averages, for every node
+	void hyperanf_decayed_sums(const GraphT& graph, std::vector<double>& sums);
+	// The counts of the given sources (all of the nodes, by default), and the average of the counts
+	// expanded by the weights of the sources
+	void calc_attraction_basin_dists(const GraphT& graph,
+			std::vector<std::vector<int64> >& counts,
+			std::vector<double>& average_per_dist,
+			const std::vector<NodeId>* sources = NULL,
+			const std::vector<double>* weights = NULL);
 
 	// The exponential decent coefficient
 	int alpha;
 
-	// For each node, we count the number of occurrences of each dist.
-	// Hence, ab_*_dist[n][d] will give the number of nodes that are of a distance d from n.
-	std::vector<std::map<unsigned int, unsigned int>*>* ab_in_dist;
-	std::vector<std::map<unsigned int, unsigned int>*>* ab_out_dist;
+	// For each batch of SOURCES_PER_BFS nodes, the number of nodes at every distance from (out) or to
+	// (in) every node of the batch, as returned by DistanceUtils::MultiSourceLevelCounts.
+	std::vector<std::vector<int64> > ab_out_dist;
+	std::vector<std::vector<int64> > ab_in_dist;
 
-	// For each distance, save the average number of nodes in that distance (over the entire graph).
-	std::map<unsigned int,double>* average_out_per_dist;
-	std::map<unsigned int, double>* average_in_per_dist;
+	// For each distance, the average number of nodes in that distance (over the entire graph).
+	std::vector<double> average_out_per_dist;
+	std::vector<double> average_in_per_dist;
 
-	// The feature list to return
-	std::vector<double>* features;
+	unsigned int numOfPivots;
+	unsigned int log2Registers;
+	unsigned int seed;
+	bool stratified;
+	std::vector<double> confidenceIntervals;
 };
 
+typedef AttractionBasinCalculatorT<CacheGraph> AttractionBasinCalculator;
+
 #endif /* FEATURES_ATTRACTIONBASINCALCULATOR_H_ */
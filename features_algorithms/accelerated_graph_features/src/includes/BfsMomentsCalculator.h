@@ -4,8 +4,6 @@
 #include "FeatureCalculator.h"
 #include "CacheGraph.h"
 #include "DistanceUtils.h"
-#include "MathUtils.h"
-#include <unordered_map>
 #include <vector>
 #include <tuple>
 
@@ -13,19 +11,68 @@
 typedef std::tuple<float,float> floatTuple;
 
 using namespace std;
-class BfsMomentsCalculator :
-	public FeatureCalculator<vector<floatTuple>>
+/*
+	The mean and the standard deviation of the distances (plus one) of the nodes every node reaches,
+	itself included, for a graph of any of the CacheGraph index widths.
+	The sources are traversed SOURCES_PER_BFS at a time by DistanceUtils::MultiSourceBfs, and the
+	batches are spread over the threads. Every thread counts the nodes each source of its batch
+	reaches at every level in its own histogram (see DistanceUtils::MultiSourceLevelCounts), and
+	the moments are then computed from the histogram in one streaming (Welford) pass, in double
+	precision.
+	With pivot sampling (see PivotSampling), the moments are instead estimated from the distances
+	of every node to k pivots (by BFS traversals from the pivots in the inverse graph), and
+	GetConfidenceIntervals has the half widths of the 95% confidence intervals of the mean and the
+	standard deviation of every node.
+	With HyperANF (see HyperAnf), the number of nodes at every distance from every node is estimated
+	from HyperLogLog counters instead, in O(E) time per distance and O(N) memory, for graphs too
+	big for a BFS from every node.
+	The weighted moments (by the weights of a weighted graph) come from DistanceUtils::Dijkstra from
+	every node, spread over the threads.
+*/
+template<typename GraphT>
+class BfsMomentsCalculatorT :
+	public FeatureCalculator<vector<floatTuple>, GraphT>
 {
 public:
-	BfsMomentsCalculator();
+	BfsMomentsCalculatorT();
 	virtual vector<floatTuple> Calculate();
 
-	virtual ~BfsMomentsCalculator();
+	// Estimate the moments from NumberOfPivots pivots instead (0 goes back to the exact moments)
+	void SetPivotSampling(unsigned int NumberOfPivots, unsigned int seed,
+			bool stratified);
+	const vector<floatTuple>& GetConfidenceIntervals() const {
+		return confidenceIntervals;
+	}
+	// Estimate the moments by HyperANF with 2^Log2Registers registers a counter instead (0 goes
+	// back to the exact moments)
+	void SetHyperAnf(unsigned int Log2Registers, unsigned int seed);
+	// The moments of the weighted distances instead, which are always exact
+	void SetWeighted(bool weighted) {
+		this->weighted = weighted;
+	}
+
+	virtual ~BfsMomentsCalculatorT();
+
+	static const unsigned int SOURCES_PER_BFS = 128;
 
 protected:
 	virtual inline bool checkGPUEnabled() {
 		return false;
 	}
+
+private:
+	vector<floatTuple> CalculateApproximate();
+	vector<floatTuple> CalculateHyperAnf();
+	vector<floatTuple> CalculateWeighted();
+
+	unsigned int numOfPivots;
+	unsigned int log2Registers;
+	unsigned int seed;
+	bool stratified;
+	bool weighted;
+	vector<floatTuple> confidenceIntervals;
 };
 
+typedef BfsMomentsCalculatorT<CacheGraph> BfsMomentsCalculator;
+
 #endif
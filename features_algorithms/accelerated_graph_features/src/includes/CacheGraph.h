@@ -9,6 +9,7 @@
 #define CACHEGRAPH_H_
 
 #include <string>
+#include <utility>
 #include <vector>
 #include <iomanip>
 #include <exception>
@@ -20,6 +21,155 @@
 #pragma warning(pop)
 #include "stdafx.h"
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+/*
+ The on-disk format of a CacheGraph, shared by the graphs of all index widths.
+ A saved graph file starts with a FileHeader, followed by a table of FileSection entries,
+ each describing one array in the file.
+ */
+class CacheGraphFormat {
+public:
+	// Optional sections that SaveToFile can precompute and store alongside the graph
+	enum DerivedSection {
+		SAVE_INVERSE = 1,
+		SAVE_UNDIRECTED = 2,
+		SAVE_DEGREES = 4,
+		SAVE_DEGREE_ORDER = 8,
+		SAVE_ALL_DERIVED = 15
+	};
+
+	/*
+	 Read the sizes (in bytes) of the node IDs and the offsets a graph file was saved with,
+	 so the file can be loaded into a CacheGraphT of the matching widths.
+	 Returns false if the file is missing or is not a graph file of our version.
+	 */
+	static bool ReadFileWidths(const std::string& FileName,
+			unsigned int& NodeIdSize, unsigned int& OffsetSize);
+
+	template<typename value_type>
+	static bool SaveValueToFile(const std::vector<value_type>& values,
+			const std::string& FileName, bool IsNewFile);
+
+protected:
+	/*
+	 The header at the beginning of a saved graph file.
+	 It is followed by a table of numberOfSections FileSection entries, each describing
+	 one array in the file. Every section starts at a position aligned to FILE_ALIGNMENT
+	 bytes, so the file can be mapped into memory and used in place.
+	 The checksum covers the header (with the checksum set to 0) and the section table.
+	 */
+	typedef struct {
+		char magic[8];
+		unsigned int version;
+		unsigned int flags;
+		unsigned int nodeIdSize;
+		unsigned int offsetSize;
+		int64 numberOfNodes;
+		int64 numberOfEdges;
+		int64 numberOfSections;
+		int64 sectionTablePosition;
+		int64 checksum;
+	} FileHeader;
+
+	typedef struct {
+		unsigned int kind;
+		unsigned int elementSize;
+		int64 position;
+		int64 count;
+		int64 checksum;
+	} FileSection;
+
+	enum SectionKind {
+		SECTION_OFFSETS = 1,
+		SECTION_NEIGHBORS,
+		SECTION_WEIGHTS,
+		SECTION_INVERSE_OFFSETS,
+		SECTION_INVERSE_NEIGHBORS,
+		SECTION_INVERSE_WEIGHTS,
+		SECTION_UNDIRECTED_OFFSETS,
+		SECTION_UNDIRECTED_NEIGHBORS,
+		SECTION_UNDIRECTED_WEIGHTS,
+		SECTION_DEGREES,
+		SECTION_DEGREE_ORDER
+	};
+
+	static const char FILE_MAGIC[8];
+	static const unsigned int FILE_VERSION = 2;
+	static const unsigned int FILE_FLAG_WEIGHTED = 1;
+	static const unsigned int FILE_FLAG_DIRECTED = 2;
+	static const int64 FILE_ALIGNMENT = 64;
+
+	static int64 AlignFilePosition(int64 position) {
+		return (position + FILE_ALIGNMENT - 1) / FILE_ALIGNMENT * FILE_ALIGNMENT;
+	}
+	static int64 Checksum(const void* data, int64 size, int64 seed);
+	// Whether count elements of elementSize bytes from position fit in a file of FileSize bytes
+	static bool FitsInFile(int64 position, int64 count, int64 elementSize,
+			int64 FileSize) {
+		return position <= FileSize
+				&& (elementSize == 0 || count <= (FileSize - position) / elementSize);
+	}
+	static bool ReadFileHeader(const std::string& FileName, FileHeader& header);
+	// Whether the header is of a graph file of our version and of the given widths
+	static bool IsOurHeader(const FileHeader& header, unsigned int NodeIdSize,
+			unsigned int OffsetSize) {
+		return std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0
+				&& header.version == FILE_VERSION
+				&& header.nodeIdSize == NodeIdSize
+				&& header.offsetSize == OffsetSize;
+	}
+};
+
+template<typename value_type> bool CacheGraphFormat::SaveValueToFile(
+		const std::vector<value_type>& values, const std::string& FileName,
+		bool IsNewFile) {
+	FILE* hFile = std::fopen(FileName.c_str(), (IsNewFile) ? "w+b" : "ab");
+	std::fwrite(&values[0], sizeof(value_type), values.size(), hFile);
+	std::fclose(hFile);
+	hFile = NULL;
+	return true;
+}
+template bool CacheGraphFormat::SaveValueToFile<unsigned int>(
+		const std::vector<unsigned int>& values, const std::string& FileName,
+		bool IsNewFile);
+template bool CacheGraphFormat::SaveValueToFile<float>(
+		const std::vector<float>& values, const std::string& FileName,
+		bool IsNewFile);
+template bool CacheGraphFormat::SaveValueToFile<int64>(
+		const std::vector<int64>& values, const std::string& FileName,
+		bool IsNewFile);
+template bool CacheGraphFormat::SaveValueToFile<unsigned short>(
+		const std::vector<unsigned short>& values, const std::string& FileName,
+		bool IsNewFile);
+
+/*
+ The node orderings CacheGraphT::ComputeNodeOrdering can produce.
+ */
+enum NodeOrdering {
+	ORDER_ORIGINAL = 0, // keep the IDs as they are
+	ORDER_DEGREE, // by descending degree, so the hubs share cache lines
+	ORDER_RCM, // reverse Cuthill-McKee, which keeps the neighbors of a node close to it
+	ORDER_COMMUNITY // the nodes of every (label propagation) community next to each other
+};
+
+/*
+ The local clustering coefficients CacheGraphT::ComputeClustering computes for every node.
+ The total is Fagiolo's clustering of a directed graph (and the usual one of an undirected graph),
+ and the others count only the triangles of one kind, by the direction of the edges of the node.
+ */
+enum ClusteringType {
+	CLUSTERING_TOTAL = 0, // all of the triangles
+	CLUSTERING_CYCLE, // i -> j -> k -> i
+	CLUSTERING_MIDDLEMAN, // k -> i -> j and k -> j
+	CLUSTERING_IN, // j -> i, k -> i and j -> k
+	CLUSTERING_OUT, // i -> j, i -> k and j -> k
+	NUMBER_OF_CLUSTERING_TYPES
+};
 
 /*
  This class is based on the code from Lev's lab.
@@ -31,49 +181,89 @@
  Access to the graph is done by first checking the offset list to find the position of a
  node, and then iterating over all the adjacent nodes.
 
+ The class is templated on the width of the node IDs (the adjacency list) and of the offsets.
+ The narrower the types, the smaller the working set, so a graph should be held in the narrowest
+ instantiation that fits it (see Fits and CacheGraphDispatch). The instantiations are:
+ 	 CompactCacheGraph - 32 bit node IDs and 32 bit offsets, for up to 4G edges
+ 	 CacheGraph - 32 bit node IDs and 64 bit offsets, the default
+ 	 LargeCacheGraph - 64 bit node IDs and 64 bit offsets, for more than 4G nodes
  */
-class CacheGraph {
+template<typename NodeId, typename EdgeOffset>
+class CacheGraphT: public CacheGraphFormat {
 public:
-	CacheGraph(bool directed) :
+	typedef NodeId node_type;
+	typedef EdgeOffset offset_type;
+
+	CacheGraphT(bool directed) :
 			m_NumberOfNodes(0), m_NumberOfEdges(0), m_Graph(NULL), m_Offsets(
-			NULL), m_Weights(NULL), weighted(false), directed(directed) {
+			NULL), m_Weights(NULL), weighted(false), directed(directed), m_Mapping(
+			NULL), m_MappingSize(0), m_CompressedControl(NULL), m_CompressedData(
+			NULL), m_CompressedPositions(NULL), m_Inverse(NULL), m_Undirected(
+			NULL), m_Degrees(NULL), m_DegreeOrder(NULL), m_NeighborIndex(NULL) {
 
 	}
 
-	CacheGraph() :
-			CacheGraph(false) {
+	CacheGraphT() :
+			CacheGraphT(false) {
 	}
 
-	CacheGraph(const CacheGraph&) = delete;
-	~CacheGraph() {
+	CacheGraphT(const CacheGraphT&) = delete;
+	~CacheGraphT() {
 		Clear();
 	}
-	const CacheGraph& operator=(const CacheGraph&) = delete;
+	const CacheGraphT& operator=(const CacheGraphT&) = delete;
+
+	/*
+	 Whether a graph with the given number of nodes and edges can be held in this instantiation.
+	 */
+	static bool Fits(int64 NumberOfNodes, int64 NumberOfEdges) {
+		return NumberOfNodes < static_cast<int64>(std::numeric_limits<NodeId>::max())
+				&& NumberOfEdges <= static_cast<int64>(std::numeric_limits<EdgeOffset>::max());
+	}
 
 	void Clear();
+	/*
+	 The neighbor list can hold 32 bit (unsigned int) or 64 bit (int64) node IDs, whatever the
+	 width of the graph's IDs, as long as the graph fits the instantiation.
+	 */
+	template<typename ListId>
 	void Assign(const std::vector<int64>& NodeOffsets,
-			const std::vector<unsigned int>& Neighbours);
+			const std::vector<ListId>& Neighbours);
+	template<typename ListId>
 	void Assign(const std::vector<int64>& NodeOffsets,
-			const std::vector<unsigned int>& Neighbours,
+			const std::vector<ListId>& Neighbours,
 			const std::vector<double>& weights);
-	bool SaveToFile(const std::string& FileName) const;
+	bool SaveToFile(const std::string& FileName,
+			unsigned int DerivedSections = 0) const;
 	bool LoadFromFile(const std::string& FileName);
 	bool LoadFromFile(const std::string& DirectroyName,
 			const std::string& BaseFileName);
+	bool MapFromFile(const std::string& FileName);
+
+	bool isMemoryMapped() const {
+		return m_Mapping != NULL;
+	}
+
+	bool LoadInverseGraph(CacheGraphT& InvertedGraph) const;
+	bool LoadUndirectedGraph(CacheGraphT& UndirectedGraph) const;
 
 	static std::string GetFileNameFromFolder(const std::string& DirectroyName,
 			const std::string& BaseFileName);
 
-	unsigned int GetNumberOfNodes() const {
+	NodeId GetNumberOfNodes() const {
 		return m_NumberOfNodes;
 	}
-	unsigned int GetNumberOfEdges() const {
+	EdgeOffset GetNumberOfEdges() const {
 		return m_NumberOfEdges;
 	}
-	const unsigned int* GetNeighborList() const {
-		return m_Graph;
+	const NodeId* GetNeighborList() const {
+		if (isCompressed())
+			throw std::runtime_error(
+					"The neighbor list is compressed, use neighbors() or Decompress()");
+		else
+			return m_Graph;
 	}
-	const int64* GetOffsetList() const {
+	const EdgeOffset* GetOffsetList() const {
 		return m_Offsets;
 	}
 
@@ -92,34 +282,285 @@ public:
 		return this->directed;
 	}
 
-	void InverseGraph(CacheGraph& InvertedGraph) const;
-	void CureateUndirectedGraph(const CacheGraph& InvertedGraph,
-			CacheGraph& UndirectedGraph) const;
+	/*
+	 The neighbor list can be kept compressed: every list is stored as the gaps between its
+	 (sorted) neighbors, in a variable number of bytes each, stream-vbyte style. The 2 bit length
+	 codes of all the edges are kept in a separate control stream indexed by the edge offsets, and
+	 the bytes of the gaps in a data stream, so that decoding doesn't branch on every byte.
+	 This usually takes 2-4 times less memory than the raw list.
+	 While the graph is compressed GetNeighborList throws, and the neighbors should be read through
+	 neighbors(), which works in both forms.
+	 Memory mapped graphs can't be compressed.
+	 */
+	bool Compress();
+	void Decompress();
+	bool isCompressed() const {
+		return m_CompressedData != NULL;
+	}
+
+	/*
+	 Iterates over the neighbors of a node in ascending order, whether or not the graph is compressed:
+	 	 for (NodeId neighbor : graph.neighbors(node)) ...
+	 edge() is the index of the current edge, e.g. in the weights.
+	 */
+	class NeighborIterator {
+	public:
+		NeighborIterator(const CacheGraphT* graph, EdgeOffset edge,
+				EdgeOffset end, const unsigned char* data) :
+				graph(graph), currentEdge(edge), end(end), data(data), value(0) {
+			Load();
+		}
+		NodeId operator*() const {
+			return value;
+		}
+		NeighborIterator& operator++() {
+			++currentEdge;
+			Load();
+			return *this;
+		}
+		bool operator!=(const NeighborIterator& other) const {
+			return currentEdge != other.currentEdge;
+		}
+		EdgeOffset edge() const {
+			return currentEdge;
+		}
+	private:
+		void Load() {
+			if (currentEdge >= end)
+				return;
+			if (data == NULL)
+				value = graph->m_Graph[currentEdge];
+			else
+				value += graph->DecodeGap(currentEdge, data);
+		}
+		const CacheGraphT* graph;
+		EdgeOffset currentEdge, end;
+		const unsigned char* data;
+		NodeId value;
+	};
+
+	class NeighborRange {
+	public:
+		NeighborRange(const NeighborIterator& first, const NeighborIterator& last) :
+				first(first), last(last) {
+		}
+		NeighborIterator begin() const {
+			return first;
+		}
+		NeighborIterator end() const {
+			return last;
+		}
+	private:
+		NeighborIterator first, last;
+	};
+
+	NeighborRange neighbors(NodeId node) const {
+		const EdgeOffset begin = m_Offsets[node], end = m_Offsets[node + 1];
+		return NeighborRange(
+				NeighborIterator(this, begin, end,
+						isCompressed() ?
+								m_CompressedData + m_CompressedPositions[node] :
+								NULL), NeighborIterator(this, end, end, NULL));
+	}
+
+	/*
+	 Derived views of the graph, built the first time they are requested (or loaded from the
+	 graph file if they were saved there) and shared by everyone that uses the graph afterwards.
+	 They are safe to request from several threads, and are freed when the graph is cleared or
+	 destroyed.
+	 */
+	const CacheGraphT& inverse() const;
+	const CacheGraphT& undirected() const;
+	const std::vector<NodeId>& degrees() const;
+	const std::vector<NodeId>& degreeOrder() const;
+
+	void InverseGraph(CacheGraphT& InvertedGraph) const;
+	void CreateUndirectedGraph(const CacheGraphT& InvertedGraph,
+			CacheGraphT& UndirectedGraph) const;
 
 	//void ToBoostGraph() const;
-	std::vector<unsigned int> ComputeNodeDegrees() const;
+	std::vector<NodeId> ComputeNodeDegrees() const;
+	/*
+	 The page rank of every node (see the definition for the details).
+	 The first version runs up to NumberOfIterations iterations with a tolerance of 1e-6.
+	 */
 	std::vector<float> ComputeNodePageRank(float dumping,
 			unsigned int NumberOfIterations) const;
-	std::vector<unsigned short> ComputeKCore() const;
+	std::vector<float> ComputeNodePageRank(float dumping,
+			unsigned int MaxIterations, double tolerance) const;
+	/*
+	 Personalized page rank, where the random walk restarts at a (uniformly chosen) node of a seed
+	 set instead of any node.
+	 ComputePersonalizedPageRank runs the power iteration for all of the seed sets at once, and
+	 returns the ranks of every set. ApproximatePersonalizedPageRank is the local forward push
+	 approximation, for a few seeds in a large graph: it only visits the nodes around the seeds, and
+	 returns the (node, rank) pairs it reached, sorted by node, with an L1 error of at most
+	 epsilon times the number of edges.
+	 */
+	std::vector<std::vector<float> > ComputePersonalizedPageRank(
+			const std::vector<std::vector<NodeId> >& SeedSets, float dumping,
+			unsigned int MaxIterations, double tolerance) const;
+	std::vector<std::vector<std::pair<NodeId, float> > > ApproximatePersonalizedPageRank(
+			const std::vector<std::vector<NodeId> >& SeedSets, float dumping,
+			double epsilon) const;
+	/*
+	 The core number of every node (for a directed graph, by the total degree).
+	 ComputeKCore is the linear time sequential algorithm, and ComputeKCoreParallel peels the
+	 nodes level by level on several threads, which pays off for large graphs.
+	 */
+	std::vector<NodeId> ComputeKCore() const;
+	std::vector<NodeId> ComputeKCoreParallel() const;
 
-	template<typename value_type>
-	static bool SaveValueToFile(const std::vector<value_type>& values,
-			const std::string& FileName, bool IsNewFile);
+	bool areNeighbors(const NodeId p, const NodeId q) const;
+	std::vector<NodeId>* SortedNodesByDegree() const;
+
+	/*
+	 The neighbors p and q have in common, by intersecting their (sorted) neighbor lists with
+	 IntersectionUtils. CountCommonNeighbors returns their number, and CommonNeighbors replaces the
+	 content of out with them, in increasing order.
+	 */
+	int64 CountCommonNeighbors(NodeId p, NodeId q) const;
+	int64 CommonNeighbors(NodeId p, NodeId q, std::vector<NodeId>& out) const;
 
-	bool areNeighbors(const unsigned int p, const unsigned int q) const;
-	std::vector<unsigned int>* SortedNodesByDegree() const;
+	/*
+	 The number of triangles of every node, and optionally of every edge (in the order of the
+	 neighbor list), in the undirected version of the graph. See the definition for the algorithm.
+	 */
+	void CountTriangles(std::vector<int64>& NodeTriangles,
+			std::vector<NodeId>* EdgeTriangles) const;
+	/*
+	 The local clustering coefficients of every node, as networkx defines them: Fagiolo's
+	 coefficients of a directed graph, and Onnela's (the geometric mean of the weights of the
+	 triangle, over the largest weight) of a weighted graph. Clustering gets a vector for every
+	 ClusteringType; for an undirected graph they are all the same.
+	 */
+	void ComputeClustering(std::vector<std::vector<float> >& Clustering) const;
+
+	/*
+	 An optional index that makes areNeighbors (nearly) O(1) for nodes with long neighbor lists:
+	 nodes of a high degree get a bitmap of their neighbors, nodes of a medium degree get a small
+	 open addressed hash set, and short lists are scanned linearly without branches.
+	 The index is built once (it's safe to call from several threads) and is freed with the graph.
+	 */
+	void BuildNeighborIndex() const;
+	bool hasNeighborIndex() const {
+		return m_NeighborIndex.load(std::memory_order_acquire) != NULL;
+	}
+
+	/*
+	 Relabeling the nodes for cache locality.
+	 ComputeNodeOrdering returns the new ID of every node, Relabel builds the graph with the new IDs,
+	 and ToOriginalOrder maps a per-node result computed on the relabeled graph back to the
+	 original IDs.
+	 */
+	std::vector<NodeId> ComputeNodeOrdering(NodeOrdering Ordering) const;
+	void Relabel(const std::vector<NodeId>& NewIds,
+			CacheGraphT& RelabeledGraph) const;
+	template<typename T>
+	static std::vector<T> ToOriginalOrder(const std::vector<T>& values,
+			const std::vector<NodeId>& NewIds) {
+		std::vector<T> OriginalValues;
+		OriginalValues.reserve(NewIds.size());
+		for (size_t node = 0; node < NewIds.size(); ++node)
+			OriginalValues.push_back(values[NewIds[node]]);
+		return OriginalValues;
+	}
 
 private:
-	unsigned int m_NumberOfNodes;
-	unsigned int m_NumberOfEdges;
-	unsigned int *m_Graph;
-	int64* m_Offsets;
+	NodeId m_NumberOfNodes;
+	EdgeOffset m_NumberOfEdges;
+	NodeId *m_Graph;
+	EdgeOffset* m_Offsets;
 	double* m_Weights;
 	bool weighted, directed;
 
+	// When the graph is memory mapped, the arrays above point into this read-only
+	// mapping instead of owning their own memory.
+	void* m_Mapping;
+	size_t m_MappingSize;
+
+	// The compressed neighbor list, see Compress. m_CompressedPositions holds the position of every
+	// node's gaps in m_CompressedData, which is padded so that a full NodeId can always be read.
+	unsigned char* m_CompressedControl;
+	unsigned char* m_CompressedData;
+	int64* m_CompressedPositions;
+
+	static unsigned int CompressedLength(unsigned int code) {
+		return sizeof(NodeId) == 4 ? code + 1 : 1u << code;
+	}
+	static NodeId CompressedMask(unsigned int code) {
+		return CompressedLength(code) >= sizeof(NodeId) ?
+				static_cast<NodeId>(-1) :
+				(static_cast<NodeId>(1) << (8 * CompressedLength(code))) - 1;
+	}
+	NodeId DecodeGap(EdgeOffset edge, const unsigned char*& data) const {
+		const unsigned int code = (m_CompressedControl[edge >> 2]
+				>> ((edge & 3) << 1)) & 3;
+		NodeId gap;
+		std::memcpy(&gap, data, sizeof(NodeId));
+		data += CompressedLength(code);
+		return gap & CompressedMask(code);
+	}
+	const NodeId* NeighborListOf(NodeId node, std::vector<NodeId>& buffer) const;
+	void ReverseCuthillMcKeeOrder(std::vector<NodeId>& Order) const;
+	void CommunityOrder(std::vector<NodeId>& Order) const;
+
+	// The lazily built views, guarded by m_ViewsMutex
+	mutable std::recursive_mutex m_ViewsMutex;
+	mutable CacheGraphT* m_Inverse;
+	mutable CacheGraphT* m_Undirected;
+	mutable std::vector<NodeId>* m_Degrees;
+	mutable std::vector<NodeId>* m_DegreeOrder;
+
+	/*
+	 The neighbor index, see BuildNeighborIndex.
+	 kinds holds the kind of every node's index: INDEX_LINEAR, INDEX_BITMAP or the log2 of the
+	 capacity of its hash set, and positions the start of its hash set or bitmap.
+	 */
+	struct NeighborIndex {
+		std::vector<unsigned char> kinds;
+		std::vector<int64> positions;
+		std::vector<NodeId> hashSets;
+		std::vector<int64> bitmaps;
+	};
+	mutable std::atomic<NeighborIndex*> m_NeighborIndex;
+	static const unsigned char INDEX_LINEAR = 0;
+	static const unsigned char INDEX_BITMAP = 255;
+	// Lists up to this length are scanned, longer ones are indexed
+	static const unsigned int LINEAR_SEARCH_DEGREE = 16;
+
+	// The number of nodes in a block of the page rank sums
+	static const int64 PAGE_RANK_BLOCK = 2048;
+	// The number of nodes the triangle counting threads take at a time
+	static const int64 TRIANGLE_GRAIN = 64;
+	// The personalized page ranks of a node are kept in vectors of this many seed sets, so that
+	// every neighbor that is read updates all of them at once
+	static const unsigned int PAGE_RANK_LANES = 4;
+	typedef float PageRankLanes __attribute__((vector_size(PAGE_RANK_LANES * sizeof(float))));
+	void CheckSeeds(const std::vector<std::vector<NodeId> >& SeedSets) const;
+	std::vector<NodeId> KCoreDegrees() const;
+
+	static int64 NeighborHash(NodeId node, unsigned int bits) {
+		return (static_cast<int64>(node) * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+	}
+
+	// The file this graph was loaded from and its section table,
+	// so that optional sections can be read only when they are needed.
+	std::string m_FileName;
+	std::vector<FileSection> m_Sections;
+
+	static int64 MergeNeighborLists(const NodeId* p1, const NodeId* end1,
+			const double* w1, const NodeId* p2, const NodeId* end2,
+			const double* w2, NodeId* out, double* outWeights);
+	bool LoadSections(const std::string& FileName, bool memoryMapped,
+			unsigned int offsetsKind, unsigned int graphKind,
+			unsigned int weightsKind);
+	const FileSection* FindSection(unsigned int kind) const;
+	bool ReadSection(unsigned int kind, void* destination, int64 count) const;
+
 	typedef struct {
-		unsigned int node;
-		unsigned int degree;
+		NodeId node;
+		NodeId degree;
 	} NodeWithDegree;
 
 	/**
@@ -134,26 +575,8 @@ private:
 	} cmpNodesByDegree;
 };
 
-template<typename value_type> bool CacheGraph::SaveValueToFile(
-		const std::vector<value_type>& values, const std::string& FileName,
-		bool IsNewFile) {
-	FILE* hFile = std::fopen(FileName.c_str(), (IsNewFile) ? "w+b" : "ab");
-	std::fwrite(&values[0], sizeof(value_type), values.size(), hFile);
-	std::fclose(hFile);
-	hFile = NULL;
-	return true;
-}
-template bool CacheGraph::SaveValueToFile<unsigned int>(
-		const std::vector<unsigned int>& values, const std::string& FileName,
-		bool IsNewFile);
-template bool CacheGraph::SaveValueToFile<float>(
-		const std::vector<float>& values, const std::string& FileName,
-		bool IsNewFile);
-template bool CacheGraph::SaveValueToFile<int64>(
-		const std::vector<int64>& values, const std::string& FileName,
-		bool IsNewFile);
-template bool CacheGraph::SaveValueToFile<unsigned short>(
-		const std::vector<unsigned short>& values, const std::string& FileName,
-		bool IsNewFile);
+typedef CacheGraphT<unsigned int, unsigned int> CompactCacheGraph;
+typedef CacheGraphT<unsigned int, int64> CacheGraph;
+typedef CacheGraphT<int64, int64> LargeCacheGraph;
 
 #endif /* CACHEGRAPH_H_ */
@@ -0,0 +1,110 @@
+/*
+ * CacheGraphDispatch.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDES_CACHEGRAPHDISPATCH_H_
+#define INCLUDES_CACHEGRAPHDISPATCH_H_
+
+#include "stdafx.h"
+#include "CacheGraph.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ Picks the CacheGraph instantiation (index widths) for a graph at runtime.
+ The graph is built in the narrowest instantiation that fits it, and handed to a function object
+ with a templated operator(), which is called with the graph and whose result is returned.
+ The function object must define its result_type, for example:
+
+ 	 struct Calculate {
+ 	 	 typedef std::vector<float> result_type;
+ 	 	 template<typename GraphT>
+ 	 	 result_type operator()(const GraphT& graph) const { ... }
+ 	 };
+ */
+class CacheGraphDispatch {
+public:
+	/*
+	 Build the graph from an offset list and a neighbor list (and optionally weights).
+	 The neighbor list holds 32 bit (unsigned int) or 64 bit (int64) node IDs. The graph is a
+	 CompactCacheGraph if it has less than 4G edges, a CacheGraph if it has less than 4G nodes,
+	 and a LargeCacheGraph otherwise.
+	 Throws an invalid_argument if the offset list is empty (it has an entry for every node and
+	 one past the last).
+	 */
+	template<typename ListId, typename Function>
+	static typename Function::result_type FromLists(
+			const std::vector<int64>& NodeOffsets,
+			const std::vector<ListId>& Neighbours,
+			const std::vector<double>* weights, bool directed,
+			const Function& func) {
+		if (NodeOffsets.empty())
+			throw std::invalid_argument("The offset list of the graph is empty");
+		const int64 NumberOfNodes = NodeOffsets.size() - 1;
+		const int64 NumberOfEdges = NodeOffsets.back();
+		if (CompactCacheGraph::Fits(NumberOfNodes, NumberOfEdges))
+			return FromListsAs<CompactCacheGraph>(NodeOffsets, Neighbours,
+					weights, directed, func);
+		if (CacheGraph::Fits(NumberOfNodes, NumberOfEdges))
+			return FromListsAs<CacheGraph>(NodeOffsets, Neighbours, weights,
+					directed, func);
+		return FromListsAs<LargeCacheGraph>(NodeOffsets, Neighbours, weights,
+				directed, func);
+	}
+
+	/*
+	 Load the graph from a file saved by CacheGraphT::SaveToFile, in the instantiation it was
+	 saved with (see CacheGraphT::Fits for choosing it before saving).
+	 If memoryMapped is true, the file is mapped instead of read.
+	 Throws a runtime_error if the file can't be loaded.
+	 */
+	template<typename Function>
+	static typename Function::result_type FromFile(const std::string& FileName,
+			bool memoryMapped, const Function& func) {
+		unsigned int NodeIdSize = 0, OffsetSize = 0;
+		if (!CacheGraphFormat::ReadFileWidths(FileName, NodeIdSize, OffsetSize))
+			throw std::runtime_error("Not a graph file: " + FileName);
+		if (NodeIdSize == sizeof(unsigned int)
+				&& OffsetSize == sizeof(unsigned int))
+			return FromFileAs<CompactCacheGraph>(FileName, memoryMapped, func);
+		if (NodeIdSize == sizeof(unsigned int) && OffsetSize == sizeof(int64))
+			return FromFileAs<CacheGraph>(FileName, memoryMapped, func);
+		if (NodeIdSize == sizeof(int64) && OffsetSize == sizeof(int64))
+			return FromFileAs<LargeCacheGraph>(FileName, memoryMapped, func);
+		throw std::runtime_error("Unsupported index widths in " + FileName);
+	}
+
+private:
+	template<typename GraphT, typename ListId, typename Function>
+	static typename Function::result_type FromListsAs(
+			const std::vector<int64>& NodeOffsets,
+			const std::vector<ListId>& Neighbours,
+			const std::vector<double>* weights, bool directed,
+			const Function& func) {
+		GraphT graph(directed);
+		if (weights != NULL)
+			graph.Assign(NodeOffsets, Neighbours, *weights);
+		else
+			graph.Assign(NodeOffsets, Neighbours);
+		return func(graph);
+	}
+
+	template<typename GraphT, typename Function>
+	static typename Function::result_type FromFileAs(
+			const std::string& FileName, bool memoryMapped,
+			const Function& func) {
+		GraphT graph;
+		bool loaded =
+				memoryMapped ?
+						graph.MapFromFile(FileName) :
+						graph.LoadFromFile(FileName);
+		if (!loaded)
+			throw std::runtime_error("Failed to load the graph from " + FileName);
+		return func(graph);
+	}
+};
+
+#endif /* INCLUDES_CACHEGRAPHDISPATCH_H_ */
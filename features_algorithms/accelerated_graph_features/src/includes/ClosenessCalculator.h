@@ -0,0 +1,35 @@
+/*
+ * ClosenessCalculator.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDES_CLOSENESSCALCULATOR_H_
+#define INCLUDES_CLOSENESSCALCULATOR_H_
+
+#include "FeatureCalculator.h"
+#include "DistanceUtils.h"
+#include <vector>
+
+/*
+ The closeness centrality of every node as in networkx: (r - 1) / (the sum of the distances to the
+ node from the r - 1 other nodes that reach it), scaled by (r - 1) / (N - 1) (Wasserman and
+ Faust's version for graphs that aren't connected), and 0 for a node no other node reaches.
+ The distances to every node come from a traversal from it in the inverse graph: a BFS, or with
+ weights DistanceUtils::Dijkstra by the weights of the graph. The nodes are spread over the
+ threads, every thread with its own workspace.
+ */
+template<typename GraphT>
+class ClosenessCalculatorT: public FeatureCalculator<std::vector<double>*, GraphT> {
+public:
+	ClosenessCalculatorT(bool weighted = false);
+	virtual std::vector<double>* Calculate();
+	virtual ~ClosenessCalculatorT();
+
+private:
+	bool weighted;
+};
+
+typedef ClosenessCalculatorT<CacheGraph> ClosenessCalculator;
+
+#endif /* INCLUDES_CLOSENESSCALCULATOR_H_ */
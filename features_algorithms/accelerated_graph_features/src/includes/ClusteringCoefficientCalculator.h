@@ -3,21 +3,48 @@
 #include "FeatureCalculator.h"
 
 /*
-	Calculate the average clustering coefficient of a network.
-	We assume the network to be UNDIRECTED
+	Calculate the clustering coefficients of a network, for a graph of any of the CacheGraph
+	index widths.
+	The triangles of every node are counted once (see CacheGraphT::CountTriangles), and from them:
+		- the local clustering coefficient of every node (0 for nodes with less than two neighbors)
+		- the average clustering coefficient, which Calculate returns
+		- the transitivity, the fraction of the connected triples of nodes that are triangles
+	For a directed or weighted network the local clustering coefficients are instead Fagiolo's
+	and Onnela's (see CacheGraphT::ComputeClustering), like networkx, and the directed variants are
+	kept too. The transitivity is always that of the undirected, unweighted network.
 */
-class ClusteringCoefficientCalculator :
-	public FeatureCalculator<float>
+template<typename GraphT>
+class ClusteringCoefficientCalculatorT :
+	public FeatureCalculator<float, GraphT>
 {
 public:
-	ClusteringCoefficientCalculator();
+	ClusteringCoefficientCalculatorT();
 	virtual float Calculate();
-	
+
+	// The results of the last Calculate
+	const std::vector<float>& GetLocalClustering() const {
+		return localClustering;
+	}
+	// For an undirected network all of the types are the local clustering coefficients
+	const std::vector<float>& GetLocalClustering(ClusteringType type) const {
+		return variants.empty() ? localClustering : variants[type];
+	}
+	const std::vector<int64>& GetTriangles() const {
+		return triangles;
+	}
+	float GetTransitivity() const {
+		return transitivity;
+	}
+
 	virtual bool checkGPUEnabled(){
 		return false;
 	};
-	virtual ~ClusteringCoefficientCalculator();
+	virtual ~ClusteringCoefficientCalculatorT();
 private:
-	float LocalClusteringCoefficient(unsigned int i, unsigned int begin_offset, unsigned int end_offset, const unsigned int * neighborList);
+	std::vector<int64> triangles;
+	std::vector<float> localClustering;
+	std::vector<std::vector<float> > variants;
+	float transitivity;
 };
 
+typedef ClusteringCoefficientCalculatorT<CacheGraph> ClusteringCoefficientCalculator;
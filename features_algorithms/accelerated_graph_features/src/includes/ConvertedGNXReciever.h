@@ -15,6 +15,7 @@
 
 #include "stdafx.h"
 #include "CacheGraph.h"
+#include "CacheGraphDispatch.h"
 
 using namespace boost::python;
 
@@ -26,19 +27,54 @@ using namespace boost::python;
   	  	  	  	  deleted alongside to converter at the end of the converter's scope.
   	  	  	  	  This will usually occur at the end of the wrapper function (that is exposed to Python)
   	  	  	  	  and so the graph will be cleaned automatically at the end of the calculation.
+  If the converted graph has an "ordering" (see NodeOrdering), the nodes are relabeled for cache
+  locality as soon as the graph is recieved, and the results of the calculators should be passed
+  through toOriginalOrder before they are returned.
+  The CacheGraph is only built when it is first requested. Calculators that support several index
+  widths should use dispatch instead, which builds the graph in the narrowest widths that fit it.
+  A graph of 4G nodes or more keeps its neighbor list in 64 bit IDs, and can only be dispatched
+  (into a LargeCacheGraph); it can't be reordered or built as a CacheGraph.
  */
 class ConvertedGNXReciever {
 public:
 	ConvertedGNXReciever(dict converted_graph);
 //	ConvertedGNXReciever(dict converted_graph,const char* saveGraph);
 //	ConvertedGNXReciever(const char* loadFileName);
-	const CacheGraph* getCacheGraph(){return mGraph;};
+	const CacheGraph* getCacheGraph();
+	template<typename Function>
+	typename Function::result_type dispatch(const Function& func) const {
+		if (largeNeighbors != NULL)
+			return CacheGraphDispatch::FromLists(*offsets, *largeNeighbors,
+					withWeights ? weights : NULL, directed, func);
+		return CacheGraphDispatch::FromLists(*offsets, *neighbors,
+				withWeights ? weights : NULL, directed, func);
+	}
+	template<typename T>
+	std::vector<T> toOriginalOrder(const std::vector<T>& values) const {
+		if (newIds == NULL)
+			return values;
+		return CacheGraph::ToOriginalOrder(values, *newIds);
+	}
+	// Map a node ID between the original and the relabeled graph (throws out_of_range for a bad ID)
+	unsigned int toNewId(unsigned int node) const {
+		return newIds == NULL ? node : newIds->at(node);
+	}
+	unsigned int toOriginalId(unsigned int node) const {
+		return originalIds == NULL ? node : originalIds->at(node);
+	}
 	virtual ~ConvertedGNXReciever();
 
 private:
+	void reorder(NodeOrdering ordering);
+
 	std::vector<int64>* offsets;
 	std::vector<unsigned int>* neighbors;
+	// The neighbor list of a graph with too many nodes for 32 bit IDs, instead of neighbors
+	std::vector<int64>* largeNeighbors;
 	std::vector<double>* weights;
+	bool withWeights, directed;
+	std::vector<unsigned int>* newIds;
+	std::vector<unsigned int>* originalIds;
 	CacheGraph* mGraph;
 
 
@@ -1,16 +1,331 @@
 #ifndef DISTANCE_UTILS_H_
 #define DISTANCE_UTILS_H_
 #include "CacheGraph.h"
-#include "fiboqueue.h"
+#include "PriorityQueues.h"
+#include <algorithm>
+#include <limits>
 #include <list>
+#include <stdexcept>
 #include <vector>
 #include <limits.h>
 
+/*
+ The state of a BFS (see DistanceUtils::Bfs), kept between calls so that a workspace that is
+ reused for many sources of the same graph allocates nothing after the first one.
+ A workspace may only be used by one thread at a time.
+ */
+template<typename GraphT>
+class BfsWorkspaceT {
+public:
+	typedef typename GraphT::node_type NodeId;
+	static const unsigned int UNREACHABLE = UINT_MAX;
+
+	// The distance of every node from the last source, UNREACHABLE for the nodes it doesn't reach
+	const std::vector<unsigned int>& GetDistances() const {
+		return m_Distances;
+	}
+	// The nodes the last BFS reached by their distance: the nodes at distance d are
+	// GetReached()[GetLevels()[d]] up to GetReached()[GetLevels()[d + 1]]
+	const NodeId* GetReached() const {
+		return m_Order.data();
+	}
+	int64 GetNumberOfReached() const {
+		return m_Levels.empty() ? 0 : m_Levels.back();
+	}
+	const std::vector<int64>& GetLevels() const {
+		return m_Levels;
+	}
+
+private:
+	friend class DistanceUtils;
+	std::vector<unsigned int> m_Distances;
+	std::vector<NodeId> m_Order;
+	std::vector<int64> m_Levels;
+	// A bit for every node of the frontier, while the BFS goes bottom up
+	std::vector<int64> m_Frontier;
+};
+
+template<typename GraphT>
+const unsigned int BfsWorkspaceT<GraphT>::UNREACHABLE;
+
+typedef BfsWorkspaceT<CacheGraph> BfsWorkspace;
+
+/*
+ The state of a multi source BFS (see DistanceUtils::MultiSourceBfs), reused like BfsWorkspaceT.
+ Every node has a bitset of the sources of the batch in each of seen, visit and next, of
+ m_Words words.
+ */
+template<typename GraphT>
+class MultiSourceBfsWorkspaceT {
+public:
+	typedef typename GraphT::node_type NodeId;
+	MultiSourceBfsWorkspaceT() :
+			m_Words(0) {
+	}
+
+private:
+	friend class DistanceUtils;
+	unsigned int m_Words;
+	std::vector<int64> m_Seen, m_Visit, m_Next;
+	// The nodes of the current and of the next level, and all of the nodes that were seen
+	std::vector<NodeId> m_Frontier, m_NextFrontier, m_Reached;
+};
+
+typedef MultiSourceBfsWorkspaceT<CacheGraph> MultiSourceBfsWorkspace;
+
+/*
+ The state of Dijkstra's algorithm (see DistanceUtils::Dijkstra), reused like BfsWorkspaceT.
+ */
+template<typename GraphT>
+class DijkstraWorkspaceT {
+public:
+	typedef typename GraphT::node_type NodeId;
+	DijkstraWorkspaceT() :
+			m_NumberOfReached(0), m_WeightsOf(NULL), m_IntegerWeights(false) {
+	}
+
+	// The distance of every node from the last source, infinity for the nodes it doesn't reach
+	const std::vector<double>& GetDistances() const {
+		return m_Distances;
+	}
+	// The nodes the last source reached, by their distance
+	const NodeId* GetReached() const {
+		return m_Order.data();
+	}
+	int64 GetNumberOfReached() const {
+		return m_NumberOfReached;
+	}
+
+private:
+	friend class DistanceUtils;
+	std::vector<double> m_Distances;
+	std::vector<NodeId> m_Order;
+	int64 m_NumberOfReached;
+	IndexedDaryHeap<double, NodeId> m_Heap;
+	RadixHeap<NodeId> m_RadixHeap;
+	// The weights that were last checked, and whether they are all integers
+	const double* m_WeightsOf;
+	bool m_IntegerWeights;
+};
+
+typedef DijkstraWorkspaceT<CacheGraph> DijkstraWorkspace;
+
 class DistanceUtils
 {
 public:
+	/*
+	 The distances of all of the nodes from src, in a workspace (see BfsWorkspaceT).
+	 The BFS is direction optimizing: a level with few edges leaving it is expanded top down, by
+	 the out neighbors of its nodes, and a large one bottom up, with every node that wasn't reached
+	 yet looking for a neighbor in the level (through the inverse graph, for a directed graph).
+	 */
+	template<typename GraphT>
+	static void Bfs(const GraphT& graph, typename GraphT::node_type src,
+			BfsWorkspaceT<GraphT>& workspace);
+
+	/*
+	 A BFS from up to MAX_MULTI_SOURCES sources at once, where every node keeps the set of
+	 sources that reached it as a bitset, so that a neighbor list that is read once moves all of
+	 the sources of the node to the neighbor (Then et al., "The more the merrier: efficient
+	 multi-source graph traversal").
+	 The distances aren't kept: for every level, visit(level, node, reached) is called for every
+	 node that some sources reached at that distance (the sources themselves at level 0), where
+	 reached is the bitset of the indices of those sources in sources, (NumberOfSources + 63) / 64
+	 words of 64 bits. A node is passed once per level, in no particular order.
+	 */
+	template<typename GraphT, typename Visitor>
+	static void MultiSourceBfs(const GraphT& graph,
+			const typename GraphT::node_type* sources, unsigned int NumberOfSources,
+			MultiSourceBfsWorkspaceT<GraphT>& workspace, Visitor visit);
+	static const unsigned int MAX_MULTI_SOURCES = 512;
+	/*
+	 The number of nodes every source reaches at every distance, by MultiSourceBfs: counts is
+	 replaced with a row of NumberOfSources counts for every distance, so the number of nodes
+	 sources[i] reaches at distance d is counts[d * NumberOfSources + i]. Returns the number of
+	 distances (rows).
+	 */
+	template<typename GraphT>
+	static unsigned int MultiSourceLevelCounts(const GraphT& graph,
+			const typename GraphT::node_type* sources, unsigned int NumberOfSources,
+			MultiSourceBfsWorkspaceT<GraphT>& workspace, std::vector<int64>& counts);
+
+	/*
+	 The weighted distances of all of the nodes from src (by CacheGraph::GetWeights, or 1 for every
+	 edge of an unweighted graph), in a workspace (see DijkstraWorkspaceT). The weights must not
+	 be negative.
+	 Integer weights (checked once for every weights array a workspace sees) are run with a radix
+	 heap, and other weights with a 4-ary heap with decrease-key.
+	 */
+	template<typename GraphT>
+	static void Dijkstra(const GraphT& graph, typename GraphT::node_type src,
+			DijkstraWorkspaceT<GraphT>& workspace);
+	/*
+	 The weighted distances from src by delta-stepping (Meyer and Sanders, "Delta-stepping: a
+	 parallelizable shortest path algorithm"), for a single source on a large graph: the nodes are
+	 kept in buckets of distances of width delta, and the edges of the nodes of the lowest bucket
+	 are relaxed in parallel, the light ones (up to delta) until the bucket empties, and then the
+	 heavy ones. A delta of 0 picks the average weight. The nodes src doesn't reach get infinity.
+	 */
+	template<typename GraphT>
+	static void DeltaStepping(const GraphT& graph, typename GraphT::node_type src, double delta,
+			std::vector<double>& distances);
+
+	// The distances from src, where the nodes src doesn't reach get 0
 	static std::vector<unsigned int> BfsSingleSourceShortestPath(const CacheGraph * g,unsigned int src);
+	// The weighted distances from src (see Dijkstra), where the nodes src doesn't reach get INT_MAX
 	static std::vector<float> DijkstraSingleSourceShortestPath(const CacheGraph * g, int src);
+
+	// A level is expanded bottom up once the edges leaving it are more than the unexplored edges
+	// over BOTTOM_UP_EDGES_RATIO, and top down again once it has less than the nodes over
+	// TOP_DOWN_NODES_RATIO (the ratios of Beamer et al., "Direction-optimizing breadth-first search")
+	static const int64 BOTTOM_UP_EDGES_RATIO = 14;
+	static const int64 TOP_DOWN_NODES_RATIO = 24;
+
+private:
+	// Checks the weights of the graph for the workspace, if it hasn't seen them yet
+	template<typename GraphT>
+	static void CheckWeights(const GraphT& graph, DijkstraWorkspaceT<GraphT>& workspace);
+
+	template<unsigned int Words, typename GraphT, typename Visitor>
+	static void MultiSourceBfsOf(const GraphT& graph,
+			const typename GraphT::node_type* sources, unsigned int NumberOfSources,
+			MultiSourceBfsWorkspaceT<GraphT>& workspace, Visitor& visit);
 };
 
+/*
+ The bitsets are rounded up to 1, 2, 4 or 8 words, so that the loops over their words have a
+ fixed length.
+ */
+template<typename GraphT, typename Visitor>
+void DistanceUtils::MultiSourceBfs(const GraphT& graph,
+		const typename GraphT::node_type* sources, unsigned int NumberOfSources,
+		MultiSourceBfsWorkspaceT<GraphT>& workspace, Visitor visit)
+{
+	if (NumberOfSources > MAX_MULTI_SOURCES)
+		throw std::invalid_argument("Too many sources for a multi source BFS");
+	for (unsigned int i = 0; i < NumberOfSources; i++)
+		if (sources[i] >= graph.GetNumberOfNodes())
+			throw std::out_of_range("Source out of range");
+	if (NumberOfSources <= 64)
+		MultiSourceBfsOf<1>(graph, sources, NumberOfSources, workspace, visit);
+	else if (NumberOfSources <= 128)
+		MultiSourceBfsOf<2>(graph, sources, NumberOfSources, workspace, visit);
+	else if (NumberOfSources <= 256)
+		MultiSourceBfsOf<4>(graph, sources, NumberOfSources, workspace, visit);
+	else
+		MultiSourceBfsOf<8>(graph, sources, NumberOfSources, workspace, visit);
+}
+
+/*
+ Every level, the bitset of sources that reached every node of the frontier is or'ed into next of
+ each of its neighbors, and then the sources a neighbor hadn't seen yet are its part of the next
+ frontier. Only the nodes of the frontiers are touched, and the workspace is reset by the nodes
+ that were seen.
+ */
+template<unsigned int Words, typename GraphT, typename Visitor>
+void DistanceUtils::MultiSourceBfsOf(const GraphT& graph,
+		const typename GraphT::node_type* sources, unsigned int NumberOfSources,
+		MultiSourceBfsWorkspaceT<GraphT>& workspace, Visitor& visit)
+{
+	typedef typename GraphT::node_type NodeId;
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	std::vector<int64>& seen = workspace.m_Seen;
+	std::vector<int64>& current = workspace.m_Visit;
+	std::vector<int64>& next = workspace.m_Next;
+	std::vector<NodeId>& frontier = workspace.m_Frontier;
+	std::vector<NodeId>& nextFrontier = workspace.m_NextFrontier;
+	std::vector<NodeId>& reached = workspace.m_Reached;
+	//the bitsets of a node start at its ID times Words
+	auto of = [](NodeId node) {
+		return static_cast<int64>(node) * Words;
+	};
+	if (workspace.m_Words != Words || seen.size() != static_cast<size_t>(of(numOfNodes))) {
+		workspace.m_Words = Words;
+		seen.assign(of(numOfNodes), 0);
+		current.assign(of(numOfNodes), 0);
+		next.assign(of(numOfNodes), 0);
+	} else {
+		for (NodeId node : reached)
+			std::fill(seen.begin() + of(node), seen.begin() + of(node) + Words, 0);
+	}
+	reached.clear();
+	frontier.clear();
+
+	for (unsigned int i = 0; i < NumberOfSources; i++) {
+		const NodeId src = sources[i];
+		if (std::all_of(seen.begin() + of(src), seen.begin() + of(src) + Words,
+				[](int64 word) {return word == 0;})) {
+			reached.push_back(src);
+			frontier.push_back(src);
+		}
+		seen[of(src) + i / 64] |= 1ULL << (i % 64);
+		current[of(src) + i / 64] |= 1ULL << (i % 64);
+	}
+	for (NodeId src : frontier)
+		visit(0u, src, static_cast<const int64*>(&current[of(src)]));
+
+	for (unsigned int level = 1; !frontier.empty(); level++) {
+		nextFrontier.clear();
+		for (NodeId u : frontier) {
+			const int64* sourcesOfU = &current[of(u)];
+			for (NodeId p : graph.neighbors(u)) {
+				int64* nextOfP = &next[of(p)];
+				int64 wasEmpty = 0;
+				for (unsigned int w = 0; w < Words; w++) {
+					wasEmpty |= nextOfP[w];
+					nextOfP[w] |= sourcesOfU[w];
+				}
+				if (wasEmpty == 0)
+					nextFrontier.push_back(p);
+			}
+		}
+		for (NodeId u : frontier)
+			std::fill(current.begin() + of(u), current.begin() + of(u) + Words, 0);
+
+		frontier.clear();
+		for (NodeId p : nextFrontier) {
+			int64* nextOfP = &next[of(p)];
+			int64* seenOfP = &seen[of(p)];
+			int64* currentOfP = &current[of(p)];
+			int64 isNew = 0, wasSeen = 0;
+			for (unsigned int w = 0; w < Words; w++) {
+				const int64 fresh = nextOfP[w] & ~seenOfP[w];
+				wasSeen |= seenOfP[w];
+				isNew |= fresh;
+				seenOfP[w] |= fresh;
+				currentOfP[w] = fresh;
+				nextOfP[w] = 0;
+			}
+			if (isNew == 0)
+				continue;
+			if (wasSeen == 0)
+				reached.push_back(p);
+			frontier.push_back(p);
+			visit(level, p, static_cast<const int64*>(currentOfP));
+		}
+	}
+}
+
+template<typename GraphT>
+unsigned int DistanceUtils::MultiSourceLevelCounts(const GraphT& graph,
+		const typename GraphT::node_type* sources, unsigned int NumberOfSources,
+		MultiSourceBfsWorkspaceT<GraphT>& workspace, std::vector<int64>& counts)
+{
+	const unsigned int words = (NumberOfSources + 63) / 64;
+	unsigned int numOfLevels = 0;
+	counts.clear();
+	MultiSourceBfs(graph, sources, NumberOfSources, workspace,
+			[&](unsigned int level, typename GraphT::node_type, const int64* reached) {
+				if (level >= numOfLevels) {
+					numOfLevels = level + 1;
+					counts.resize(static_cast<size_t>(numOfLevels) * NumberOfSources, 0);
+				}
+				int64* row = &counts[static_cast<size_t>(level) * NumberOfSources];
+				for (unsigned int w = 0; w < words; w++)
+					for (int64 bits = reached[w]; bits != 0; bits &= bits - 1)
+						row[64 * w + __builtin_ctzll(bits)]++;
+			});
+	return numOfLevels;
+}
+
 #endif
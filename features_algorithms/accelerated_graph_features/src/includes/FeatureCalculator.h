@@ -6,14 +6,19 @@
 
 using namespace std;
 
-template<typename T> class FeatureCalculator
+/*
+ The base of all the feature calculators.
+ GraphT is the CacheGraph instantiation the calculator works on; calculators that support several
+ index widths are templated on it, and are given the narrowest graph by CacheGraphDispatch.
+ */
+template<typename T, typename GraphT = CacheGraph> class FeatureCalculator
 {
 public:
 	FeatureCalculator();
 	virtual T Calculate() = 0;
 	virtual ~FeatureCalculator();
-	virtual const CacheGraph* getGraph();
-	virtual void setGraph(const CacheGraph* graph);
+	virtual const GraphT* getGraph();
+	virtual void setGraph(const GraphT* graph);
 
 
 protected:
@@ -21,39 +26,39 @@ protected:
 	bool checkGPUEnabled(){
 		return false;
 	};
-	const CacheGraph* mGraph;
+	const GraphT* mGraph;
 
 private:
 	bool isGPUEnabled;
 };
 
-template<class T>
-FeatureCalculator<T>::FeatureCalculator():
+template<class T, class GraphT>
+FeatureCalculator<T, GraphT>::FeatureCalculator():
 	mGraph(NULL),isGPUEnabled(false)
 {
 
 }
 
-template<typename T>
-void FeatureCalculator<T>::setGraph(const CacheGraph* graph)
+template<typename T, typename GraphT>
+void FeatureCalculator<T, GraphT>::setGraph(const GraphT* graph)
 {
 	this->mGraph = graph;
 	init();
 }
 
-template<typename T>
-void FeatureCalculator<T>::init()
+template<typename T, typename GraphT>
+void FeatureCalculator<T, GraphT>::init()
 {
 	isGPUEnabled = checkGPUEnabled();
 }
 
-template<class T>
-FeatureCalculator<T>::~FeatureCalculator()
+template<class T, class GraphT>
+FeatureCalculator<T, GraphT>::~FeatureCalculator()
 {
 }
 
-template<typename T>
-const CacheGraph* FeatureCalculator<T>::getGraph()
+template<typename T, typename GraphT>
+const GraphT* FeatureCalculator<T, GraphT>::getGraph()
 {
 	return this->mGraph;
 }
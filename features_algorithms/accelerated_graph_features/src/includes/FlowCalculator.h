@@ -11,34 +11,50 @@
 #include "FeatureCalculator.h"
 #include "DistanceUtils.h"
 #include <vector>
-#include <map>
-#include <set>
 #include <algorithm>
 
-
-class FlowCalculator: public FeatureCalculator<std::vector<double>*>{
+/*
+ The flow of every node u: the sum of udist(u, v) / dist(u, v) over the nodes v that u reaches,
+ where udist is the distance in the undirected graph, over b_u, the number of nodes that u reaches
+ or that reach u. Nodes whose b_u over the largest b_u is at most the threshold get 0.
+ Every source is handled by one traversal step on its own thread: a BFS in the undirected graph,
+ then a BFS in the graph that sums the ratios and marks the nodes it reaches in a bitset, and then
+ a BFS in the inverse graph that counts the nodes that reach the source and aren't marked.
+ Every thread reuses its workspaces, so the memory is O(N) per thread.
+ With pivot sampling (see PivotSampling), the ratios and b_u are estimated from the pivots alone,
+ by the same three BFS traversals from every pivot, and GetConfidenceIntervals has the half widths
+ of the 95% confidence intervals of the features (0 for the nodes under the threshold).
+ */
+template<typename GraphT>
+class FlowCalculatorT: public FeatureCalculator<std::vector<double>*, GraphT>{
 public:
-	FlowCalculator(double threshold=0);
+	FlowCalculatorT(double threshold=0);
 	virtual std::vector<double>* Calculate();
 
-	virtual ~FlowCalculator();
+	virtual ~FlowCalculatorT();
+
+	// Estimate the features from NumberOfPivots pivots instead (0 goes back to the exact features)
+	void SetPivotSampling(unsigned int NumberOfPivots, unsigned int seed,
+			bool stratified);
+	const std::vector<double>& GetConfidenceIntervals() const {
+		return confidenceIntervals;
+	}
 
 private:
-	virtual void init();
-	void CalcDists();
-	void CountReachables();
-	void printVars();
+	std::vector<double>* CalculateApproximate();
 
 	double threshold;
-	unsigned int numOfNodes;
-
-	std::vector<double>* features;
 
-	CacheGraph inverse,undirectedGraph;
-	std::vector<std::vector<unsigned int>*> directed_dists;
-	std::vector<std::vector<unsigned int>*> undirected_dists;
-	std::vector<unsigned int> b_u;
+	// the number of nodes every node reaches or is reached from, and the sum of its ratios
+	std::vector<int64> b_u;
+	std::vector<double> ratios;
 
+	unsigned int numOfPivots;
+	unsigned int seed;
+	bool stratified;
+	std::vector<double> confidenceIntervals;
 };
 
+typedef FlowCalculatorT<CacheGraph> FlowCalculator;
+
 #endif /* FEATURES_FLOWCALCULATOR_H_ */
@@ -44,7 +44,8 @@ private:
 	virtual void init();
 
 
-    CacheGraph fullGraph;
+    // the undirected view of the graph (owned by the graph)
+    const CacheGraph* fullGraph;
 
 	//Either 3 or 4
 	unsigned int level;
@@ -60,8 +61,8 @@ private:
 	std::vector<int>* allMotifs;
 	//the index in which we remove the node from the graph. Basically, from this index on the node doesen't exist.
 	std::vector<unsigned int>* removalIndex;
-	//the nodes, sorted in descending order by the degree.
-	std::vector<unsigned int>* sortedNodesByDegree;
+	//the nodes, sorted in descending order by the degree (owned by the graph).
+	const std::vector<unsigned int>* sortedNodesByDegree;
 
 	//the results, node -> {motif-> motif_count}
 	vector<vector<unsigned int>*>* features;
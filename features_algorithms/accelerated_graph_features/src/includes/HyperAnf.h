@@ -0,0 +1,109 @@
+/*
+ * HyperAnf.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDES_HYPERANF_H_
+#define INCLUDES_HYPERANF_H_
+
+#include "stdafx.h"
+#include "ParallelUtils.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/*
+ The neighborhood function of every node by HyperANF (Boldi, Rosa and Vigna, "HyperANF:
+ approximating the neighbourhood function of very large graphs on a budget"): every node keeps a
+ HyperLogLog counter of the nodes it reaches, and in iteration d the counter of a node becomes
+ the register-wise maximum of its own and its neighbors' counters, so that it counts the nodes
+ within distance d of the node. This takes O(E) per iteration and O(N) counters of 2^Log2Registers
+ registers of a byte, whatever the number of distances, and the relative standard error of every
+ count is about 1.04 / sqrt(2^Log2Registers).
+ The counters count the nodes a node reaches in the graph; pass graph.inverse() to count the nodes
+ that reach it.
+ */
+class HyperAnf {
+public:
+	/*
+	 visit(d, balls) is called for d = 0, 1, ... up to the largest distance, where balls[v] is the
+	 estimated number of nodes within distance d of v (including v). Only the counters of the
+	 nodes with a neighbor whose counter changed in the last iteration are merged, and the
+	 iterations stop once no counter changes. Returns the number of iterations that changed a
+	 counter.
+	 */
+	template<typename GraphT, typename Visitor>
+	static unsigned int BallSizes(const GraphT& graph, unsigned int Log2Registers,
+			unsigned int seed, Visitor visit);
+
+	// The counter of a single element
+	static void Initialize(unsigned char* registers, unsigned int Log2Registers, int64 element,
+			unsigned int seed);
+	// The HyperLogLog estimate of the size of a counter, with linear counting for small sizes
+	static double Estimate(const unsigned char* registers, unsigned int NumberOfRegisters);
+	// The register-wise maximum of two counters into the first, returns whether it changed
+	static bool Merge(unsigned char* to, const unsigned char* from,
+			unsigned int NumberOfRegisters);
+
+	static const unsigned int MIN_LOG2_REGISTERS = 4;
+	static const unsigned int MAX_LOG2_REGISTERS = 16;
+	static const unsigned int DEFAULT_LOG2_REGISTERS = 6;
+	// The nodes every thread merges at a time
+	static const int64 MERGE_GRAIN = 256;
+};
+
+template<typename GraphT, typename Visitor>
+unsigned int HyperAnf::BallSizes(const GraphT& graph, unsigned int Log2Registers,
+		unsigned int seed, Visitor visit) {
+	typedef typename GraphT::node_type NodeId;
+	if (Log2Registers < MIN_LOG2_REGISTERS || Log2Registers > MAX_LOG2_REGISTERS)
+		throw std::invalid_argument("Unsupported number of HyperLogLog registers");
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	const unsigned int numOfRegisters = 1u << Log2Registers;
+	//the counters of node v start at v times the number of registers
+	std::vector<unsigned char> current(static_cast<size_t>(numOfNodes) * numOfRegisters, 0);
+	std::vector<unsigned char> next(current.size());
+	std::vector<double> balls(numOfNodes);
+	std::vector<char> changed(numOfNodes, 1), nextChanged(numOfNodes, 0);
+	ParallelUtils::ParallelFor(0, numOfNodes, MERGE_GRAIN,
+			[&](unsigned int, int64 node) {
+				unsigned char* registers = &current[static_cast<size_t>(node) * numOfRegisters];
+				Initialize(registers, Log2Registers, node, seed);
+				balls[node] = Estimate(registers, numOfRegisters);
+			});
+	visit(0u, static_cast<const std::vector<double>&>(balls));
+
+	std::vector<char> threadChanged(ParallelUtils::GetNumberOfThreads());
+	unsigned int distance = 0;
+	for (;;) {
+		std::fill(threadChanged.begin(), threadChanged.end(), 0);
+		ParallelUtils::ParallelFor(0, numOfNodes, MERGE_GRAIN,
+				[&](unsigned int t, int64 node) {
+					unsigned char* registers = &next[static_cast<size_t>(node) * numOfRegisters];
+					std::memcpy(registers, &current[static_cast<size_t>(node) * numOfRegisters],
+							numOfRegisters);
+					bool modified = false;
+					//a neighbor that didn't change was already merged in the last iteration
+					for (NodeId neighbor : graph.neighbors(static_cast<NodeId>(node)))
+						if (changed[neighbor])
+							modified |= Merge(registers,
+									&current[static_cast<size_t>(neighbor) * numOfRegisters],
+									numOfRegisters);
+					nextChanged[node] = modified;
+					if (modified) {
+						balls[node] = Estimate(registers, numOfRegisters);
+						threadChanged[t] = 1;
+					}
+				});
+		if (std::find(threadChanged.begin(), threadChanged.end(), 1) == threadChanged.end())
+			break;
+		current.swap(next);
+		changed.swap(nextChanged);
+		visit(++distance, static_cast<const std::vector<double>&>(balls));
+	}
+	return distance;
+}
+
+#endif /* INCLUDES_HYPERANF_H_ */
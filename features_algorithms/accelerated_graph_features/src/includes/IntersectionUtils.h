@@ -0,0 +1,65 @@
+/*
+ * IntersectionUtils.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDES_INTERSECTIONUTILS_H_
+#define INCLUDES_INTERSECTIONUTILS_H_
+
+#include "stdafx.h"
+
+/*
+ Intersection of two strictly increasing lists (such as the neighbor lists of a CacheGraph).
+ Count returns the size of the intersection, and Intersect also writes its elements, in increasing
+ order, to out (which must have room for the shorter list).
+ When one list is much longer than the other, the short list's elements are searched for in the
+ long one (galloping). Otherwise the lists are merged, with AVX-512 or AVX2 for 32 bit elements
+ when the CPU supports them, and with a scalar merge otherwise.
+ Count and Intersect are instantiated for unsigned int and int64.
+ */
+class IntersectionUtils {
+public:
+	enum Kernel {
+		KERNEL_SCALAR = 0, KERNEL_AVX2, KERNEL_AVX512
+	};
+
+	template<typename T>
+	static int64 Count(const T* a, int64 SizeA, const T* b, int64 SizeB);
+	template<typename T>
+	static int64 Intersect(const T* a, int64 SizeA, const T* b, int64 SizeB,
+			T* out);
+
+	/*
+	 The merge kernel in use. By default it's the widest one the CPU supports; setting it is
+	 meant for benchmarks and comparing the kernels, and must not be done while other threads
+	 intersect. A kernel the CPU doesn't support is ignored.
+	 */
+	static Kernel GetKernel();
+	static void SetKernel(Kernel kernel);
+
+	// Above this ratio between the sizes of the lists, galloping is used instead of merging.
+	static const int64 GALLOP_RATIO = 32;
+
+private:
+	template<typename T, bool Store>
+	static int64 Run(const T* a, int64 SizeA, const T* b, int64 SizeB, T* out);
+	template<typename T, bool Store>
+	static int64 Merge(const T* a, int64 SizeA, const T* b, int64 SizeB,
+			T* out);
+	template<typename T, bool Store>
+	static int64 Gallop(const T* small, int64 SizeSmall, const T* large,
+			int64 SizeLarge, T* out);
+
+	// The vector kernels only count when out is NULL
+	static int64 MergeAVX2(const unsigned int* a, int64 SizeA,
+			const unsigned int* b, int64 SizeB, unsigned int* out);
+	static int64 MergeAVX512(const unsigned int* a, int64 SizeA,
+			const unsigned int* b, int64 SizeB, unsigned int* out);
+	static bool Supported(Kernel kernel);
+	static Kernel DetectKernel();
+
+	static Kernel s_Kernel;
+};
+
+#endif /* INCLUDES_INTERSECTIONUTILS_H_ */
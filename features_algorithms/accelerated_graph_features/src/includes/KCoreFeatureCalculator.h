@@ -11,11 +11,22 @@
 #include <vector>
 #include "FeatureCalculator.h"
 
-class KCoreFeatureCalculator: public FeatureCalculator<std::vector<unsigned short>> {
+/*
+ The k-core calculator, for a graph of any of the CacheGraph index widths.
+ Small graphs are decomposed by the sequential linear time algorithm, and graphs of at least
+ PARALLEL_EDGES edges by parallel peeling (see CacheGraphT::ComputeKCore).
+ */
+template<typename GraphT>
+class KCoreFeatureCalculatorT: public FeatureCalculator<
+		std::vector<typename GraphT::node_type>, GraphT> {
 public:
-	KCoreFeatureCalculator();
-	virtual std::vector<unsigned short> Calculate();
-	virtual ~KCoreFeatureCalculator();
+	KCoreFeatureCalculatorT();
+	virtual std::vector<typename GraphT::node_type> Calculate();
+	virtual ~KCoreFeatureCalculatorT();
+
+	static const int64 PARALLEL_EDGES = 1 << 20;
 };
 
+typedef KCoreFeatureCalculatorT<CacheGraph> KCoreFeatureCalculator;
+
 #endif /* FEATURES_KCOREFEATURECALCULATOR_H_ */
@@ -0,0 +1,73 @@
+/*
+ * KCoreMaintenance.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDES_KCOREMAINTENANCE_H_
+#define INCLUDES_KCOREMAINTENANCE_H_
+
+#include "stdafx.h"
+#include "CacheGraph.h"
+#include <utility>
+#include <vector>
+
+/*
+ Keeps the core numbers of a changing graph up to date, instead of recomputing them after every
+ change.
+ The maintenance starts from a CacheGraph (whose core numbers are computed once, as by
+ KCoreFeatureCalculator) and keeps its own copy of the adjacency, which the edge batches change.
+ Every inserted or removed edge changes the core number of some of the nodes whose core number is
+ the smaller one of its ends (K) by at most one, and only nodes that are connected to that end
+ through nodes of core number K: this subcore is traversed, and the nodes that can't keep (on
+ removal) or gain (on insertion) K neighbors of a core number of at least K are peeled
+ (the traversal algorithms of Sariyuce et al., "Streaming algorithms for k-core decomposition").
+ As in ComputeKCore, a directed graph is maintained by its total degree, and self loops are ignored.
+ Edges that are already in the graph aren't inserted again, and edges that aren't in it aren't
+ removed.
+ */
+template<typename GraphT>
+class KCoreMaintenanceT {
+public:
+	typedef typename GraphT::node_type NodeId;
+	typedef std::pair<NodeId, NodeId> Edge;
+
+	explicit KCoreMaintenanceT(const GraphT& graph);
+
+	// Both return the number of edges that were actually inserted or removed
+	int64 InsertEdges(const std::vector<Edge>& edges);
+	int64 RemoveEdges(const std::vector<Edge>& edges);
+
+	const std::vector<NodeId>& GetCores() const {
+		return m_Cores;
+	}
+	// The number of nodes the subcore traversals of the last batch visited
+	int64 GetNumberOfTouchedNodes() const {
+		return m_TouchedNodes;
+	}
+
+private:
+	bool InsertEdge(NodeId p, NodeId q);
+	bool RemoveEdge(NodeId p, NodeId q);
+	bool HasEdge(NodeId p, NodeId q) const;
+	static void RemoveOne(std::vector<NodeId>& list, NodeId node);
+	void CollectSubcore(NodeId p, NodeId q, NodeId K);
+
+	bool m_Directed;
+	// The neighbors of every node in both directions (for a directed graph, a node that is both an
+	// in and an out neighbor appears twice), and for a directed graph also the out neighbors alone
+	std::vector<std::vector<NodeId> > m_Neighbors;
+	std::vector<std::vector<NodeId> > m_OutNeighbors;
+	std::vector<NodeId> m_Cores;
+
+	// The subcore of the current edge, its nodes are marked with the current epoch
+	std::vector<NodeId> m_Subcore;
+	std::vector<unsigned int> m_Visited;
+	std::vector<NodeId> m_CandidateDegrees;
+	unsigned int m_Epoch;
+	int64 m_TouchedNodes;
+};
+
+typedef KCoreMaintenanceT<CacheGraph> KCoreMaintenance;
+
+#endif /* INCLUDES_KCOREMAINTENANCE_H_ */
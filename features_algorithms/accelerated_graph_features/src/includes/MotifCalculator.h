@@ -23,6 +23,10 @@ public:
 	MotifCalculator(int level,bool directed);
 	MotifCalculator(int level,bool directed, string motif_path);
 	virtual vector<vector<unsigned int>*>* Calculate();
+	// whether to build the graph's neighbor index for the edge checks (on by default)
+	void setUseNeighborIndex(bool use) {
+		useNeighborIndex = use;
+	}
 	virtual ~MotifCalculator();
 
 private:
@@ -38,13 +42,42 @@ private:
 	void GroupUpdater(std::vector<unsigned int> group);
 	int GetGroupNumber(std::vector<unsigned int> group);
 
+	/*
+	 The nodes visited from the current root, and the index every one of them was visited in.
+	 A node's entry only counts when its epoch is the current one, so every root starts with no
+	 visited nodes without clearing anything (all of the entries are cleared when the epoch wraps).
+	 */
+	struct Visit {
+		unsigned int epoch;
+		int index;
+	};
+	void StartVisits() {
+		if (++visitEpoch == 0) {
+			std::fill(visits.begin(), visits.end(), Visit { 0, 0 });
+			visitEpoch = 1;
+		}
+	}
+	bool Visited(unsigned int node) const {
+		return visits[node].epoch == visitEpoch;
+	}
+	void MarkVisited(unsigned int node, int index) {
+		visits[node].epoch = visitEpoch;
+		visits[node].index = index;
+	}
+	// The index the node was visited in, 0 (as the root's) if it wasn't
+	int VisitIndex(unsigned int node) const {
+		return Visited(node) ? visits[node].index : 0;
+	}
+
     string MOTIF_VARIATIONS_PATH;
-    CacheGraph fullGraph;
+    // the undirected view of the graph (owned by the graph)
+    const CacheGraph* fullGraph;
 
 	//Either 3 or 4
 	unsigned int level;
 	//The CacheGraph is always directed, so we need to specify the motif variation
 	bool directed;
+	bool useNeighborIndex;
 	//map the group num to the iso motif
 	std::map<unsigned int,int>* nodeVariations;
 
@@ -52,8 +85,11 @@ private:
 	std::vector<int>* allMotifs;
 	//the index in which we remove the node from the graph. Basically, from this index on the node doesen't exist.
 	std::vector<unsigned int>* removalIndex;
-	//the nodes, sorted in descending order by the degree.
-	std::vector<unsigned int>* sortedNodesByDegree;
+	//the nodes, sorted in descending order by the degree (owned by the graph).
+	const std::vector<unsigned int>* sortedNodesByDegree;
+
+	std::vector<Visit> visits;
+	unsigned int visitEpoch;
 
 	//the results, node -> {motif-> motif_count}
 	vector<vector<unsigned int>*>* features;
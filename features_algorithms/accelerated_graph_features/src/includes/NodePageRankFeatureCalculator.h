@@ -11,15 +11,35 @@
 #include "FeatureCalculator.h"
 #include <vector>
 
-class NodePageRankFeatureCalculator: public FeatureCalculator<std::vector<float>> {
+/*
+ The page rank calculator, for a graph of any of the CacheGraph index widths.
+ numOfIterations is the maximal number of iterations, which stop earlier when the ranks converge
+ (see CacheGraphT::ComputeNodePageRank).
+ The calculator also computes personalized page ranks for many seed sets in one pass over the
+ graph: CalculatePersonalized runs the power iteration for all of them at once, and
+ CalculatePersonalizedPush approximates them locally, which is cheaper for small seed sets
+ (see CacheGraphT::ApproximatePersonalizedPageRank).
+ */
+template<typename GraphT>
+class NodePageRankFeatureCalculatorT: public FeatureCalculator<std::vector<float>, GraphT> {
 public:
-	NodePageRankFeatureCalculator(float dumping,unsigned int numOfIterations);
+	NodePageRankFeatureCalculatorT(float dumping,unsigned int numOfIterations);
+	NodePageRankFeatureCalculatorT(float dumping, unsigned int numOfIterations,
+			double tolerance);
 	virtual std::vector<float> Calculate();
-	virtual ~NodePageRankFeatureCalculator();
+	std::vector<std::vector<float> > CalculatePersonalized(
+			const std::vector<std::vector<typename GraphT::node_type> >& seedSets);
+	std::vector<std::vector<std::pair<typename GraphT::node_type, float> > > CalculatePersonalizedPush(
+			const std::vector<std::vector<typename GraphT::node_type> >& seedSets,
+			double epsilon);
+	virtual ~NodePageRankFeatureCalculatorT();
 
 private:
 	float dumping;
 	unsigned int numOfIterations;
+	double tolerance;
 };
 
+typedef NodePageRankFeatureCalculatorT<CacheGraph> NodePageRankFeatureCalculator;
+
 #endif /* FEATURES_NODEPAGERANKFEATURECALCULATOR_H_ */
@@ -0,0 +1,145 @@
+/*
+ * ParallelUtils.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDES_PARALLELUTILS_H_
+#define INCLUDES_PARALLELUTILS_H_
+
+#include "stdafx.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+/*
+ Simple fork-join helpers for running the graph algorithms on several threads.
+ All of the functions block until the work is done, and an exception thrown by one of the
+ threads is rethrown in the calling thread.
+ */
+class ParallelUtils {
+public:
+	static unsigned int GetNumberOfThreads();
+	static void SetNumberOfThreads(unsigned int NumberOfThreads);
+	static unsigned int ThreadsForWork(int64 work);
+
+	template<typename Function>
+	static void RunThreads(unsigned int NumberOfThreads, Function func);
+	template<typename Function>
+	static void ParallelForRanges(int64 begin, int64 end, Function func);
+	template<typename Function>
+	static void ParallelFor(int64 begin, int64 end, int64 grain, Function func);
+	template<typename T>
+	static void InclusiveScan(T* values, int64 size);
+
+	// Below this amount of work (usually edges or nodes) a loop isn't worth splitting.
+	static const int64 MIN_WORK_PER_THREAD = 16384;
+
+private:
+	static unsigned int numberOfThreads;
+};
+
+/*
+ Run func(threadIndex, NumberOfThreads) on NumberOfThreads threads.
+ The calling thread runs thread 0 itself.
+ */
+template<typename Function>
+void ParallelUtils::RunThreads(unsigned int NumberOfThreads, Function func) {
+	if (NumberOfThreads <= 1) {
+		func(0u, 1u);
+		return;
+	}
+	std::vector<std::thread> threads;
+	std::vector<std::exception_ptr> errors(NumberOfThreads);
+	threads.reserve(NumberOfThreads - 1);
+	for (unsigned int t = 1; t < NumberOfThreads; t++)
+		threads.push_back(std::thread([&func, &errors, t, NumberOfThreads]() {
+			try {
+				func(t, NumberOfThreads);
+			} catch (...) {
+				errors[t] = std::current_exception();
+			}
+		}));
+	try {
+		func(0u, NumberOfThreads);
+	} catch (...) {
+		errors[0] = std::current_exception();
+	}
+	for (auto& thread : threads)
+		thread.join();
+	for (auto& error : errors)
+		if (error)
+			std::rethrow_exception(error);
+}
+
+/*
+ Split [begin, end) into one contiguous range per thread, and run
+ func(threadIndex, NumberOfThreads, rangeBegin, rangeEnd) on each of them.
+ The ranges are ordered by the thread index.
+ */
+template<typename Function>
+void ParallelUtils::ParallelForRanges(int64 begin, int64 end, Function func) {
+	unsigned int NumberOfThreads = ThreadsForWork(end - begin);
+	RunThreads(NumberOfThreads,
+			[&func, begin, end](unsigned int t, unsigned int NumberOfThreads) {
+				int64 length = end - begin;
+				func(t, NumberOfThreads, begin + length * t / NumberOfThreads,
+						begin + length * (t + 1) / NumberOfThreads);
+			});
+}
+
+/*
+ Run func(threadIndex, i) for every i in [begin, end).
+ The threads take chunks of grain indices at a time, so uneven work is balanced between them.
+ */
+template<typename Function>
+void ParallelUtils::ParallelFor(int64 begin, int64 end, int64 grain,
+		Function func) {
+	std::atomic<int64> next(begin);
+	grain = std::max<int64>(grain, 1);
+	int64 NumberOfChunks = (end - begin + grain - 1) / grain;
+	RunThreads(
+			static_cast<unsigned int>(std::max<int64>(1,
+					std::min<int64>(NumberOfChunks, GetNumberOfThreads()))),
+			[&func, &next, end, grain](unsigned int t, unsigned int) {
+				for (int64 chunk = next.fetch_add(grain); chunk < end;
+						chunk = next.fetch_add(grain))
+					for (int64 i = chunk; i < std::min(chunk + grain, end); i++)
+						func(t, i);
+			});
+}
+
+/*
+ Replace values[i] with values[0] + ... + values[i].
+ Each thread sums its own block, and then adds the total of the blocks before it.
+ */
+template<typename T>
+void ParallelUtils::InclusiveScan(T* values, int64 size) {
+	unsigned int NumberOfThreads = ThreadsForWork(size);
+	std::vector<T> BlockSums(NumberOfThreads + 1, 0);
+	RunThreads(NumberOfThreads,
+			[values, size, &BlockSums](unsigned int t,
+					unsigned int NumberOfThreads) {
+				int64 begin = size * t / NumberOfThreads;
+				int64 end = size * (t + 1) / NumberOfThreads;
+				for (int64 i = begin + 1; i < end; i++)
+					values[i] += values[i - 1];
+				BlockSums[t + 1] = (end > begin) ? values[end - 1] : 0;
+			});
+	if (NumberOfThreads <= 1)
+		return;
+	for (unsigned int t = 1; t <= NumberOfThreads; t++)
+		BlockSums[t] += BlockSums[t - 1];
+	RunThreads(NumberOfThreads,
+			[values, size, &BlockSums](unsigned int t,
+					unsigned int NumberOfThreads) {
+				int64 begin = size * t / NumberOfThreads;
+				int64 end = size * (t + 1) / NumberOfThreads;
+				for (int64 i = begin; i < end; i++)
+					values[i] += BlockSums[t];
+			});
+}
+
+#endif /* INCLUDES_PARALLELUTILS_H_ */
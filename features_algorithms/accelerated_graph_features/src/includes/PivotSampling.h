@@ -0,0 +1,135 @@
+/*
+ * PivotSampling.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDES_PIVOTSAMPLING_H_
+#define INCLUDES_PIVOTSAMPLING_H_
+
+#include "stdafx.h"
+#include "ParallelUtils.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+/*
+ The approximate mode of the all-pairs BFS features (BFS moments, attraction basin and flow):
+ instead of a BFS from every node, BFS traversals from k sampled pivots, whose distances to and
+ from every node are a sample of that node's distances.
+ A node's feature is a function of totals over all of the nodes (such as the number of nodes it
+ reaches and the sum of their distances), and every total is estimated from the pivots by the
+ Horvitz-Thompson estimator: a pivot stands for weight = N_h / k_h nodes of its stratum.
+ The confidence interval of a feature comes from linearizing it around the estimated totals
+ (the delta method), with the variance of the totals estimated from the spread of the pivots'
+ contributions. With k >= N all of the nodes are pivots, and the features are exact.
+ */
+class PivotSampling {
+public:
+	/*
+	 Sample NumberOfPivots distinct nodes (all of them if there are less), and the weight of each.
+	 Uniform sampling gives all of the pivots a weight of N / k. Degree stratified sampling splits
+	 the nodes into strata by the log2 of their degree (in the undirected graph), allocates the
+	 pivots to the strata in proportion to their size (at least one for every stratum, as long as
+	 there are enough pivots) and samples every stratum uniformly, so the few high degree nodes
+	 are always represented.
+	 */
+	template<typename GraphT>
+	static void SamplePivots(const GraphT& graph, unsigned int NumberOfPivots,
+			unsigned int seed, bool stratified,
+			std::vector<typename GraphT::node_type>& pivots,
+			std::vector<double>& weights);
+
+	/*
+	 Run the pivots BatchSize() at a time: traverse(slot, pivot) runs the traversals of every
+	 pivot of the batch on its own thread, into the workspaces of its slot, and then
+	 accumulate(node, slot, pivot) is called for every node and every pivot of the batch, with
+	 the nodes split between the threads (so a node's accumulators need no locking).
+	 */
+	static unsigned int BatchSize() {
+		return ParallelUtils::GetNumberOfThreads();
+	}
+	template<typename Traverse, typename Accumulate>
+	static void RunPivots(int64 NumberOfPivots, int64 NumberOfNodes,
+			Traverse traverse, Accumulate accumulate);
+
+	// The normal quantile of the two sided 95% confidence intervals
+	static const double CONFIDENCE_Z;
+	// The nodes every thread accumulates at a time
+	static const int64 ACCUMULATE_GRAIN = 1024;
+};
+
+/*
+ The sums of the contributions of the pivots to D totals of a node, and of their products.
+ Every contribution is expanded by the number of pivots times the weight of the pivot, so a total
+ is estimated by Total and a function of the totals gets its confidence interval from HalfWidth,
+ given the gradient of the function at the estimated totals.
+ Pivots that contribute nothing to the node aren't added, but are counted in NumberOfPivots.
+ */
+template<unsigned int D>
+class PivotTotals {
+public:
+	PivotTotals() {
+		for (unsigned int i = 0; i < D; i++)
+			sums[i] = 0;
+		for (unsigned int i = 0; i < D * (D + 1) / 2; i++)
+			products[i] = 0;
+	}
+
+	void Add(const double* contribution) {
+		unsigned int position = 0;
+		for (unsigned int i = 0; i < D; i++) {
+			sums[i] += contribution[i];
+			for (unsigned int j = i; j < D; j++)
+				products[position++] += contribution[i] * contribution[j];
+		}
+	}
+
+	double Total(unsigned int i, int64 NumberOfPivots) const {
+		return sums[i] / NumberOfPivots;
+	}
+
+	double HalfWidth(const double* gradient, int64 NumberOfPivots,
+			int64 NumberOfNodes) const {
+		if (NumberOfPivots >= NumberOfNodes)
+			return 0;
+		if (NumberOfPivots < 2)
+			return std::numeric_limits<double>::infinity();
+		const double k = static_cast<double>(NumberOfPivots);
+		//the sample variance of the linearized contributions
+		double variance = 0;
+		unsigned int position = 0;
+		for (unsigned int i = 0; i < D; i++)
+			for (unsigned int j = i; j < D; j++) {
+				const double covariance = (products[position++] - sums[i] * sums[j] / k)
+						/ (k - 1);
+				variance += (i == j ? 1 : 2) * gradient[i] * gradient[j] * covariance;
+			}
+		variance *= (1 - k / NumberOfNodes) / k;
+		return PivotSampling::CONFIDENCE_Z * std::sqrt(std::max(variance, 0.0));
+	}
+
+private:
+	double sums[D];
+	double products[D * (D + 1) / 2];
+};
+
+template<typename Traverse, typename Accumulate>
+void PivotSampling::RunPivots(int64 NumberOfPivots, int64 NumberOfNodes,
+		Traverse traverse, Accumulate accumulate) {
+	const int64 batch = BatchSize();
+	for (int64 first = 0; first < NumberOfPivots; first += batch) {
+		const int64 last = std::min(NumberOfPivots, first + batch);
+		ParallelUtils::ParallelFor(first, last, 1,
+				[&](unsigned int, int64 pivot) {
+					traverse(static_cast<unsigned int>(pivot - first), pivot);
+				});
+		ParallelUtils::ParallelFor(0, NumberOfNodes, ACCUMULATE_GRAIN,
+				[&](unsigned int, int64 node) {
+					for (int64 pivot = first; pivot < last; pivot++)
+						accumulate(node, static_cast<unsigned int>(pivot - first), pivot);
+				});
+	}
+}
+
+#endif /* INCLUDES_PIVOTSAMPLING_H_ */
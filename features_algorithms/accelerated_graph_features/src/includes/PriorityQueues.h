@@ -0,0 +1,178 @@
+/*
+ * PriorityQueues.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDES_PRIORITYQUEUES_H_
+#define INCLUDES_PRIORITYQUEUES_H_
+
+#include "stdafx.h"
+#include <utility>
+#include <vector>
+
+/*
+ A d-ary min heap of the items 0..N-1 by their keys, which keeps the position of every item so
+ that the key of an item in the heap can be decreased in place (as Dijkstra's algorithm does).
+ A 4-ary heap is half as deep as a binary one, and the children of a node are next to each other
+ in memory; the keys are kept in the heap with their items, so sifting doesn't look anything up.
+ Reset sizes the positions for N items; after that, Clear only touches the items left in the heap.
+ */
+template<typename Key, typename Item, unsigned int Arity = 4>
+class IndexedDaryHeap {
+public:
+	void Reset(int64 NumberOfItems) {
+		m_Heap.clear();
+		m_Positions.assign(NumberOfItems, NOT_IN_HEAP);
+	}
+	void Clear() {
+		for (const Entry& entry : m_Heap)
+			m_Positions[entry.second] = NOT_IN_HEAP;
+		m_Heap.clear();
+	}
+	bool Empty() const {
+		return m_Heap.empty();
+	}
+	bool Contains(Item item) const {
+		return m_Positions[item] != NOT_IN_HEAP;
+	}
+
+	// Push the item, or decrease its key if it is in the heap with a larger one
+	void PushOrDecrease(Item item, Key key) {
+		size_t position = m_Positions[item];
+		if (position == NOT_IN_HEAP) {
+			position = m_Heap.size();
+			m_Heap.push_back(Entry(key, item));
+		} else if (key < m_Heap[position].first)
+			m_Heap[position].first = key;
+		else
+			return;
+		SiftUp(position);
+	}
+
+	// The item with the smallest key
+	Item Top() const {
+		return m_Heap[0].second;
+	}
+	Key TopKey() const {
+		return m_Heap[0].first;
+	}
+	void Pop() {
+		m_Positions[m_Heap[0].second] = NOT_IN_HEAP;
+		const Entry last = m_Heap.back();
+		m_Heap.pop_back();
+		if (m_Heap.empty())
+			return;
+		m_Heap[0] = last;
+		SiftDown(0);
+	}
+
+private:
+	typedef std::pair<Key, Item> Entry;
+	static const size_t NOT_IN_HEAP = static_cast<size_t>(-1);
+
+	// The entry moves up the hole its parents leave, and is written once
+	void SiftUp(size_t position) {
+		const Entry entry = m_Heap[position];
+		while (position > 0) {
+			const size_t parent = (position - 1) / Arity;
+			if (!(entry.first < m_Heap[parent].first))
+				break;
+			m_Heap[position] = m_Heap[parent];
+			m_Positions[m_Heap[position].second] = position;
+			position = parent;
+		}
+		m_Heap[position] = entry;
+		m_Positions[entry.second] = position;
+	}
+	void SiftDown(size_t position) {
+		const Entry entry = m_Heap[position];
+		const size_t size = m_Heap.size();
+		for (;;) {
+			const size_t first = position * Arity + 1;
+			if (first >= size)
+				break;
+			const size_t last = first + Arity < size ? first + Arity : size;
+			size_t smallest = first;
+			for (size_t child = first + 1; child < last; child++)
+				if (m_Heap[child].first < m_Heap[smallest].first)
+					smallest = child;
+			if (!(m_Heap[smallest].first < entry.first))
+				break;
+			m_Heap[position] = m_Heap[smallest];
+			m_Positions[m_Heap[position].second] = position;
+			position = smallest;
+		}
+		m_Heap[position] = entry;
+		m_Positions[entry.second] = position;
+	}
+
+	std::vector<Entry> m_Heap;
+	std::vector<size_t> m_Positions;
+};
+
+template<typename Key, typename Item, unsigned int Arity>
+const size_t IndexedDaryHeap<Key, Item, Arity>::NOT_IN_HEAP;
+
+/*
+ A monotone priority queue of integer keys (Ahuja, Mehlhorn, Orlin and Tarjan, "Faster algorithms
+ for the shortest path problem"): every key pushed must be at least the last key popped, as in
+ Dijkstra's algorithm with non-negative integer weights. Bucket b holds the keys whose highest bit
+ that differs from the last popped key is b - 1 (bucket 0 those equal to it), and popping from an
+ empty bucket 0 moves the smallest non-empty bucket down around its minimum, so every key moves at
+ most 64 times. There is no decrease-key: an item is pushed again with its smaller key, and the
+ stale entries are skipped by the caller.
+ */
+template<typename Item>
+class RadixHeap {
+public:
+	RadixHeap() :
+			m_Last(0), m_Size(0) {
+	}
+	void Clear() {
+		for (std::vector<Entry>& bucket : m_Buckets)
+			bucket.clear();
+		m_Last = 0;
+		m_Size = 0;
+	}
+	bool Empty() const {
+		return m_Size == 0;
+	}
+	void Push(int64 key, Item item) {
+		m_Buckets[BucketOf(key)].push_back(Entry(key, item));
+		m_Size++;
+	}
+	// Pops an entry with the smallest key
+	std::pair<int64, Item> Pop() {
+		if (m_Buckets[0].empty()) {
+			unsigned int b = 1;
+			while (m_Buckets[b].empty())
+				b++;
+			std::vector<Entry>& bucket = m_Buckets[b];
+			m_Last = bucket[0].first;
+			for (const Entry& entry : bucket)
+				if (entry.first < m_Last)
+					m_Last = entry.first;
+			//all of the keys go to lower buckets
+			for (const Entry& entry : bucket)
+				m_Buckets[BucketOf(entry.first)].push_back(entry);
+			bucket.clear();
+		}
+		const Entry entry = m_Buckets[0].back();
+		m_Buckets[0].pop_back();
+		m_Size--;
+		return entry;
+	}
+
+private:
+	typedef std::pair<int64, Item> Entry;
+	unsigned int BucketOf(int64 key) const {
+		return key == m_Last ? 0 : 64 - __builtin_clzll(key ^ m_Last);
+	}
+
+	int64 m_Last;
+	size_t m_Size;
+	std::vector<Entry> m_Buckets[65];
+};
+
+#endif /* INCLUDES_PRIORITYQUEUES_H_ */
@@ -6,4 +6,300 @@
  */
 
 #include "CacheGraph.h"
+#include "CacheGraphDispatch.h"
+#include "ParallelUtils.h"
+#include "TestUtils.h"
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
 
+// Exposes the layout of the file header, so that the tests can corrupt it
+class FileFormat: public CacheGraphFormat {
+public:
+	typedef CacheGraphFormat::FileHeader Header;
+	typedef CacheGraphFormat::FileSection Section;
+};
+
+static std::string TemporaryFileName(const std::string& name) {
+	return "/tmp/CacheGraph_test_" + std::to_string(getpid()) + "_" + name;
+}
+
+static std::vector<char> ReadBytes(const std::string& FileName) {
+	std::ifstream file(FileName.c_str(), std::ios::binary);
+	return std::vector<char>(std::istreambuf_iterator<char>(file),
+			std::istreambuf_iterator<char>());
+}
+
+static void WriteBytes(const std::string& FileName, const std::vector<char>& bytes) {
+	std::ofstream file(FileName.c_str(), std::ios::binary | std::ios::trunc);
+	file.write(bytes.data(), bytes.size());
+}
+
+template<typename T>
+static void Poke(std::vector<char>& bytes, size_t position, T value) {
+	std::memcpy(&bytes[position], &value, sizeof(T));
+}
+
+// Neither reading nor mapping the file may succeed
+template<typename GraphT>
+static bool Rejects(const std::string& FileName) {
+	GraphT read, mapped;
+	return !read.LoadFromFile(FileName) && !mapped.MapFromFile(FileName)
+			&& read.GetNumberOfNodes() == 0 && mapped.GetNumberOfNodes() == 0;
+}
+
+template<typename GraphT>
+static void CheckViews(const GraphT& loaded, const GraphT& original) {
+	TEST_CHECK(TestUtils::SameGraph(loaded, original));
+	TEST_CHECK(TestUtils::SameGraph(loaded.inverse(), original.inverse()));
+	TEST_CHECK(TestUtils::SameGraph(loaded.undirected(), original.undirected()));
+	TEST_CHECK(loaded.degrees() == original.degrees());
+	TEST_CHECK(loaded.degreeOrder() == original.degreeOrder());
+}
+
+/*
+ Save graphs of every kind with and without the derived sections, and check that reading and
+ mapping the file give back the same graph and views.
+ */
+template<typename GraphT>
+static void TestRoundTrip(bool directed, bool weighted) {
+	std::mt19937_64 generator(directed * 2 + weighted);
+	const unsigned int n = 300;
+	const TestUtils::EdgeList edges = TestUtils::RandomEdges(n, 2000, true, generator);
+	std::vector<double> weights;
+	std::uniform_real_distribution<double> weight(0.5, 2);
+	for (size_t i = 0; weighted && i < edges.size(); i++)
+		weights.push_back(weight(generator));
+	GraphT original(directed);
+	TestUtils::AssignEdges(original, n, edges, weights);
+
+	const std::string FileName = TemporaryFileName("round_trip");
+	const unsigned int derived[] = { 0, CacheGraphFormat::SAVE_INVERSE,
+			CacheGraphFormat::SAVE_ALL_DERIVED };
+	for (unsigned int DerivedSections : derived) {
+		TEST_CHECK(original.SaveToFile(FileName, DerivedSections));
+		unsigned int NodeIdSize = 0, OffsetSize = 0;
+		TEST_CHECK(CacheGraphFormat::ReadFileWidths(FileName, NodeIdSize, OffsetSize));
+		TEST_CHECK(NodeIdSize == sizeof(typename GraphT::node_type));
+		TEST_CHECK(OffsetSize == sizeof(typename GraphT::offset_type));
+		GraphT read, mapped;
+		TEST_CHECK(read.LoadFromFile(FileName));
+		TEST_CHECK(!read.isMemoryMapped());
+		CheckViews(read, original);
+		TEST_CHECK(mapped.MapFromFile(FileName));
+		TEST_CHECK(mapped.isMemoryMapped());
+		CheckViews(mapped, original);
+	}
+	std::remove(FileName.c_str());
+}
+
+/*
+ Damaged, foreign and hostile files must be rejected without crashing.
+ */
+static void TestCorruptFiles() {
+	typedef FileFormat::Header Header;
+	std::mt19937_64 generator(7);
+	const unsigned int n = 100;
+	CacheGraph graph(true);
+	TestUtils::AssignEdges(graph, n, TestUtils::RandomEdges(n, 500, false, generator));
+	const std::string FileName = TemporaryFileName("valid");
+	const std::string damaged = TemporaryFileName("damaged");
+	TEST_CHECK(graph.SaveToFile(FileName, CacheGraphFormat::SAVE_ALL_DERIVED));
+	const std::vector<char> bytes = ReadBytes(FileName);
+	TEST_CHECK(bytes.size() > sizeof(Header));
+
+	//the file loads only into a graph of its widths
+	TEST_CHECK(Rejects<CompactCacheGraph>(FileName));
+	TEST_CHECK(Rejects<LargeCacheGraph>(FileName));
+	TEST_CHECK(Rejects<CacheGraph>(TemporaryFileName("missing")));
+
+	//a wrong checksum, version or magic
+	std::vector<char> corrupt = bytes;
+	corrupt[offsetof(Header, checksum)] ^= 1;
+	WriteBytes(damaged, corrupt);
+	TEST_CHECK(Rejects<CacheGraph>(damaged));
+	corrupt = bytes;
+	Poke<unsigned int>(corrupt, offsetof(Header, version), 1);
+	WriteBytes(damaged, corrupt);
+	TEST_CHECK(Rejects<CacheGraph>(damaged));
+	corrupt = bytes;
+	corrupt[0] = 'X';
+	WriteBytes(damaged, corrupt);
+	TEST_CHECK(Rejects<CacheGraph>(damaged));
+
+	//a section table that doesn't fit the file, also when its size wraps around
+	const int64 counts[] = { 1000, 1ULL << 59, (1ULL << 59) + 1, ~0ULL };
+	for (int64 count : counts) {
+		corrupt = bytes;
+		Poke<int64>(corrupt, offsetof(Header, numberOfSections), count);
+		WriteBytes(damaged, corrupt);
+		TEST_CHECK(Rejects<CacheGraph>(damaged));
+	}
+	corrupt = bytes;
+	Poke<int64>(corrupt, offsetof(Header, sectionTablePosition), ~0ULL - 8);
+	WriteBytes(damaged, corrupt);
+	TEST_CHECK(Rejects<CacheGraph>(damaged));
+
+	//truncated files
+	const size_t lengths[] = { 0, 10, sizeof(Header), sizeof(Header) + 8,
+			bytes.size() / 2, bytes.size() - 1 };
+	for (size_t length : lengths) {
+		WriteBytes(damaged, std::vector<char>(bytes.begin(), bytes.begin() + length));
+		TEST_CHECK(Rejects<CacheGraph>(damaged));
+	}
+
+	//garbage
+	std::vector<char> garbage(bytes.size());
+	for (char& byte : garbage)
+		byte = static_cast<char>(generator());
+	WriteBytes(damaged, garbage);
+	TEST_CHECK(Rejects<CacheGraph>(damaged));
+
+	//the neighbor list (the second section) is verified when it is read, a mapped file is used
+	//as it is
+	FileFormat::Section neighbors;
+	std::memcpy(&neighbors, &bytes[sizeof(Header) + sizeof(FileFormat::Section)],
+			sizeof(FileFormat::Section));
+	corrupt = bytes;
+	corrupt[neighbors.position] ^= 1;
+	WriteBytes(damaged, corrupt);
+	CacheGraph read;
+	TEST_CHECK(!read.LoadFromFile(damaged));
+
+	std::remove(FileName.c_str());
+	std::remove(damaged.c_str());
+}
+
+// The width of the node IDs of the graph it is called with
+struct NodeIdWidth {
+	typedef unsigned int result_type;
+	template<typename GraphT>
+	result_type operator()(const GraphT&) const {
+		return sizeof(typename GraphT::node_type);
+	}
+};
+
+/*
+ Neighbor lists of 64 bit IDs build the same graphs as lists of 32 bit IDs, and the dispatch
+ rejects an empty offset list.
+ */
+static void TestWideLists() {
+	std::mt19937_64 generator(11);
+	const unsigned int n = 200;
+	CacheGraph narrow(true);
+	TestUtils::AssignEdges(narrow, n, TestUtils::RandomEdges(n, 1000, true, generator));
+	const std::vector<int64> offsets(narrow.GetOffsetList(),
+			narrow.GetOffsetList() + n + 1);
+	const std::vector<int64> neighbors(narrow.GetNeighborList(),
+			narrow.GetNeighborList() + narrow.GetNumberOfEdges());
+	CacheGraph fromWide(true);
+	fromWide.Assign(offsets, neighbors);
+	TEST_CHECK(TestUtils::SameGraph(fromWide, narrow));
+	LargeCacheGraph large(true);
+	large.Assign(offsets, neighbors);
+	TEST_CHECK(large.GetNumberOfEdges() == narrow.GetNumberOfEdges());
+	TEST_CHECK(std::equal(neighbors.begin(), neighbors.end(), large.GetNeighborList()));
+	TEST_CHECK(CacheGraphDispatch::FromLists(offsets, neighbors, NULL, true,
+			NodeIdWidth()) == sizeof(unsigned int));
+
+	bool thrown = false;
+	try {
+		CacheGraphDispatch::FromLists(std::vector<int64>(), neighbors, NULL, true,
+				NodeIdWidth());
+	} catch (const std::invalid_argument&) {
+		thrown = true;
+	}
+	TEST_CHECK(thrown);
+}
+
+/*
+ The features computed on a relabeled graph (see ComputeNodeOrdering) map back to the features of
+ the original graph, also for directed graphs with reciprocal edges and self loops.
+ */
+template<typename GraphT>
+static void TestOrderIndependence(bool directed, bool weighted) {
+	typedef typename GraphT::node_type NodeId;
+	std::mt19937_64 generator(100 + directed * 2 + weighted);
+	const unsigned int n = 400;
+	const TestUtils::EdgeList edges = TestUtils::RandomEdges(n, 4000, true, generator);
+	std::vector<double> weights;
+	std::uniform_real_distribution<double> weight(0.5, 3);
+	for (size_t i = 0; weighted && i < edges.size(); i++)
+		weights.push_back(weight(generator));
+	GraphT graph(directed);
+	TestUtils::AssignEdges(graph, n, edges, weights);
+	std::vector<std::vector<float> > clustering;
+	graph.ComputeClustering(clustering);
+	const std::vector<NodeId> cores = graph.ComputeKCore();
+
+	const NodeOrdering orderings[] = { ORDER_DEGREE, ORDER_RCM, ORDER_COMMUNITY };
+	for (NodeOrdering ordering : orderings) {
+		const std::vector<NodeId> NewIds = graph.ComputeNodeOrdering(ordering);
+		GraphT relabeled;
+		graph.Relabel(NewIds, relabeled);
+		TEST_CHECK(GraphT::ToOriginalOrder(relabeled.ComputeKCore(), NewIds) == cores);
+		std::vector<std::vector<float> > RelabeledClustering;
+		relabeled.ComputeClustering(RelabeledClustering);
+		TEST_CHECK(RelabeledClustering.size() == clustering.size());
+		for (size_t type = 0; type < clustering.size(); type++) {
+			const std::vector<float> values = GraphT::ToOriginalOrder(
+					RelabeledClustering[type], NewIds);
+			for (unsigned int node = 0; node < n; node++)
+				TEST_CHECK(std::fabs(values[node] - clustering[type][node]) <= 1e-5f);
+		}
+	}
+}
+
+/*
+ The parallel peeling must give the core numbers of the sequential algorithm, on graphs large
+ enough to be split between several threads and on small ones, with hubs, a dense core, isolated
+ nodes, self loops and (in a directed graph) reciprocal edges.
+ */
+static void TestKCoreParallel(bool directed) {
+	std::mt19937_64 generator(200 + directed);
+	const unsigned int NumberOfThreads = ParallelUtils::GetNumberOfThreads();
+	ParallelUtils::SetNumberOfThreads(4);
+	const unsigned int sizes[][2] = { { 0, 0 }, { 1, 1 }, { 50, 100 }, { 2000, 8000 },
+			{ 20000, 100000 }, { 60000, 200000 } };
+	for (const unsigned int* size : sizes) {
+		const unsigned int n = size[0];
+		TestUtils::EdgeList edges;
+		if (n > 0)
+			edges = TestUtils::RandomEdges(n, size[1], true, generator);
+		//hubs and a clique, for nodes of high degrees and cores
+		std::uniform_int_distribution<unsigned int> pick(0, n == 0 ? 0 : n - 1);
+		for (unsigned int hub = 0; hub < 3 && n > 100; hub++)
+			for (unsigned int i = 0; i < n / 10; i++)
+				edges.push_back(std::make_pair(hub, pick(generator)));
+		for (unsigned int u = 0; u < 40 && n > 100; u++)
+			for (unsigned int v = 0; v < 40; v++)
+				if (u != v)
+					edges.push_back(std::make_pair(n / 2 + u, n / 2 + v));
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+		CacheGraph graph(directed);
+		TestUtils::AssignEdges(graph, n, edges);
+		TEST_CHECK(graph.ComputeKCoreParallel() == graph.ComputeKCore());
+	}
+	ParallelUtils::SetNumberOfThreads(NumberOfThreads);
+}
+
+int main() {
+	for (int directed = 0; directed < 2; directed++)
+		for (int weighted = 0; weighted < 2; weighted++) {
+			TestRoundTrip<CompactCacheGraph>(directed, weighted);
+			TestRoundTrip<CacheGraph>(directed, weighted);
+			TestRoundTrip<LargeCacheGraph>(directed, weighted);
+		}
+	TestCorruptFiles();
+	TestWideLists();
+	for (int directed = 0; directed < 2; directed++)
+		for (int weighted = 0; weighted < 2; weighted++)
+			TestOrderIndependence<CacheGraph>(directed, weighted);
+	TestKCoreParallel(false);
+	TestKCoreParallel(true);
+	return TestUtils::Summary("CacheGraph_test");
+}
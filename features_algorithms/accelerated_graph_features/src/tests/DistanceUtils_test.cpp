@@ -0,0 +1,193 @@
+/*
+ * DistanceUtils_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "DistanceUtils.h"
+#include "ParallelUtils.h"
+#include "PriorityQueues.h"
+#include "TestUtils.h"
+#include <limits>
+#include <set>
+
+typedef std::pair<double, unsigned int> KeyedItem;
+
+/*
+ Random pushes, decreases and pops, where every popped key must be the smallest key of the items
+ in the heap (ties may pop any of their items).
+ */
+static void TestIndexedDaryHeap(std::mt19937_64& generator) {
+	const unsigned int N = 300;
+	IndexedDaryHeap<double, unsigned int> heap;
+	heap.Reset(N);
+	std::set<KeyedItem> expected;
+	std::vector<double> keys(N);
+	std::uniform_int_distribution<unsigned int> pick(0, N - 1), pickKey(0, 50);
+	for (unsigned int round = 0; round < 20; round++) {
+		for (unsigned int step = 0; step < 2000; step++) {
+			if (generator() % 3 != 0 || expected.empty()) {
+				const unsigned int item = pick(generator);
+				const double key = pickKey(generator) / 4.0;
+				const bool contained = expected.count(KeyedItem(keys[item], item)) == 1;
+				TEST_CHECK(heap.Contains(item) == contained);
+				heap.PushOrDecrease(item, key);
+				if (!contained || key < keys[item]) {
+					expected.erase(KeyedItem(keys[item], item));
+					keys[item] = key;
+					expected.insert(KeyedItem(key, item));
+				}
+			} else {
+				const unsigned int item = heap.Top();
+				TEST_CHECK(heap.TopKey() == expected.begin()->first);
+				TEST_CHECK(expected.erase(KeyedItem(heap.TopKey(), item)) == 1);
+				heap.Pop();
+				TEST_CHECK(!heap.Contains(item));
+			}
+			TEST_CHECK(heap.Empty() == expected.empty());
+		}
+		//half of the rounds empty the heap, and the others leave it to Clear
+		if (round % 2)
+			while (!heap.Empty()) {
+				TEST_CHECK(heap.TopKey() == expected.begin()->first);
+				expected.erase(KeyedItem(heap.TopKey(), heap.Top()));
+				heap.Pop();
+			}
+		heap.Clear();
+		expected.clear();
+		for (unsigned int item = 0; item < N; item++)
+			TEST_CHECK(!heap.Contains(item));
+	}
+}
+
+/*
+ Random pushes and pops of a monotone heap, with keys that are never below the last popped key
+ (including equal ones, and keys that differ from it in the highest bits), against a multiset.
+ */
+static void TestRadixHeap(std::mt19937_64& generator) {
+	RadixHeap<unsigned int> heap;
+	const int64 ranges[] = { 0, 3, 1000, 1ULL << 40, ~0ULL >> 2 };
+	for (unsigned int round = 0; round < 10; round++) {
+		std::multiset<std::pair<int64, unsigned int> > expected;
+		int64 last = round % 2 ? 0 : generator() >> 2;
+		heap.Clear();
+		if (round % 2 == 0) {
+			heap.Push(last, 0);
+			expected.insert(std::make_pair(last, 0u));
+		}
+		for (unsigned int step = 0; step < 5000; step++) {
+			if (generator() % 5 < 3 || expected.empty()) {
+				//the keys stay below 2^64
+				const int64 range = last < ranges[4] ? ranges[generator() % 5] : 1000;
+				const int64 key = last + (range == 0 ? 0 : generator() % range);
+				const unsigned int item = generator() % 1000;
+				heap.Push(key, item);
+				expected.insert(std::make_pair(key, item));
+			} else {
+				const std::pair<int64, unsigned int> top = heap.Pop();
+				TEST_CHECK(top.first == expected.begin()->first);
+				const auto found = expected.find(top);
+				TEST_CHECK(found != expected.end());
+				if (found != expected.end())
+					expected.erase(found);
+				last = top.first;
+			}
+			TEST_CHECK(heap.Empty() == expected.empty());
+		}
+		while (!expected.empty()) {
+			const std::pair<int64, unsigned int> top = heap.Pop();
+			TEST_CHECK(top.first == expected.begin()->first);
+			expected.erase(expected.find(top));
+		}
+		TEST_CHECK(heap.Empty());
+	}
+}
+
+// The distances from src by Bellman-Ford, by the weights of the graph or 1 for every edge
+static std::vector<double> BellmanFord(const CacheGraph& graph, unsigned int src) {
+	const int64 n = graph.GetNumberOfNodes();
+	const double* weights = graph.isWeighted() ? graph.GetWeights() : NULL;
+	std::vector<double> dist(n, std::numeric_limits<double>::infinity());
+	dist[src] = 0;
+	for (bool changed = true; changed;) {
+		changed = false;
+		for (unsigned int u = 0; u < n; u++) {
+			const CacheGraph::NeighborRange neighbors = graph.neighbors(u);
+			for (CacheGraph::NeighborIterator it = neighbors.begin(); it != neighbors.end();
+					++it) {
+				const double candidate = dist[u] + (weights ? weights[it.edge()] : 1);
+				if (candidate < dist[*it]) {
+					dist[*it] = candidate;
+					changed = true;
+				}
+			}
+		}
+	}
+	return dist;
+}
+
+enum WeightKind {
+	UNWEIGHTED, INTEGER_WEIGHTS, FRACTIONAL_WEIGHTS
+};
+
+/*
+ A random graph where the edges only join the first three quarters of the nodes, so that the
+ others are unreachable. Integer weights (the radix heap) are 0..9, and fractional ones (the d-ary
+ heap) are quarters in 0..10, so that every path length is exact and the distances can be compared
+ exactly. Both include zero weights.
+ */
+static void TestShortestPaths(bool directed, WeightKind kind, unsigned int n, unsigned int m,
+		std::mt19937_64& generator) {
+	TestUtils::EdgeList edges = TestUtils::RandomEdges(n * 3 / 4, m, true, generator);
+	std::vector<double> weights;
+	for (size_t i = 0; kind != UNWEIGHTED && i < edges.size(); i++)
+		weights.push_back(kind == INTEGER_WEIGHTS ?
+				generator() % 10 : (generator() % 41) / 4.0);
+	//at least one weight that isn't an integer, for the d-ary heap
+	if (kind == FRACTIONAL_WEIGHTS && !weights.empty())
+		weights[0] = 0.25;
+	CacheGraph graph(directed);
+	TestUtils::AssignEdges(graph, n, edges, weights);
+
+	//one workspace for all of the sources, which must be reset between them
+	DijkstraWorkspace workspace;
+	const unsigned int sources[] = { 0, 1, n / 2, n * 3 / 4 - 1, n * 3 / 4, n - 1 };
+	for (unsigned int src : sources) {
+		const std::vector<double> expected = BellmanFord(graph, src);
+		DistanceUtils::Dijkstra(graph, src, workspace);
+		TEST_CHECK(workspace.GetDistances() == expected);
+		const int64 reachable = std::count_if(expected.begin(), expected.end(),
+				[](double d) {return d != std::numeric_limits<double>::infinity();});
+		TEST_CHECK(workspace.GetNumberOfReached() == reachable);
+		for (int64 i = 1; i < workspace.GetNumberOfReached(); i++)
+			TEST_CHECK(expected[workspace.GetReached()[i - 1]]
+					<= expected[workspace.GetReached()[i]]);
+
+		const double deltas[] = { 0, 0.25, 1, 3.5, 100 };
+		std::vector<double> distances;
+		for (double delta : deltas) {
+			DistanceUtils::DeltaStepping(graph, src, delta, distances);
+			TEST_CHECK(distances == expected);
+		}
+	}
+}
+
+int main() {
+	std::mt19937_64 generator(11);
+	TestIndexedDaryHeap(generator);
+	TestRadixHeap(generator);
+
+	//delta-stepping relaxes the buckets by several threads
+	const unsigned int threads = ParallelUtils::GetNumberOfThreads();
+	ParallelUtils::SetNumberOfThreads(4);
+	const WeightKind kinds[] = { UNWEIGHTED, INTEGER_WEIGHTS, FRACTIONAL_WEIGHTS };
+	for (int directed = 0; directed < 2; directed++)
+		for (WeightKind kind : kinds) {
+			TestShortestPaths(directed, kind, 8, 10, generator);
+			TestShortestPaths(directed, kind, 100, 150, generator);
+			TestShortestPaths(directed, kind, 400, 2000, generator);
+			TestShortestPaths(directed, kind, 3000, 12000, generator);
+		}
+	ParallelUtils::SetNumberOfThreads(threads);
+	return TestUtils::Summary("DistanceUtils_test");
+}
@@ -0,0 +1,117 @@
+/*
+ * HyperAnf_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "HyperAnf.h"
+#include "DistanceUtils.h"
+#include "ParallelUtils.h"
+#include "TestUtils.h"
+#include <cmath>
+#include <stdexcept>
+
+/*
+ Merge must be the register-wise maximum, and tell whether any register grew, for every number of
+ registers (16 are merged by SSE2, and more by AVX2 where the CPU has it). Every register is also
+ the only one to grow once, so that a change in any lane is seen.
+ */
+static void TestMerge(std::mt19937_64& generator) {
+	for (unsigned int b = HyperAnf::MIN_LOG2_REGISTERS; b <= HyperAnf::MAX_LOG2_REGISTERS; b++) {
+		const unsigned int m = 1u << b;
+		for (unsigned int round = 0; round < 20; round++) {
+			std::vector<unsigned char> to(m), from(m);
+			for (unsigned int i = 0; i < m; i++) {
+				to[i] = generator() % 60;
+				//some rounds have few registers that grow, and some none
+				from[i] = round % 4 == 0 ? to[i] : round % 2 ?
+						generator() % 60 : std::min<unsigned int>(to[i], generator() % 60);
+			}
+			if (round % 4 == 1)
+				from[generator() % m] = 64;
+			std::vector<unsigned char> expected(m);
+			bool grew = false;
+			for (unsigned int i = 0; i < m; i++) {
+				expected[i] = std::max(to[i], from[i]);
+				grew = grew || from[i] > to[i];
+			}
+			TEST_CHECK(HyperAnf::Merge(to.data(), from.data(), m) == grew);
+			TEST_CHECK(to == expected);
+		}
+		if (m > 256)
+			continue;
+		for (unsigned int i = 0; i < m; i++) {
+			std::vector<unsigned char> to(m, 5), from(m, 5);
+			from[i] = 6;
+			TEST_CHECK(HyperAnf::Merge(to.data(), from.data(), m));
+			TEST_CHECK(to == from);
+			TEST_CHECK(!HyperAnf::Merge(to.data(), from.data(), m));
+		}
+	}
+}
+
+/*
+ The estimated ball sizes of every node and distance must be within six standard errors of the
+ exact ones by a BFS from every node: there are thousands of them, and the error is a bit larger
+ around 2.5 times the number of registers, where the estimate leaves linear counting.
+ */
+static void TestBallSizes(bool directed, unsigned int n, unsigned int m, unsigned int b,
+		std::mt19937_64& generator) {
+	CacheGraph graph(directed);
+	TestUtils::AssignEdges(graph, n, TestUtils::RandomEdges(n, m, false, generator));
+	//exact[v][d] is the number of nodes within distance d of v
+	std::vector<std::vector<int64> > exact(n);
+	BfsWorkspace workspace;
+	for (unsigned int v = 0; v < n; v++) {
+		DistanceUtils::Bfs(graph, v, workspace);
+		exact[v].assign(workspace.GetLevels().begin() + 1, workspace.GetLevels().end());
+	}
+	const double bound = 6 * 1.04 / std::sqrt(static_cast<double>(1u << b));
+	unsigned int visits = 0;
+	double totalError = 0;
+	int64 estimates = 0;
+	const unsigned int iterations = HyperAnf::BallSizes(graph, b, 7, [&](unsigned int d,
+			const std::vector<double>& balls) {
+		TEST_CHECK(d == visits++);
+		TEST_CHECK(balls.size() == n);
+		for (unsigned int v = 0; v < n; v++) {
+			const double ball = exact[v][std::min<size_t>(d, exact[v].size() - 1)];
+			//a small ball may lose a node to a shared register, whatever its standard error
+			TEST_CHECK(std::fabs(balls[v] - ball) <= bound * ball + 1);
+			totalError += std::fabs(balls[v] - ball) / ball;
+			estimates++;
+		}
+	});
+	TEST_CHECK(visits == iterations + 1);
+	//no counter changes after the largest distance (and one may stop earlier, if its new nodes
+	//share its registers)
+	unsigned int diameter = 0;
+	for (unsigned int v = 0; v < n; v++)
+		diameter = std::max<unsigned int>(diameter, exact[v].size() - 1);
+	TEST_CHECK(iterations <= diameter);
+	//on average, the error is about one standard error
+	TEST_CHECK(totalError / estimates <= bound / 6);
+}
+
+int main() {
+	std::mt19937_64 generator(5);
+	TestMerge(generator);
+	bool threw = false;
+	try {
+		HyperAnf::BallSizes(CacheGraph(false), HyperAnf::MAX_LOG2_REGISTERS + 1, 0,
+				[](unsigned int, const std::vector<double>&) {});
+	} catch (const std::invalid_argument&) {
+		threw = true;
+	}
+	TEST_CHECK(threw);
+
+	const unsigned int threads = ParallelUtils::GetNumberOfThreads();
+	ParallelUtils::SetNumberOfThreads(4);
+	for (int directed = 0; directed < 2; directed++) {
+		TestBallSizes(directed, 40, 60, HyperAnf::DEFAULT_LOG2_REGISTERS, generator);
+		TestBallSizes(directed, 3000, 4500, HyperAnf::DEFAULT_LOG2_REGISTERS, generator);
+		TestBallSizes(directed, 3000, 6000, 10, generator);
+	}
+	ParallelUtils::SetNumberOfThreads(threads);
+	return TestUtils::Summary("HyperAnf_test");
+}
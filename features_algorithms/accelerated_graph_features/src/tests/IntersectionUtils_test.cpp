@@ -0,0 +1,107 @@
+/*
+ * IntersectionUtils_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "IntersectionUtils.h"
+#include "TestUtils.h"
+#include <iterator>
+#include <limits>
+
+// A strictly increasing list of Size distinct values in [Low, High]
+template<typename T>
+static std::vector<T> RandomList(int64 Size, T Low, T High, std::mt19937_64& generator) {
+	std::uniform_int_distribution<T> pick(Low, High);
+	std::vector<T> list;
+	while (static_cast<int64>(list.size()) < Size) {
+		for (int64 i = list.size(); i < Size; i++)
+			list.push_back(pick(generator));
+		std::sort(list.begin(), list.end());
+		list.erase(std::unique(list.begin(), list.end()), list.end());
+	}
+	return list;
+}
+
+/*
+ Count and Intersect must match std::set_intersection, and Intersect must not write past the
+ size of the shorter list.
+ */
+template<typename T>
+static void CheckPair(const std::vector<T>& a, const std::vector<T>& b) {
+	std::vector<T> expected;
+	std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+			std::back_inserter(expected));
+	TEST_CHECK(IntersectionUtils::Count(a.data(), a.size(), b.data(), b.size())
+			== static_cast<int64>(expected.size()));
+
+	const size_t room = std::min(a.size(), b.size());
+	const T GUARD = static_cast<T>(0x5A5A5A5A);
+	std::vector<T> out(room + 16, GUARD);
+	const int64 size = IntersectionUtils::Intersect(a.data(), a.size(), b.data(),
+			b.size(), out.data());
+	TEST_CHECK(size == static_cast<int64>(expected.size()));
+	TEST_CHECK(std::equal(expected.begin(), expected.end(), out.begin()));
+	TEST_CHECK(std::count(out.begin() + room, out.end(), GUARD) == 16);
+}
+
+template<typename T>
+static void CheckBothWays(const std::vector<T>& a, const std::vector<T>& b) {
+	CheckPair(a, b);
+	CheckPair(b, a);
+}
+
+template<typename T>
+static void TestKernel(std::mt19937_64& generator) {
+	const std::vector<T> empty;
+	//every length up to a few vectors, dense (many common values) and sparse
+	for (int64 SizeA = 0; SizeA <= 70; SizeA++)
+		for (int64 SizeB = SizeA; SizeB <= 70; SizeB += 3) {
+			CheckBothWays(RandomList<T>(SizeA, 0, 100, generator),
+					RandomList<T>(SizeB, 0, 100, generator));
+			CheckBothWays(RandomList<T>(SizeA, 0, 5000, generator),
+					RandomList<T>(SizeB, 0, 5000, generator));
+		}
+	//the same list, and lists with no common values
+	const std::vector<T> list = RandomList<T>(1000, 0, 3000, generator);
+	CheckPair(list, list);
+	std::vector<T> odd, even;
+	for (T value = 0; value < 2000; value++)
+		(value % 2 ? odd : even).push_back(value);
+	CheckBothWays(odd, even);
+	//values that don't fit a signed element
+	const T max = std::numeric_limits<T>::max();
+	CheckBothWays(RandomList<T>(300, max - 600, max, generator),
+			RandomList<T>(257, max - 600, max, generator));
+	//very unequal sizes, around the galloping ratio and far beyond it
+	const std::vector<T> large = RandomList<T>(20000, 0, 40000, generator);
+	const int64 small[] = { 0, 1, 2, 7, 20000 / IntersectionUtils::GALLOP_RATIO - 1,
+			20000 / IntersectionUtils::GALLOP_RATIO,
+			20000 / IntersectionUtils::GALLOP_RATIO + 1, 1000 };
+	for (int64 size : small)
+		CheckBothWays(RandomList<T>(size, 0, 40000, generator), large);
+	CheckBothWays(empty, large);
+	CheckBothWays(std::vector<T>(1, large.front()), large);
+	CheckBothWays(std::vector<T>(1, large.back()), large);
+	CheckBothWays(std::vector<T>(1, large.back() + 1), large);
+}
+
+int main() {
+	std::mt19937_64 generator(3);
+	const IntersectionUtils::Kernel kernels[] = { IntersectionUtils::KERNEL_SCALAR,
+			IntersectionUtils::KERNEL_AVX2, IntersectionUtils::KERNEL_AVX512 };
+	const char* names[] = { "scalar", "AVX2", "AVX-512" };
+	const IntersectionUtils::Kernel original = IntersectionUtils::GetKernel();
+	for (IntersectionUtils::Kernel kernel : kernels) {
+		IntersectionUtils::SetKernel(kernel);
+		if (IntersectionUtils::GetKernel() != kernel) {
+			std::cout << "IntersectionUtils_test: the CPU doesn't support the "
+					<< names[kernel] << " kernel, skipped" << std::endl;
+			continue;
+		}
+		TestKernel<unsigned int>(generator);
+		TestKernel<int64>(generator);
+	}
+	IntersectionUtils::SetKernel(original);
+	return TestUtils::Summary("IntersectionUtils_test");
+}
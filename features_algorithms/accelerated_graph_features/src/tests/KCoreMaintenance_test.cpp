@@ -0,0 +1,121 @@
+/*
+ * KCoreMaintenance_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "KCoreMaintenance.h"
+#include "KCoreFeatureCalculator.h"
+#include "TestUtils.h"
+#include <set>
+
+typedef KCoreMaintenance::Edge Edge;
+
+// The edges of the graph as the maintenance sees them (an undirected edge by its smaller end)
+class EdgeSet {
+public:
+	explicit EdgeSet(bool directed) :
+			directed(directed) {
+	}
+	Edge Key(const Edge& edge) const {
+		if (directed || edge.first <= edge.second)
+			return edge;
+		return Edge(edge.second, edge.first);
+	}
+	// Whether the maintenance is expected to insert or remove the edge, which is then applied
+	bool Insert(const Edge& edge) {
+		return edge.first != edge.second && edges.insert(Key(edge)).second;
+	}
+	bool Remove(const Edge& edge) {
+		return edge.first != edge.second && edges.erase(Key(edge)) == 1;
+	}
+	TestUtils::EdgeList List() const {
+		return TestUtils::EdgeList(edges.begin(), edges.end());
+	}
+	std::set<Edge> edges;
+	bool directed;
+};
+
+static std::vector<unsigned int> CoresFromScratch(bool directed, unsigned int n,
+		const EdgeSet& edges, const TestUtils::EdgeList& SelfLoops) {
+	TestUtils::EdgeList list = edges.List();
+	list.insert(list.end(), SelfLoops.begin(), SelfLoops.end());
+	std::sort(list.begin(), list.end());
+	CacheGraph graph(directed);
+	TestUtils::AssignEdges(graph, n, list);
+	KCoreFeatureCalculator calc;
+	calc.setGraph(&graph);
+	return calc.Calculate();
+}
+
+/*
+ Apply random batches of insertions and removals, and compare the maintained core numbers with
+ the core numbers of the changed graph after every batch. The batches repeat edges that are in the
+ graph, remove edges that aren't, add the reverse of directed edges and self loops.
+ */
+static void TestBatches(bool directed, unsigned int n, unsigned int InitialEdges,
+		unsigned int seed) {
+	std::mt19937_64 generator(seed);
+	std::uniform_int_distribution<unsigned int> pick(0, n - 1);
+	const TestUtils::EdgeList initial = TestUtils::RandomEdges(n, InitialEdges, true,
+			generator);
+	EdgeSet edges(directed);
+	TestUtils::EdgeList SelfLoops;
+	for (const Edge& edge : initial)
+		if (edge.first == edge.second)
+			SelfLoops.push_back(edge);
+		else
+			edges.Insert(edge);
+	CacheGraph graph(directed);
+	TestUtils::AssignEdges(graph, n, initial);
+	KCoreMaintenance maintenance(graph);
+	TEST_CHECK(maintenance.GetCores() == CoresFromScratch(directed, n, edges, SelfLoops));
+
+	for (unsigned int batch = 0; batch < 60; batch++) {
+		const bool insert = batch % 3 != 2;
+		std::vector<Edge> changes;
+		const std::vector<Edge> existing(edges.edges.begin(), edges.edges.end());
+		std::uniform_int_distribution<size_t> pickExisting(0,
+				existing.empty() ? 0 : existing.size() - 1);
+		for (unsigned int i = 0; i < 1 + batch % 20; i++) {
+			const unsigned int kind = generator() % 8;
+			if (kind == 0)
+				changes.push_back(Edge(pick(generator), pick(generator)));
+			else if (kind == 1) {
+				const unsigned int node = pick(generator);
+				changes.push_back(Edge(node, node));
+			} else if (kind == 2 && !existing.empty()) {
+				//the reverse of an edge: reciprocal when directed, the same edge otherwise
+				const Edge& edge = existing[pickExisting(generator)];
+				changes.push_back(Edge(edge.second, edge.first));
+			} else if (kind == 3 && !changes.empty())
+				changes.push_back(changes.back());
+			else if (!insert && !existing.empty())
+				changes.push_back(existing[pickExisting(generator)]);
+			else
+				changes.push_back(Edge(pick(generator), pick(generator)));
+		}
+		int64 expected = 0;
+		for (const Edge& edge : changes)
+			expected += insert ? edges.Insert(edge) : edges.Remove(edge);
+		const int64 changed = insert ?
+				maintenance.InsertEdges(changes) : maintenance.RemoveEdges(changes);
+		TEST_CHECK(changed == expected);
+		TEST_CHECK(maintenance.GetCores() == CoresFromScratch(directed, n, edges, SelfLoops));
+	}
+	//remove everything, in random order
+	std::vector<Edge> all(edges.edges.begin(), edges.edges.end());
+	std::shuffle(all.begin(), all.end(), generator);
+	TEST_CHECK(maintenance.RemoveEdges(all) == static_cast<int64>(all.size()));
+	TEST_CHECK(maintenance.GetCores() == std::vector<unsigned int>(n, 0));
+}
+
+int main() {
+	for (int directed = 0; directed < 2; directed++) {
+		TestBatches(directed, 30, 60, 1 + directed);
+		TestBatches(directed, 100, 600, 3 + directed);
+		TestBatches(directed, 500, 2500, 5 + directed);
+		TestBatches(directed, 2000, 20000, 7 + directed);
+	}
+	return TestUtils::Summary("KCoreMaintenance_test");
+}
@@ -0,0 +1,123 @@
+/*
+ * TestUtils.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef TESTS_TESTUTILS_H_
+#define TESTS_TESTUTILS_H_
+
+#include "../includes/CacheGraph.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+/*
+ The tests are plain programs (see the test target of the makefile): every TEST_CHECK that fails
+ prints its place, and the program returns the number of failures.
+ */
+#define TEST_CHECK(condition) TestUtils::Check((condition), #condition, __FILE__, __LINE__)
+
+namespace TestUtils {
+
+inline int& Failures() {
+	static int failures = 0;
+	return failures;
+}
+
+inline bool Check(bool condition, const char* text, const char* file, int line) {
+	if (!condition) {
+		std::cerr << file << ":" << line << ": TEST_CHECK(" << text << ") failed" << std::endl;
+		Failures()++;
+	}
+	return condition;
+}
+
+inline int Summary(const char* name) {
+	std::cout << name << ": " << (Failures() == 0 ? "OK" : "FAILED") << " ("
+			<< Failures() << " failures)" << std::endl;
+	return Failures();
+}
+
+typedef std::vector<std::pair<unsigned int, unsigned int> > EdgeList;
+
+/*
+ NumberOfEdges random edges between NumberOfNodes nodes (without duplicates), with or without
+ self loops.
+ */
+inline EdgeList RandomEdges(unsigned int NumberOfNodes, unsigned int NumberOfEdges,
+		bool SelfLoops, std::mt19937_64& generator) {
+	std::uniform_int_distribution<unsigned int> pick(0, NumberOfNodes - 1);
+	EdgeList edges;
+	for (unsigned int i = 0; i < NumberOfEdges; i++) {
+		const unsigned int from = pick(generator), to = pick(generator);
+		if (from != to || SelfLoops)
+			edges.push_back(std::make_pair(from, to));
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+	return edges;
+}
+
+/*
+ Assign the edges to the graph as sorted neighbor lists; an undirected graph gets both directions
+ of every edge. The weights (one for every edge of the list, or none) follow their edges, and both
+ directions of an undirected edge get the same weight.
+ */
+template<typename GraphT>
+void AssignEdges(GraphT& graph, unsigned int NumberOfNodes, const EdgeList& edges,
+		const std::vector<double>& weights = std::vector<double>()) {
+	std::vector<std::pair<std::pair<unsigned int, unsigned int>, double> > arcs;
+	for (size_t i = 0; i < edges.size(); i++) {
+		const double weight = weights.empty() ? 1 : weights[i];
+		arcs.push_back(std::make_pair(edges[i], weight));
+		if (!graph.isDirected() && edges[i].first != edges[i].second)
+			arcs.push_back(std::make_pair(
+					std::make_pair(edges[i].second, edges[i].first), weight));
+	}
+	std::sort(arcs.begin(), arcs.end());
+	//an undirected edge can be drawn in both directions
+	arcs.erase(std::unique(arcs.begin(), arcs.end(),
+			[](const std::pair<std::pair<unsigned int, unsigned int>, double>& a,
+					const std::pair<std::pair<unsigned int, unsigned int>, double>& b) {
+				return a.first == b.first;
+			}), arcs.end());
+	std::vector<int64> offsets(NumberOfNodes + 1, 0);
+	std::vector<unsigned int> neighbors;
+	std::vector<double> arcWeights;
+	for (const auto& arc : arcs) {
+		offsets[arc.first.first + 1]++;
+		neighbors.push_back(arc.first.second);
+		arcWeights.push_back(arc.second);
+	}
+	for (unsigned int node = 0; node < NumberOfNodes; node++)
+		offsets[node + 1] += offsets[node];
+	if (weights.empty())
+		graph.Assign(offsets, neighbors);
+	else
+		graph.Assign(offsets, neighbors, arcWeights);
+}
+
+/*
+ Whether two graphs have the same nodes, neighbor lists, weights and direction.
+ */
+template<typename GraphT>
+bool SameGraph(const GraphT& a, const GraphT& b) {
+	if (a.GetNumberOfNodes() != b.GetNumberOfNodes()
+			|| a.GetNumberOfEdges() != b.GetNumberOfEdges()
+			|| a.isDirected() != b.isDirected() || a.isWeighted() != b.isWeighted())
+		return false;
+	const int64 n = a.GetNumberOfNodes(), m = a.GetNumberOfEdges();
+	if (!std::equal(a.GetOffsetList(), a.GetOffsetList() + n + 1, b.GetOffsetList()))
+		return false;
+	if (!std::equal(a.GetNeighborList(), a.GetNeighborList() + m, b.GetNeighborList()))
+		return false;
+	return !a.isWeighted()
+			|| std::equal(a.GetWeights(), a.GetWeights() + m, b.GetWeights());
+}
+
+}
+
+#endif /* TESTS_TESTUTILS_H_ */
@@ -18,44 +18,101 @@ ConvertedGNXReciever::ConvertedGNXReciever(dict converted_graph) {
 		weightsList = extract<list>(converted_graph["weights"]);
 
 
+	if (len(offsetList) == 0)
+		throw std::invalid_argument("The offset list of the graph is empty");
+	//node IDs of 32 bits can't hold the nodes of a graph that doesn't fit a CacheGraph
+	const bool largeIds = !CacheGraph::Fits(len(offsetList) - 1, 0);
+
 	this->offsets = new std::vector<int64>();
 	this->offsets->reserve(len(offsetList));
 	this->neighbors = new std::vector<unsigned int>();
-	this->neighbors->reserve(len(neighborList));
+	this->largeNeighbors = largeIds ? new std::vector<int64>() : NULL;
+	if (largeIds)
+		this->largeNeighbors->reserve(len(neighborList));
+	else
+		this->neighbors->reserve(len(neighborList));
 	this->weights = new std::vector<double>();
 
 //	std::cout << "Offset List:" << std::endl;
-	for (int i = 0; i < len(offsetList); ++i) {
+	for (ssize_t i = 0; i < len(offsetList); ++i) {
 //		std::cout << extract<int>(offsetList[i]) << std::endl;
 		int64 currentOffset;
-		currentOffset =
-				static_cast<int64>(extract<unsigned int>(offsetList[i]));
+		currentOffset = extract<int64>(offsetList[i]);
 
 		this->offsets->push_back(currentOffset);
 	}
 
 //	std::cout << "Neighbor List:" << std::endl;
-	for (int i = 0; i < len(neighborList); ++i) {
+	for (ssize_t i = 0; i < len(neighborList); ++i) {
 //		std::cout << extract<int>(neighborList[i]) << std::endl;
+		if (largeIds) {
+			this->largeNeighbors->push_back(extract<int64>(neighborList[i]));
+			continue;
+		}
 		unsigned int currentNeighbor = extract<unsigned int>(neighborList[i]);
 		this->neighbors->push_back(currentNeighbor);
 	}
-	this->mGraph = new CacheGraph(directed);
 	if(withWeights){
-		for (int i = 0; i < len(weightsList); ++i) {
+		for (ssize_t i = 0; i < len(weightsList); ++i) {
 		//		std::cout << extract<int>(neighborList[i]) << std::endl;
 				double currentNeighbor = extract<double>(weightsList[i]);
 				this->weights->push_back(currentNeighbor);
 			}
-		mGraph->Assign(*offsets, *neighbors,*weights);
-
-	}else{
-		mGraph->Assign(*offsets, *neighbors);
-
 	}
+	this->withWeights = withWeights;
+	this->directed = directed;
+	this->newIds = NULL;
+	this->originalIds = NULL;
+	this->mGraph = NULL;
 
+	int ordering = extract<int>(converted_graph.get("ordering", 0));
+	if (ordering != ORDER_ORIGINAL)
+		reorder(static_cast<NodeOrdering>(ordering));
 
+}
 
+/*
+ Relabel the nodes of the recieved lists in the given ordering, and keep the new IDs (and their
+ inverse) so the results can be mapped back.
+ */
+void ConvertedGNXReciever::reorder(NodeOrdering ordering) {
+	if (largeNeighbors != NULL)
+		throw std::invalid_argument(
+				"Graphs with 4G nodes or more can't be reordered");
+	CacheGraph graph(directed), relabeled(directed);
+	if (withWeights)
+		graph.Assign(*offsets, *neighbors, *weights);
+	else
+		graph.Assign(*offsets, *neighbors);
+	this->newIds = new std::vector<unsigned int>(
+			graph.ComputeNodeOrdering(ordering));
+	graph.Relabel(*newIds, relabeled);
+	this->originalIds = new std::vector<unsigned int>(newIds->size());
+	for (unsigned int node = 0; node < newIds->size(); ++node)
+		(*originalIds)[(*newIds)[node]] = node;
+
+	const int64 numOfEdges = relabeled.GetNumberOfEdges();
+	offsets->assign(relabeled.GetOffsetList(),
+			relabeled.GetOffsetList() + relabeled.GetNumberOfNodes() + 1);
+	neighbors->assign(relabeled.GetNeighborList(),
+			relabeled.GetNeighborList() + numOfEdges);
+	if (withWeights)
+		weights->assign(relabeled.GetWeights(),
+				relabeled.GetWeights() + numOfEdges);
+}
+
+/*
+ Build the CacheGraph from the lists the first time it is requested.
+ */
+const CacheGraph* ConvertedGNXReciever::getCacheGraph() {
+	if (mGraph == NULL) {
+		mGraph = new CacheGraph(directed);
+		if (withWeights)
+			mGraph->Assign(*offsets, *neighbors, *weights);
+		else
+			mGraph->Assign(*offsets, *neighbors);
+	}
+	return mGraph;
 }
 
 //ConvertedGNXReciever::ConvertedGNXReciever(const char* loadFileName) {
@@ -81,6 +138,10 @@ ConvertedGNXReciever::~ConvertedGNXReciever() {
 
 	delete offsets;
 	delete neighbors;
+	delete largeNeighbors;
+	delete weights;
+	delete newIds;
+	delete originalIds;
 	delete mGraph;
 }
 
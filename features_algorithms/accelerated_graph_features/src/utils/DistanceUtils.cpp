@@ -1,143 +1,303 @@
 #include "../includes/DistanceUtils.h"
+#include "../includes/ParallelUtils.h"
+#include <cmath>
 
 
 
 
+const int64 DistanceUtils::BOTTOM_UP_EDGES_RATIO;
+const int64 DistanceUtils::TOP_DOWN_NODES_RATIO;
+
 /*
    Calculate the distance of all nodes from a single node (the origin) using BFS.
 
-Assumptions:
-1) The graph is not weighted. For weighted graphs consider using single_source_dijkstra.
-2) There are no loop in the graph
-Input:
-g - a constant pointer to the GraphSnapsot to perform the calculation for
-src - the integer ID of the origin node.
-Output:
-A vector that contains the distances of all the nodes from the origin.
-The distance of node i is in position i in the vector.
-
-The code is based on the code found here:https://www.geeksforgeeks.org/shortest-path-unweighted-graph/
+The nodes are kept in one array in the order they are reached, so every level is a range of it.
+The workspace is reset by the nodes the last BFS reached, so a BFS costs only what it visits
+(and N for every level expanded bottom up).
+The number of unexplored edges is estimated by the out edges of the nodes that weren't reached.
 */
-std::vector<unsigned int> DistanceUtils::BfsSingleSourceShortestPath(const CacheGraph * g,unsigned int src)
+template<typename GraphT>
+void DistanceUtils::Bfs(const GraphT& graph, typename GraphT::node_type src,
+		BfsWorkspaceT<GraphT>& workspace)
 {
-	const unsigned int numOfNodes = g->GetNumberOfNodes();
-
-	std::vector<unsigned int> dist(numOfNodes);
-
-	// a queue to maintain queue of vertices whose
-	// adjacency list is to be scanned as per normal
-	// DFS algorithm
-	std::list<unsigned int> queue;
-
-	// boolean array visited[] which stores the
-	// information whether ith vertex is reached
-	// at least once in the Breadth first search
-	std::vector<bool> visited(numOfNodes);
-
-	// initially all vertices are unvisited
-	// so v[i] for all i is false
-	// and as no path is yet constructed
-	// dist[i] for all i set to infinity
-	for (int i = 0; i < numOfNodes; i++) {
-		visited[i] = false;
-		dist[i] = INT_MAX;
+	typedef typename GraphT::node_type NodeId;
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	std::vector<unsigned int>& dist = workspace.m_Distances;
+	std::vector<NodeId>& order = workspace.m_Order;
+	std::vector<int64>& levels = workspace.m_Levels;
+	std::vector<int64>& frontier = workspace.m_Frontier;
+	if (dist.size() != static_cast<size_t>(numOfNodes)) {
+		dist.assign(numOfNodes, BfsWorkspaceT<GraphT>::UNREACHABLE);
+		order.resize(numOfNodes);
+		frontier.assign((numOfNodes + 63) / 64, 0);
+	} else {
+		for (int64 i = 0; i < workspace.GetNumberOfReached(); i++)
+			dist[order[i]] = BfsWorkspaceT<GraphT>::UNREACHABLE;
 	}
 
-	// now source is first to be visited and
-	// distance from source to itself should be 0
-	visited[src] = true;
+	const auto* offsets = graph.GetOffsetList();
 	dist[src] = 0;
-	queue.push_back(src);
-
-	//Get the neighbors
-	const unsigned int* neighborList = g->GetNeighborList();
-	const int64* offsetList = g->GetOffsetList();
-
-	// standard BFS algorithm
-	while (!queue.empty()) {
-		int u = queue.front();
-		queue.pop_front();
-		//	for (int i = 0; i < adj[u].size(); i++) {
-		//		if (visited[adj[u][i]] == false) {
-		//			visited[adj[u][i]] = true;
-		//			dist[adj[u][i]] = dist[u] + 1;
-		//			pred[adj[u][i]] = u;
-		//			queue.push_back(adj[u][i]);
-
-		//			// We stop BFS when we find
-		//			// destination.
-		//			if (adj[u][i] == dest)
-		//				return true;
-		//		}
-		//	}
-		//}
-
-		int64 begin_offset, end_offset;
-		begin_offset = offsetList[u];
-		end_offset = offsetList[u + 1];
-
-		for (auto p = neighborList + begin_offset; p < neighborList + end_offset; ++p)
-		{
-			//p is a pointer to the nodes in the adjacency list.
-			//Example usage: the offset of the current node is offsetList[*p]
-			//In this case, p iterates over the neighbors of u
-			if (!visited[*p]) {
-				visited[*p] = true;
-				dist[*p] = dist[u] + 1;
-				queue.push_back(*p);
+	order[0] = src;
+	levels.clear();
+	levels.push_back(0);
+	levels.push_back(1);
+	int64 reached = 1;
+	int64 frontierEdges = offsets[src + 1] - offsets[src];
+	int64 unexploredEdges = graph.GetNumberOfEdges() - frontierEdges;
+	bool bottomUp = false;
+	for (unsigned int level = 0; levels[level] < levels[level + 1]; level++) {
+		const int64 begin = levels[level], end = levels[level + 1];
+		if (!bottomUp)
+			bottomUp = frontierEdges > unexploredEdges / BOTTOM_UP_EDGES_RATIO;
+		else
+			bottomUp = end - begin >= numOfNodes / TOP_DOWN_NODES_RATIO;
+		frontierEdges = 0;
+		if (!bottomUp) {
+			for (int64 i = begin; i < end; i++)
+				//p iterates over the neighbors of u (the list may be compressed, see CacheGraph::neighbors)
+				for (NodeId p : graph.neighbors(order[i]))
+					if (dist[p] == BfsWorkspaceT<GraphT>::UNREACHABLE) {
+						dist[p] = level + 1;
+						order[reached++] = p;
+						frontierEdges += offsets[p + 1] - offsets[p];
+					}
+		} else {
+			const GraphT& inGraph = graph.isDirected() ? graph.inverse() : graph;
+			for (int64 i = begin; i < end; i++)
+				frontier[order[i] >> 6] |= 1ULL << (order[i] & 63);
+			for (int64 v = 0; v < numOfNodes; v++) {
+				if (dist[v] != BfsWorkspaceT<GraphT>::UNREACHABLE)
+					continue;
+				for (NodeId p : inGraph.neighbors(static_cast<NodeId>(v)))
+					if (frontier[p >> 6] & (1ULL << (p & 63))) {
+						dist[v] = level + 1;
+						order[reached++] = static_cast<NodeId>(v);
+						frontierEdges += offsets[v + 1] - offsets[v];
+						break;
+					}
 			}
-
+			for (int64 i = begin; i < end; i++)
+				frontier[order[i] >> 6] = 0;
 		}
-
+		unexploredEdges -= frontierEdges;
+		levels.push_back(reached);
+	}
+	//the last level is empty
+	levels.pop_back();
 }
 
-for (int i = 0; i < numOfNodes; i++) {
-	if(dist[i] == INT_MAX)
-		dist[i] = 0;
+/*
+   The distances of a BFS (see Bfs) as a vector, where the nodes src doesn't reach get 0 like src
+   itself.
+*/
+std::vector<unsigned int> DistanceUtils::BfsSingleSourceShortestPath(const CacheGraph * g,unsigned int src)
+{
+	BfsWorkspace workspace;
+	Bfs(*g, src, workspace);
+	std::vector<unsigned int> dist(workspace.GetDistances());
+	for (unsigned int& d : dist)
+		if (d == BfsWorkspace::UNREACHABLE)
+			d = 0;
+	return dist;
 }
 
 
-
-return dist;
+template<typename GraphT>
+void DistanceUtils::CheckWeights(const GraphT& graph, DijkstraWorkspaceT<GraphT>& workspace)
+{
+	if (!graph.isWeighted()) {
+		workspace.m_WeightsOf = NULL;
+		workspace.m_IntegerWeights = true;
+		return;
+	}
+	const double* weights = graph.GetWeights();
+	if (workspace.m_WeightsOf == weights)
+		return;
+	//integer distances must stay exact as doubles
+	const double maxInteger = 9007199254740992.0 / std::max<int64>(graph.GetNumberOfNodes(), 1);
+	bool integers = true;
+	for (int64 edge = 0; edge < graph.GetNumberOfEdges(); edge++) {
+		if (!(weights[edge] >= 0))
+			throw std::invalid_argument("Dijkstra needs non-negative weights");
+		integers = integers && weights[edge] == std::floor(weights[edge])
+				&& weights[edge] < maxInteger;
+	}
+	workspace.m_WeightsOf = weights;
+	workspace.m_IntegerWeights = integers;
 }
 
-
 /*
-   Calculate the distance of all nodes from a single source using Dijkstra's algorithm.
-Assumptions:
-1) The graph has no negative weights
-
-Input:
-g - a constant pointer to the GraphSnapsot to perfom the calculation for
-src - the integer ID of the origin node.
-
-Output:
-A vector that contains the distances of all the nodes from the origin.
-The distance of node i is in position i in the vector.
-
-The code is based on the code found here:https://www.geeksforgeeks.org/greedy-algorithms-set-6-dijkstras-shortest-path-algorithm/
-
+   Dijkstra's algorithm, where every node is settled when it leaves the heap.
+The workspace is reset by the nodes the last source reached, like a BFS workspace.
 */
-std::vector<float> DistanceUtils::DijkstraSingleSourceShortestPath(const CacheGraph * g, int src)
+template<typename GraphT>
+void DistanceUtils::Dijkstra(const GraphT& graph, typename GraphT::node_type src,
+		DijkstraWorkspaceT<GraphT>& workspace)
 {
-	const int numOfNodes = g->GetNumberOfNodes();
-
-	//dist contains the shortest distance from src to other nodes
-	std::vector<float> dist(numOfNodes);
-
-	//sptSet[i] will be true if the distance to i is finalized
-	std::vector<bool> sptSet(numOfNodes);
-
-	//Init all distanced to INFINITY and sptSet to false
-	for (int i = 0; i < numOfNodes; i++)
-		dist[i] = INT_MAX, sptSet[i] = false;
-
-	//use the dijkstra algorithm to calculate the minimun distances
+	typedef typename GraphT::node_type NodeId;
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	const double infinity = std::numeric_limits<double>::infinity();
+	std::vector<double>& dist = workspace.m_Distances;
+	std::vector<NodeId>& order = workspace.m_Order;
+	if (dist.size() != static_cast<size_t>(numOfNodes)) {
+		dist.assign(numOfNodes, infinity);
+		order.resize(numOfNodes);
+		workspace.m_Heap.Reset(numOfNodes);
+	} else {
+		for (int64 i = 0; i < workspace.m_NumberOfReached; i++)
+			dist[order[i]] = infinity;
+	}
+	CheckWeights(graph, workspace);
+	const double* weights = graph.isWeighted() ? graph.GetWeights() : NULL;
 
-	FibQueue<float> priorityQueue;
+	int64 reached = 0;
+	dist[src] = 0;
+	if (workspace.m_IntegerWeights) {
+		RadixHeap<NodeId>& heap = workspace.m_RadixHeap;
+		heap.Clear();
+		heap.Push(0, src);
+		while (!heap.Empty()) {
+			const std::pair<int64, NodeId> top = heap.Pop();
+			const NodeId u = top.second;
+			//an entry of a node that was pushed again with a smaller distance
+			if (top.first > dist[u])
+				continue;
+			order[reached++] = u;
+			const typename GraphT::NeighborRange neighbors = graph.neighbors(u);
+			for (typename GraphT::NeighborIterator it = neighbors.begin(); it != neighbors.end();
+					++it) {
+				const int64 candidate = top.first
+						+ (weights ? static_cast<int64>(weights[it.edge()]) : 1);
+				if (candidate < dist[*it]) {
+					dist[*it] = candidate;
+					heap.Push(candidate, *it);
+				}
+			}
+		}
+	} else {
+		IndexedDaryHeap<double, NodeId>& heap = workspace.m_Heap;
+		heap.Clear();
+		heap.PushOrDecrease(src, 0);
+		while (!heap.Empty()) {
+			const NodeId u = heap.Top();
+			heap.Pop();
+			order[reached++] = u;
+			const typename GraphT::NeighborRange neighbors = graph.neighbors(u);
+			for (typename GraphT::NeighborIterator it = neighbors.begin(); it != neighbors.end();
+					++it) {
+				const double candidate = dist[u] + weights[it.edge()];
+				if (candidate < dist[*it]) {
+					dist[*it] = candidate;
+					heap.PushOrDecrease(*it, candidate);
+				}
+			}
+		}
+	}
+	workspace.m_NumberOfReached = reached;
+}
 
+/*
+   Every phase, the nodes of the lowest bucket whose distance is still in it (the bucket may have
+stale and repeated entries) relax their edges in parallel into requests of every thread, while
+the distances are only read, and the requests are then applied serially.
+*/
+template<typename GraphT>
+void DistanceUtils::DeltaStepping(const GraphT& graph, typename GraphT::node_type src,
+		double delta, std::vector<double>& distances)
+{
+	typedef typename GraphT::node_type NodeId;
+	typedef std::pair<NodeId, double> Request;
+	const int64 numOfNodes = graph.GetNumberOfNodes();
+	const double infinity = std::numeric_limits<double>::infinity();
+	const double* weights = graph.isWeighted() ? graph.GetWeights() : NULL;
+	if (weights)
+		for (int64 edge = 0; edge < graph.GetNumberOfEdges(); edge++)
+			if (!(weights[edge] >= 0))
+				throw std::invalid_argument("Delta-stepping needs non-negative weights");
+	if (delta <= 0) {
+		double total = 0;
+		for (int64 edge = 0; weights && edge < graph.GetNumberOfEdges(); edge++)
+			total += weights[edge];
+		delta = weights && total > 0 ? total / graph.GetNumberOfEdges() : 1;
+	}
 
+	distances.assign(numOfNodes, infinity);
+	distances[src] = 0;
+	//the distance every node last relaxed its light edges with, and the nodes of the bucket
+	std::vector<double> relaxed(numOfNodes, -1);
+	std::vector<std::vector<NodeId> > buckets(1, std::vector<NodeId>(1, src));
+	std::vector<NodeId> frontier, settled;
+	std::vector<std::vector<Request> > requests(ParallelUtils::GetNumberOfThreads());
+	auto relax = [&](const std::vector<NodeId>& nodes, bool light) {
+		ParallelUtils::ParallelFor(0, nodes.size(), 64,
+				[&](unsigned int t, int64 i) {
+					const NodeId u = nodes[i];
+					const typename GraphT::NeighborRange neighbors = graph.neighbors(u);
+					for (typename GraphT::NeighborIterator it = neighbors.begin();
+							it != neighbors.end(); ++it) {
+						const double weight = weights ? weights[it.edge()] : 1;
+						if ((weight <= delta) == light && distances[u] + weight < distances[*it])
+							requests[t].push_back(Request(*it, distances[u] + weight));
+					}
+				});
+		for (std::vector<Request>& threadRequests : requests) {
+			for (const Request& request : threadRequests)
+				if (request.second < distances[request.first]) {
+					distances[request.first] = request.second;
+					const size_t bucket = static_cast<size_t>(request.second / delta);
+					if (buckets.size() <= bucket)
+						buckets.resize(bucket + 1);
+					buckets[bucket].push_back(request.first);
+				}
+			threadRequests.clear();
+		}
+	};
+
+	for (size_t b = 0; b < buckets.size(); b++) {
+		settled.clear();
+		while (!buckets[b].empty()) {
+			frontier.clear();
+			for (NodeId u : buckets[b])
+				if (static_cast<size_t>(distances[u] / delta) == b && relaxed[u] != distances[u]) {
+					relaxed[u] = distances[u];
+					frontier.push_back(u);
+				}
+			buckets[b].clear();
+			settled.insert(settled.end(), frontier.begin(), frontier.end());
+			relax(frontier, true);
+		}
+		std::sort(settled.begin(), settled.end());
+		settled.erase(std::unique(settled.begin(), settled.end()), settled.end());
+		relax(settled, false);
+	}
+}
 
+std::vector<float> DistanceUtils::DijkstraSingleSourceShortestPath(const CacheGraph * g, int src)
+{
+	DijkstraWorkspace workspace;
+	Dijkstra(*g, src, workspace);
+	std::vector<float> dist(workspace.GetDistances().begin(), workspace.GetDistances().end());
+	for (float& d : dist)
+		if (d == std::numeric_limits<float>::infinity())
+			d = INT_MAX;
 	return dist;
 }
 
+template void DistanceUtils::Bfs<CompactCacheGraph>(const CompactCacheGraph&,
+		CompactCacheGraph::node_type, BfsWorkspaceT<CompactCacheGraph>&);
+template void DistanceUtils::Bfs<CacheGraph>(const CacheGraph&,
+		CacheGraph::node_type, BfsWorkspaceT<CacheGraph>&);
+template void DistanceUtils::Bfs<LargeCacheGraph>(const LargeCacheGraph&,
+		LargeCacheGraph::node_type, BfsWorkspaceT<LargeCacheGraph>&);
+template void DistanceUtils::Dijkstra<CompactCacheGraph>(const CompactCacheGraph&,
+		CompactCacheGraph::node_type, DijkstraWorkspaceT<CompactCacheGraph>&);
+template void DistanceUtils::Dijkstra<CacheGraph>(const CacheGraph&,
+		CacheGraph::node_type, DijkstraWorkspaceT<CacheGraph>&);
+template void DistanceUtils::Dijkstra<LargeCacheGraph>(const LargeCacheGraph&,
+		LargeCacheGraph::node_type, DijkstraWorkspaceT<LargeCacheGraph>&);
+template void DistanceUtils::DeltaStepping<CompactCacheGraph>(const CompactCacheGraph&,
+		CompactCacheGraph::node_type, double, std::vector<double>&);
+template void DistanceUtils::DeltaStepping<CacheGraph>(const CacheGraph&,
+		CacheGraph::node_type, double, std::vector<double>&);
+template void DistanceUtils::DeltaStepping<LargeCacheGraph>(const LargeCacheGraph&,
+		LargeCacheGraph::node_type, double, std::vector<double>&);
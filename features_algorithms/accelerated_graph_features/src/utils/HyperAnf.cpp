@@ -0,0 +1,108 @@
+/*
+ * HyperAnf.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "../includes/HyperAnf.h"
+#include <cmath>
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <immintrin.h>
+#define HYPERANF_X86
+#endif
+
+const unsigned int HyperAnf::MIN_LOG2_REGISTERS;
+const unsigned int HyperAnf::MAX_LOG2_REGISTERS;
+const unsigned int HyperAnf::DEFAULT_LOG2_REGISTERS;
+const int64 HyperAnf::MERGE_GRAIN;
+
+/*
+ The element is hashed by the splitmix64 finalizer: the low Log2Registers bits pick the register,
+ and the register gets the position of the lowest set bit of the rest.
+ */
+void HyperAnf::Initialize(unsigned char* registers, unsigned int Log2Registers, int64 element,
+		unsigned int seed) {
+	const unsigned int numOfRegisters = 1u << Log2Registers;
+	std::memset(registers, 0, numOfRegisters);
+	int64 hash = element + (static_cast<int64>(seed) + 1) * 0x9E3779B97F4A7C15ULL;
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+	hash ^= hash >> 31;
+	const int64 rest = hash >> Log2Registers;
+	registers[hash & (numOfRegisters - 1)] = static_cast<unsigned char>(
+			rest == 0 ? 64 - Log2Registers + 1 : __builtin_ctzll(rest) + 1);
+}
+
+double HyperAnf::Estimate(const unsigned char* registers, unsigned int NumberOfRegisters) {
+	const double m = NumberOfRegisters;
+	double sum = 0;
+	unsigned int zeros = 0;
+	for (unsigned int i = 0; i < NumberOfRegisters; i++) {
+		sum += std::ldexp(1.0, -static_cast<int>(registers[i]));
+		zeros += registers[i] == 0;
+	}
+	const double alpha = NumberOfRegisters == 16 ? 0.673 : NumberOfRegisters == 32 ? 0.697 :
+			NumberOfRegisters == 64 ? 0.709 : 0.7213 / (1 + 1.079 / m);
+	const double estimate = alpha * m * m / sum;
+	if (estimate <= 2.5 * m && zeros > 0)
+		return m * std::log(m / zeros);
+	return estimate;
+}
+
+#ifdef HYPERANF_X86
+static bool MergeSse2(unsigned char* to, const unsigned char* from,
+		unsigned int NumberOfRegisters) {
+	int changed = 0;
+	for (unsigned int i = 0; i < NumberOfRegisters; i += 16) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(to + i));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+		const __m128i merged = _mm_max_epu8(a, b);
+		changed |= _mm_movemask_epi8(_mm_cmpeq_epi8(merged, a)) ^ 0xFFFF;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), merged);
+	}
+	return changed != 0;
+}
+
+__attribute__((target("avx2")))
+static bool MergeAvx2(unsigned char* to, const unsigned char* from,
+		unsigned int NumberOfRegisters) {
+	unsigned int changed = 0;
+	for (unsigned int i = 0; i < NumberOfRegisters; i += 32) {
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(to + i));
+		const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i));
+		const __m256i merged = _mm256_max_epu8(a, b);
+		changed |= ~static_cast<unsigned int>(_mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(merged, a)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i), merged);
+	}
+	return changed != 0;
+}
+
+static bool SupportsAvx2() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+static const bool s_Avx2 = SupportsAvx2();
+#endif
+
+/*
+ The counters have at least 16 registers, a multiple of the 16 bytes of SSE2 (which every x86-64
+ CPU has), and those with 32 or more are merged with AVX2 when the CPU supports it.
+ */
+bool HyperAnf::Merge(unsigned char* to, const unsigned char* from,
+		unsigned int NumberOfRegisters) {
+#ifdef HYPERANF_X86
+	if (s_Avx2 && NumberOfRegisters >= 32)
+		return MergeAvx2(to, from, NumberOfRegisters);
+	return MergeSse2(to, from, NumberOfRegisters);
+#else
+	bool changed = false;
+	for (unsigned int i = 0; i < NumberOfRegisters; i++)
+		if (from[i] > to[i]) {
+			to[i] = from[i];
+			changed = true;
+		}
+	return changed;
+#endif
+}
@@ -0,0 +1,216 @@
+/*
+ * IntersectionUtils.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "../includes/IntersectionUtils.h"
+#include <immintrin.h>
+
+IntersectionUtils::Kernel IntersectionUtils::s_Kernel =
+		IntersectionUtils::DetectKernel();
+
+const int64 IntersectionUtils::GALLOP_RATIO;
+
+bool IntersectionUtils::Supported(Kernel kernel) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	switch (kernel) {
+	case KERNEL_AVX512:
+		return __builtin_cpu_supports("avx512f");
+	case KERNEL_AVX2:
+		return __builtin_cpu_supports("avx2");
+	default:
+		return true;
+	}
+#else
+	return kernel == KERNEL_SCALAR;
+#endif
+}
+
+IntersectionUtils::Kernel IntersectionUtils::DetectKernel() {
+	if (Supported(KERNEL_AVX512))
+		return KERNEL_AVX512;
+	if (Supported(KERNEL_AVX2))
+		return KERNEL_AVX2;
+	return KERNEL_SCALAR;
+}
+
+IntersectionUtils::Kernel IntersectionUtils::GetKernel() {
+	return s_Kernel;
+}
+
+void IntersectionUtils::SetKernel(Kernel kernel) {
+	if (Supported(kernel))
+		s_Kernel = kernel;
+}
+
+template<typename T>
+int64 IntersectionUtils::Count(const T* a, int64 SizeA, const T* b,
+		int64 SizeB) {
+	return Run<T, false>(a, SizeA, b, SizeB, NULL);
+}
+
+template<typename T>
+int64 IntersectionUtils::Intersect(const T* a, int64 SizeA, const T* b,
+		int64 SizeB, T* out) {
+	return Run<T, true>(a, SizeA, b, SizeB, out);
+}
+
+template<typename T, bool Store>
+int64 IntersectionUtils::Run(const T* a, int64 SizeA, const T* b,
+		int64 SizeB, T* out) {
+	if (SizeA == 0 || SizeB == 0)
+		return 0;
+	//no overlap between the ranges of the lists
+	if (a[SizeA - 1] < b[0] || b[SizeB - 1] < a[0])
+		return 0;
+	if (SizeA > SizeB * GALLOP_RATIO)
+		return Gallop<T, Store>(b, SizeB, a, SizeA, out);
+	if (SizeB > SizeA * GALLOP_RATIO)
+		return Gallop<T, Store>(a, SizeA, b, SizeB, out);
+	if (sizeof(T) == sizeof(unsigned int)) {
+		const unsigned int* a32 = reinterpret_cast<const unsigned int*>(a);
+		const unsigned int* b32 = reinterpret_cast<const unsigned int*>(b);
+		unsigned int* out32 = reinterpret_cast<unsigned int*>(out);
+		if (s_Kernel == KERNEL_AVX512)
+			return MergeAVX512(a32, SizeA, b32, SizeB, out32);
+		if (s_Kernel == KERNEL_AVX2)
+			return MergeAVX2(a32, SizeA, b32, SizeB, out32);
+	}
+	return Merge<T, Store>(a, SizeA, b, SizeB, out);
+}
+
+template<typename T, bool Store>
+int64 IntersectionUtils::Merge(const T* a, int64 SizeA, const T* b,
+		int64 SizeB, T* out) {
+	int64 i = 0, j = 0, count = 0;
+	while (i < SizeA && j < SizeB) {
+		const T x = a[i], y = b[j];
+		if (Store && x == y)
+			out[count] = x;
+		count += (x == y);
+		//branch free advance, both lists move on a match
+		i += (x <= y);
+		j += (y <= x);
+	}
+	return count;
+}
+
+/*
+ Search every element of the short list in the long one: first double the step from the last
+ position found until passing the element, and then binary search the last step.
+ */
+template<typename T, bool Store>
+int64 IntersectionUtils::Gallop(const T* small, int64 SizeSmall,
+		const T* large, int64 SizeLarge, T* out) {
+	int64 count = 0, position = 0;
+	for (int64 i = 0; i < SizeSmall && position < SizeLarge; i++) {
+		const T value = small[i];
+		int64 step = 1, low = position, high = position;
+		while (high < SizeLarge && large[high] < value) {
+			low = high + 1;
+			high += step;
+			step <<= 1;
+		}
+		if (high > SizeLarge)
+			high = SizeLarge;
+		//the first element not smaller than value is in [low, high]
+		while (low < high) {
+			const int64 middle = low + (high - low) / 2;
+			if (large[middle] < value)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+		position = low;
+		if (position < SizeLarge && large[position] == value) {
+			if (Store)
+				out[count] = value;
+			count++;
+			position++;
+		}
+	}
+	return count;
+}
+
+/*
+ The vector kernels compare a block of each list with all of the rotations of the other block, so
+ that every pair of elements of the two blocks is compared, and then move on the block with the
+ smaller maximum (or both). The elements found are the ones of a's block, which keeps them in order.
+ The rest of the lists (less than a block) is merged as usual.
+ */
+__attribute__((target("avx2")))
+int64 IntersectionUtils::MergeAVX2(const unsigned int* a, int64 SizeA,
+		const unsigned int* b, int64 SizeB, unsigned int* out) {
+	int64 i = 0, j = 0, count = 0;
+	const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+	while (i + 8 <= SizeA && j + 8 <= SizeB) {
+		const __m256i va = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(a + i));
+		__m256i vb = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(b + j));
+		__m256i found = _mm256_cmpeq_epi32(va, vb);
+		for (int r = 1; r < 8; r++) {
+			vb = _mm256_permutevar8x32_epi32(vb, rotate);
+			found = _mm256_or_si256(found, _mm256_cmpeq_epi32(va, vb));
+		}
+		unsigned int mask = _mm256_movemask_ps(_mm256_castsi256_ps(found));
+		if (out != NULL) {
+			for (; mask != 0; mask &= mask - 1)
+				out[count++] = a[i + __builtin_ctz(mask)];
+		} else
+			count += __builtin_popcount(mask);
+		const unsigned int MaxA = a[i + 7], MaxB = b[j + 7];
+		i += (MaxA <= MaxB) ? 8 : 0;
+		j += (MaxB <= MaxA) ? 8 : 0;
+	}
+	if (out != NULL)
+		return count
+				+ Merge<unsigned int, true>(a + i, SizeA - i, b + j, SizeB - j,
+						out + count);
+	return count
+			+ Merge<unsigned int, false>(a + i, SizeA - i, b + j, SizeB - j,
+					NULL);
+}
+
+__attribute__((target("avx512f")))
+int64 IntersectionUtils::MergeAVX512(const unsigned int* a, int64 SizeA,
+		const unsigned int* b, int64 SizeB, unsigned int* out) {
+	int64 i = 0, j = 0, count = 0;
+	while (i + 16 <= SizeA && j + 16 <= SizeB) {
+		const __m512i va = _mm512_loadu_si512(a + i);
+		const __m512i vb = _mm512_loadu_si512(b + j);
+		//the rotations are independent of each other, so they don't wait for one another
+		__mmask16 found = _mm512_cmpeq_epi32_mask(va, vb);
+#define INTERSECT_ROTATION(r) found |= _mm512_cmpeq_epi32_mask(va, _mm512_alignr_epi32(vb, vb, r))
+		INTERSECT_ROTATION(1); INTERSECT_ROTATION(2); INTERSECT_ROTATION(3);
+		INTERSECT_ROTATION(4); INTERSECT_ROTATION(5); INTERSECT_ROTATION(6);
+		INTERSECT_ROTATION(7); INTERSECT_ROTATION(8); INTERSECT_ROTATION(9);
+		INTERSECT_ROTATION(10); INTERSECT_ROTATION(11); INTERSECT_ROTATION(12);
+		INTERSECT_ROTATION(13); INTERSECT_ROTATION(14); INTERSECT_ROTATION(15);
+#undef INTERSECT_ROTATION
+		if (out != NULL)
+			_mm512_mask_compressstoreu_epi32(out + count, found, va);
+		count += __builtin_popcount(found);
+		const unsigned int MaxA = a[i + 15], MaxB = b[j + 15];
+		i += (MaxA <= MaxB) ? 16 : 0;
+		j += (MaxB <= MaxA) ? 16 : 0;
+	}
+	if (out != NULL)
+		return count
+				+ Merge<unsigned int, true>(a + i, SizeA - i, b + j, SizeB - j,
+						out + count);
+	return count
+			+ Merge<unsigned int, false>(a + i, SizeA - i, b + j, SizeB - j,
+					NULL);
+}
+
+template int64 IntersectionUtils::Count<unsigned int>(const unsigned int*,
+		int64, const unsigned int*, int64);
+template int64 IntersectionUtils::Count<int64>(const int64*, int64,
+		const int64*, int64);
+template int64 IntersectionUtils::Intersect<unsigned int>(const unsigned int*,
+		int64, const unsigned int*, int64, unsigned int*);
+template int64 IntersectionUtils::Intersect<int64>(const int64*, int64,
+		const int64*, int64, int64*);
@@ -0,0 +1,36 @@
+/*
+ * ParallelUtils.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "../includes/ParallelUtils.h"
+
+unsigned int ParallelUtils::numberOfThreads = 0;
+
+/*
+ The number of threads to use. Unless set explicitly, this is the number of
+ hardware threads on the machine.
+ */
+unsigned int ParallelUtils::GetNumberOfThreads() {
+	if (numberOfThreads == 0)
+		return std::max(std::thread::hardware_concurrency(), 1u);
+	return numberOfThreads;
+}
+
+/*
+ Set the number of threads to use. 0 returns to the default.
+ */
+void ParallelUtils::SetNumberOfThreads(unsigned int NumberOfThreads) {
+	numberOfThreads = NumberOfThreads;
+}
+
+/*
+ The number of threads worth using for the given amount of work, so that small
+ inputs don't pay for starting threads.
+ */
+unsigned int ParallelUtils::ThreadsForWork(int64 work) {
+	int64 threads = work / MIN_WORK_PER_THREAD + 1;
+	return static_cast<unsigned int>(std::min<int64>(threads,
+			GetNumberOfThreads()));
+}
@@ -0,0 +1,103 @@
+/*
+ * PivotSampling.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "../includes/PivotSampling.h"
+#include "../includes/CacheGraph.h"
+#include <algorithm>
+#include <random>
+
+const double PivotSampling::CONFIDENCE_Z = 1.959963984540054;
+const int64 PivotSampling::ACCUMULATE_GRAIN;
+
+template<typename GraphT>
+void PivotSampling::SamplePivots(const GraphT& graph,
+		unsigned int NumberOfPivots, unsigned int seed, bool stratified,
+		std::vector<typename GraphT::node_type>& pivots,
+		std::vector<double>& weights) {
+	typedef typename GraphT::node_type NodeId;
+	const int64 NumberOfNodes = graph.GetNumberOfNodes();
+	std::mt19937_64 generator(seed);
+
+	//the nodes of every stratum, a single one for uniform sampling
+	std::vector<std::vector<NodeId> > strata(1);
+	if (stratified) {
+		const std::vector<NodeId>& degrees =
+				graph.isDirected() ? graph.undirected().degrees() : graph.degrees();
+		for (int64 node = 0; node < NumberOfNodes; node++) {
+			unsigned int stratum = 0;
+			while ((static_cast<int64>(degrees[node]) + 1) >> (stratum + 1))
+				stratum++;
+			if (strata.size() <= stratum)
+				strata.resize(stratum + 1);
+			strata[stratum].push_back(static_cast<NodeId>(node));
+		}
+	} else {
+		strata[0].resize(NumberOfNodes);
+		for (int64 node = 0; node < NumberOfNodes; node++)
+			strata[0][node] = static_cast<NodeId>(node);
+	}
+
+	//proportional allocation with the largest remainders, and a pivot for every stratum first
+	const int64 k = std::min<int64>(NumberOfPivots, NumberOfNodes);
+	std::vector<int64> allocation(strata.size(), 0);
+	int64 allocated = 0, nonEmpty = 0;
+	for (const std::vector<NodeId>& stratum : strata)
+		nonEmpty += !stratum.empty();
+	const bool everyStratum = k >= nonEmpty;
+	std::vector<std::pair<double, size_t> > remainders;
+	for (size_t h = 0; h < strata.size(); h++) {
+		if (strata[h].empty())
+			continue;
+		const double share = static_cast<double>(k) * strata[h].size() / NumberOfNodes;
+		allocation[h] = std::min<int64>(strata[h].size(),
+				std::max<int64>(everyStratum ? 1 : 0, static_cast<int64>(share)));
+		allocated += allocation[h];
+		remainders.push_back(std::make_pair(share - allocation[h], h));
+	}
+	std::sort(remainders.begin(), remainders.end(),
+			[](const std::pair<double, size_t>& a, const std::pair<double, size_t>& b) {
+				return a.first > b.first;
+			});
+	//hand out the rest by the remainders, and take back from the strata that got the most
+	for (size_t i = 0; allocated < k; i = (i + 1) % remainders.size()) {
+		const size_t h = remainders[i].second;
+		if (allocation[h] < static_cast<int64>(strata[h].size())) {
+			allocation[h]++;
+			allocated++;
+		}
+	}
+	while (allocated > k) {
+		size_t largest = 0;
+		for (size_t h = 1; h < strata.size(); h++)
+			if (allocation[h] > allocation[largest])
+				largest = h;
+		allocation[largest]--;
+		allocated--;
+	}
+
+	pivots.clear();
+	weights.clear();
+	for (size_t h = 0; h < strata.size(); h++) {
+		std::vector<NodeId>& stratum = strata[h];
+		//a partial Fisher-Yates shuffle
+		for (int64 i = 0; i < allocation[h]; i++) {
+			std::uniform_int_distribution<int64> pick(i, stratum.size() - 1);
+			std::swap(stratum[i], stratum[pick(generator)]);
+			pivots.push_back(stratum[i]);
+			weights.push_back(static_cast<double>(stratum.size()) / allocation[h]);
+		}
+	}
+}
+
+template void PivotSampling::SamplePivots<CompactCacheGraph>(
+		const CompactCacheGraph&, unsigned int, unsigned int, bool,
+		std::vector<CompactCacheGraph::node_type>&, std::vector<double>&);
+template void PivotSampling::SamplePivots<CacheGraph>(const CacheGraph&,
+		unsigned int, unsigned int, bool, std::vector<CacheGraph::node_type>&,
+		std::vector<double>&);
+template void PivotSampling::SamplePivots<LargeCacheGraph>(
+		const LargeCacheGraph&, unsigned int, unsigned int, bool,
+		std::vector<LargeCacheGraph::node_type>&, std::vector<double>&);
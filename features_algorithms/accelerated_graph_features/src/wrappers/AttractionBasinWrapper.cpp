@@ -9,16 +9,89 @@
 
 
 void BoostDefAttractionBasinCalculator() {
-	def("attraction_basin",AttractionBasinCalculatorWrapper);
+	py::list (*exact)(dict, int) = AttractionBasinCalculatorWrapper;
+	py::list (*sampled)(dict, int, unsigned int, unsigned int, bool) = AttractionBasinCalculatorWrapper;
+	def("attraction_basin", exact);
+	def("attraction_basin", sampled);
+	def("attraction_basin_hyperanf", AttractionBasinHyperAnfWrapper);
 }
+/*
+ Runs the calculator on the graph in whichever index widths the reciever picked for it.
+ */
+struct AttractionBasinDispatch {
+	typedef std::vector<double> result_type;
+	int alpha;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		AttractionBasinCalculatorT<GraphT> calc(alpha);
+		calc.setGraph(&graph);
+		std::vector<double>* res = calc.Calculate();
+		result_type features(*res);
+		delete res;
+		return features;
+	}
+};
+
+struct HyperAnfAttractionBasinDispatch {
+	typedef std::vector<double> result_type;
+	int alpha;
+	unsigned int log2Registers;
+	unsigned int seed;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		AttractionBasinCalculatorT<GraphT> calc(alpha);
+		calc.setGraph(&graph);
+		calc.SetHyperAnf(log2Registers, seed);
+		std::vector<double>* res = calc.Calculate();
+		result_type features(*res);
+		delete res;
+		return features;
+	}
+};
+
+// The estimated features and their confidence intervals
+struct SampledAttractionBasinDispatch {
+	typedef std::pair<std::vector<double>, std::vector<double> > result_type;
+	int alpha;
+	unsigned int pivots;
+	unsigned int seed;
+	bool stratified;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		AttractionBasinCalculatorT<GraphT> calc(alpha);
+		calc.setGraph(&graph);
+		calc.SetPivotSampling(pivots, seed, stratified);
+		std::vector<double>* res = calc.Calculate();
+		result_type features(*res, calc.GetConfidenceIntervals());
+		delete res;
+		return features;
+	}
+};
+
 py::list AttractionBasinCalculatorWrapper(dict converted_graph,int alpha){
 	ConvertedGNXReciever reciever(converted_graph);
-	AttractionBasinCalculator calc(alpha);
-	calc.setGraph(reciever.getCacheGraph());
-	std::vector<double>* res = calc.Calculate();
-	auto ret_list = vectorToPythonList<double>(*res);
-	delete res;
-	return ret_list;
+	AttractionBasinDispatch dispatch = { alpha };
+	return vectorToPythonList<double>(
+			reciever.toOriginalOrder(reciever.dispatch(dispatch)));
 }
 
+py::list AttractionBasinCalculatorWrapper(dict converted_graph, int alpha,
+		unsigned int NumberOfPivots, unsigned int seed, bool stratified) {
+	ConvertedGNXReciever reciever(converted_graph);
+	SampledAttractionBasinDispatch dispatch = { alpha, NumberOfPivots, seed, stratified };
+	SampledAttractionBasinDispatch::result_type res = reciever.dispatch(dispatch);
+	const std::vector<double> features = reciever.toOriginalOrder(res.first);
+	const std::vector<double> intervals = reciever.toOriginalOrder(res.second);
+	py::list l;
+	for (size_t i = 0; i < features.size(); i++)
+		l.append(py::make_tuple(features[i], intervals[i]));
+	return l;
+}
 
+py::list AttractionBasinHyperAnfWrapper(dict converted_graph, int alpha,
+		unsigned int Log2Registers, unsigned int seed) {
+	ConvertedGNXReciever reciever(converted_graph);
+	HyperAnfAttractionBasinDispatch dispatch = { alpha, Log2Registers, seed };
+	return vectorToPythonList<double>(
+			reciever.toOriginalOrder(reciever.dispatch(dispatch)));
+}
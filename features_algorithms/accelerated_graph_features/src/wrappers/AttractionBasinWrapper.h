@@ -13,6 +13,12 @@
 #include "../includes/AttractionBasinCalculator.h"
 void BoostDefAttractionBasinCalculator();
 py::list AttractionBasinCalculatorWrapper(dict converted_graph,int alpha=2);
+// The features estimated from NumberOfPivots pivots, as (feature, CI) tuples
+py::list AttractionBasinCalculatorWrapper(dict converted_graph, int alpha,
+		unsigned int NumberOfPivots, unsigned int seed, bool stratified);
+// The features estimated by HyperANF, with 2^Log2Registers registers a counter
+py::list AttractionBasinHyperAnfWrapper(dict converted_graph, int alpha,
+		unsigned int Log2Registers, unsigned int seed);
 
 
 #endif /* SRC_WRAPPERS_ATTRACTIONBASINWRAPPER_H_ */
@@ -8,7 +8,12 @@
 #include "BFSMomentsWrapper.h"
 
 void BoostDefBFSMoments() {
-	def("bfs_moments",BFSMomentWrapper);
+	py::list (*exact)(dict) = BFSMomentWrapper;
+	py::list (*sampled)(dict, unsigned int, unsigned int, bool) = BFSMomentWrapper;
+	def("bfs_moments", exact);
+	def("bfs_moments", sampled);
+	def("bfs_moments_hyperanf", BFSMomentHyperAnfWrapper);
+	def("bfs_moments_weighted", BFSMomentWeightedWrapper);
 }
 
 py::list tupleVectorToPythonList(const std::vector<floatTuple>& v){
@@ -26,13 +31,93 @@ py::list tupleVectorToPythonList(const std::vector<floatTuple>& v){
 }
 
 
+/*
+ Runs the calculator on the graph in whichever index widths the reciever picked for it.
+ */
+struct BfsMomentsDispatch {
+	typedef std::vector<floatTuple> result_type;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		BfsMomentsCalculatorT<GraphT> calc;
+		calc.setGraph(&graph);
+		return calc.Calculate();
+	}
+};
+
+// The estimated moments and their confidence intervals
+struct SampledBfsMomentsDispatch {
+	typedef std::pair<std::vector<floatTuple>, std::vector<floatTuple> > result_type;
+	unsigned int pivots;
+	unsigned int seed;
+	bool stratified;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		BfsMomentsCalculatorT<GraphT> calc;
+		calc.setGraph(&graph);
+		calc.SetPivotSampling(pivots, seed, stratified);
+		result_type res;
+		res.first = calc.Calculate();
+		res.second = calc.GetConfidenceIntervals();
+		return res;
+	}
+};
+
+struct HyperAnfBfsMomentsDispatch {
+	typedef std::vector<floatTuple> result_type;
+	unsigned int log2Registers;
+	unsigned int seed;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		BfsMomentsCalculatorT<GraphT> calc;
+		calc.setGraph(&graph);
+		calc.SetHyperAnf(log2Registers, seed);
+		return calc.Calculate();
+	}
+};
+
+struct WeightedBfsMomentsDispatch {
+	typedef std::vector<floatTuple> result_type;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		BfsMomentsCalculatorT<GraphT> calc;
+		calc.setGraph(&graph);
+		calc.SetWeighted(true);
+		return calc.Calculate();
+	}
+};
+
 py::list BFSMomentWrapper(dict converted_dict) {
 
 	ConvertedGNXReciever reciever(converted_dict);
-	BfsMomentsCalculator calc;
-	calc.setGraph(reciever.getCacheGraph());
-//	std::cout<<"After conversion"<<std::endl;
-	std::vector<std::tuple<float, float>> resVec = calc.Calculate();
+	std::vector<std::tuple<float, float>> resVec = reciever.toOriginalOrder(
+			reciever.dispatch(BfsMomentsDispatch()));
 	return tupleVectorToPythonList(resVec);
 
 }
+
+py::list BFSMomentWrapper(dict converted_dict, unsigned int NumberOfPivots,
+		unsigned int seed, bool stratified) {
+	ConvertedGNXReciever reciever(converted_dict);
+	SampledBfsMomentsDispatch dispatch = { NumberOfPivots, seed, stratified };
+	SampledBfsMomentsDispatch::result_type res = reciever.dispatch(dispatch);
+	const std::vector<floatTuple> moments = reciever.toOriginalOrder(res.first);
+	const std::vector<floatTuple> intervals = reciever.toOriginalOrder(res.second);
+	py::list l;
+	for (size_t i = 0; i < moments.size(); i++)
+		l.append(py::make_tuple(std::get<0>(moments[i]), std::get<1>(moments[i]),
+				std::get<0>(intervals[i]), std::get<1>(intervals[i])));
+	return l;
+}
+
+py::list BFSMomentHyperAnfWrapper(dict converted_dict, unsigned int Log2Registers,
+		unsigned int seed) {
+	ConvertedGNXReciever reciever(converted_dict);
+	HyperAnfBfsMomentsDispatch dispatch = { Log2Registers, seed };
+	return tupleVectorToPythonList(reciever.toOriginalOrder(reciever.dispatch(dispatch)));
+}
+
+py::list BFSMomentWeightedWrapper(dict converted_dict) {
+	ConvertedGNXReciever reciever(converted_dict);
+	return tupleVectorToPythonList(
+			reciever.toOriginalOrder(reciever.dispatch(WeightedBfsMomentsDispatch())));
+}
@@ -15,6 +15,14 @@
 void BoostDefBFSMoments();
 
 py::list BFSMomentWrapper(dict converted_dict);
+// The moments estimated from NumberOfPivots pivots, as (mean, std, mean CI, std CI) tuples
+py::list BFSMomentWrapper(dict converted_dict, unsigned int NumberOfPivots,
+		unsigned int seed, bool stratified);
+// The moments estimated by HyperANF, with 2^Log2Registers registers a counter
+py::list BFSMomentHyperAnfWrapper(dict converted_dict, unsigned int Log2Registers,
+		unsigned int seed);
+// The moments of the weighted distances
+py::list BFSMomentWeightedWrapper(dict converted_dict);
 
 
 #endif /* WRAPPERS_BFSMOMENTSWRAPPER_H_ */
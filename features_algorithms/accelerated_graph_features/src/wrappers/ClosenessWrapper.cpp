@@ -0,0 +1,35 @@
+/*
+ * ClosenessWrapper.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "ClosenessWrapper.h"
+
+void BoostDefCloseness() {
+	def("closeness_centrality", ClosenessWrapper);
+}
+
+/*
+ Runs the calculator on the graph in whichever index widths the reciever picked for it.
+ */
+struct ClosenessDispatch {
+	typedef std::vector<double> result_type;
+	bool weighted;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		ClosenessCalculatorT<GraphT> calc(weighted);
+		calc.setGraph(&graph);
+		std::vector<double>* res = calc.Calculate();
+		result_type features(*res);
+		delete res;
+		return features;
+	}
+};
+
+py::list ClosenessWrapper(dict converted_graph, bool weighted) {
+	ConvertedGNXReciever reciever(converted_graph);
+	ClosenessDispatch dispatch = { weighted };
+	return vectorToPythonList<double>(
+			reciever.toOriginalOrder(reciever.dispatch(dispatch)));
+}
@@ -0,0 +1,16 @@
+/*
+ * ClosenessWrapper.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef WRAPPERS_CLOSENESSWRAPPER_H_
+#define WRAPPERS_CLOSENESSWRAPPER_H_
+
+#include "WrapperIncludes.h"
+#include "../includes/ClosenessCalculator.h"
+
+void BoostDefCloseness();
+py::list ClosenessWrapper(dict converted_graph, bool weighted);
+
+#endif /* WRAPPERS_CLOSENESSWRAPPER_H_ */
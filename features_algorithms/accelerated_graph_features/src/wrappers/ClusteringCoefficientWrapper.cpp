@@ -9,12 +9,59 @@
 
 void BoostDefClusteringCoefficient() {
 	def("clustering_coefficient",ClusteringCoefWrapper);
+	py::list (*local)(dict) = LocalClusteringCoefWrapper;
+	py::list (*localOfType)(dict, int) = LocalClusteringCoefWrapper;
+	def("local_clustering_coefficient", local);
+	def("local_clustering_coefficient", localOfType);
+	def("transitivity", TransitivityWrapper);
 }
 
+/*
+ All of the clustering results come from the same pass, see ClusteringCoefficientCalculator.
+ local holds the local clustering coefficients of the requested ClusteringType.
+ */
+struct ClusteringResults {
+	float average;
+	float transitivity;
+	std::vector<float> local;
+};
+
+struct ClusteringDispatch {
+	typedef ClusteringResults result_type;
+	ClusteringType type;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		ClusteringCoefficientCalculatorT<GraphT> calc;
+		calc.setGraph(&graph);
+		ClusteringResults res;
+		res.average = calc.Calculate();
+		res.transitivity = calc.GetTransitivity();
+		res.local = calc.GetLocalClustering(type);
+		return res;
+	}
+};
+
 float ClusteringCoefWrapper(dict converted_dict) {
 	ConvertedGNXReciever reciever(converted_dict);
-	ClusteringCoefficientCalculator calc;
-	calc.setGraph(reciever.getCacheGraph());
-	return calc.Calculate();
+	ClusteringDispatch dispatch = { CLUSTERING_TOTAL };
+	return reciever.dispatch(dispatch).average;
+}
+
+py::list LocalClusteringCoefWrapper(dict converted_dict) {
+	return LocalClusteringCoefWrapper(converted_dict, CLUSTERING_TOTAL);
 }
 
+py::list LocalClusteringCoefWrapper(dict converted_dict, int type) {
+	if (type < 0 || type >= NUMBER_OF_CLUSTERING_TYPES)
+		throw std::out_of_range("Unknown clustering type");
+	ConvertedGNXReciever reciever(converted_dict);
+	ClusteringDispatch dispatch = { static_cast<ClusteringType>(type) };
+	return vectorToPythonList<float>(
+			reciever.toOriginalOrder(reciever.dispatch(dispatch).local));
+}
+
+float TransitivityWrapper(dict converted_dict) {
+	ConvertedGNXReciever reciever(converted_dict);
+	ClusteringDispatch dispatch = { CLUSTERING_TOTAL };
+	return reciever.dispatch(dispatch).transitivity;
+}
@@ -13,6 +13,10 @@
 void BoostDefClusteringCoefficient();
 
 float ClusteringCoefWrapper(dict converted_dict);
+py::list LocalClusteringCoefWrapper(dict converted_dict);
+// The local clustering coefficients of a ClusteringType (Fagiolo's variants for a directed graph)
+py::list LocalClusteringCoefWrapper(dict converted_dict, int type);
+float TransitivityWrapper(dict converted_dict);
 
 
 
@@ -9,15 +9,64 @@
 
 
 void BoostDefFlowCalculator() {
-	def("flow",FlowCalculatorWrapper);
+	py::list (*exact)(dict, double) = FlowCalculatorWrapper;
+	py::list (*sampled)(dict, double, unsigned int, unsigned int, bool) = FlowCalculatorWrapper;
+	def("flow", exact);
+	def("flow", sampled);
 }
 
+/*
+ Runs the calculator on the graph in whichever index widths the reciever picked for it.
+ */
+struct FlowDispatch {
+	typedef std::vector<double> result_type;
+	double threshold;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		FlowCalculatorT<GraphT> calc(threshold);
+		calc.setGraph(&graph);
+		std::vector<double>* res = calc.Calculate();
+		result_type features(*res);
+		delete res;
+		return features;
+	}
+};
+
+// The estimated features and their confidence intervals
+struct SampledFlowDispatch {
+	typedef std::pair<std::vector<double>, std::vector<double> > result_type;
+	double threshold;
+	unsigned int pivots;
+	unsigned int seed;
+	bool stratified;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		FlowCalculatorT<GraphT> calc(threshold);
+		calc.setGraph(&graph);
+		calc.SetPivotSampling(pivots, seed, stratified);
+		std::vector<double>* res = calc.Calculate();
+		result_type features(*res, calc.GetConfidenceIntervals());
+		delete res;
+		return features;
+	}
+};
+
 py::list FlowCalculatorWrapper(dict converted_graph, double threshold) {
 	ConvertedGNXReciever reciever(converted_graph);
-	FlowCalculator calc(threshold);
-	calc.setGraph(reciever.getCacheGraph());
-	std::vector<double>* res = calc.Calculate();
-	auto ret_list = vectorToPythonList<double>(*res);
-	delete res;
-	return ret_list;
+	FlowDispatch dispatch = { threshold };
+	return vectorToPythonList<double>(
+			reciever.toOriginalOrder(reciever.dispatch(dispatch)));
+}
+
+py::list FlowCalculatorWrapper(dict converted_graph, double threshold,
+		unsigned int NumberOfPivots, unsigned int seed, bool stratified) {
+	ConvertedGNXReciever reciever(converted_graph);
+	SampledFlowDispatch dispatch = { threshold, NumberOfPivots, seed, stratified };
+	SampledFlowDispatch::result_type res = reciever.dispatch(dispatch);
+	const std::vector<double> features = reciever.toOriginalOrder(res.first);
+	const std::vector<double> intervals = reciever.toOriginalOrder(res.second);
+	py::list l;
+	for (size_t i = 0; i < features.size(); i++)
+		l.append(py::make_tuple(features[i], intervals[i]));
+	return l;
 }
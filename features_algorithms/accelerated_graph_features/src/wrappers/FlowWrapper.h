@@ -13,6 +13,9 @@
 #include "../includes/FlowCalculator.h"
 void BoostDefFlowCalculator();
 py::list FlowCalculatorWrapper(dict converted_graph,double threshold=0);
+// The features estimated from NumberOfPivots pivots, as (feature, CI) tuples
+py::list FlowCalculatorWrapper(dict converted_graph, double threshold,
+		unsigned int NumberOfPivots, unsigned int seed, bool stratified);
 
 
 #endif /* SRC_WRAPPERS_ATTRACTIONBASINWRAPPER_H_ */
@@ -0,0 +1,60 @@
+/*
+ * KCoreMaintenanceWrapper.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "KCoreMaintenanceWrapper.h"
+
+void BoostDefKCoreMaintenance() {
+	class_<KCoreMaintenanceWrapper, boost::noncopyable>("KCoreMaintenance",
+			init<dict>())
+			.def("insert_edges", &KCoreMaintenanceWrapper::insertEdges)
+			.def("remove_edges", &KCoreMaintenanceWrapper::removeEdges)
+			.def("cores", &KCoreMaintenanceWrapper::cores)
+			.def("touched_nodes", &KCoreMaintenanceWrapper::touchedNodes);
+}
+
+KCoreMaintenanceWrapper::KCoreMaintenanceWrapper(dict converted_graph) {
+	reciever = new ConvertedGNXReciever(converted_graph);
+	maintenance = new KCoreMaintenance(*reciever->getCacheGraph());
+}
+
+std::vector<KCoreMaintenance::Edge> KCoreMaintenanceWrapper::edgesFromList(
+		py::list edges) const {
+	const unsigned int NumberOfNodes = maintenance->GetCores().size();
+	std::vector<KCoreMaintenance::Edge> res;
+	res.reserve(len(edges));
+	for (int i = 0; i < len(edges); ++i) {
+		unsigned int source = extract<unsigned int>(edges[i][0]);
+		unsigned int target = extract<unsigned int>(edges[i][1]);
+		if (source >= NumberOfNodes || target >= NumberOfNodes)
+			throw std::out_of_range("Edge node out of range");
+		res.push_back(
+				KCoreMaintenance::Edge(reciever->toNewId(source),
+						reciever->toNewId(target)));
+	}
+	return res;
+}
+
+int64 KCoreMaintenanceWrapper::insertEdges(py::list edges) {
+	return maintenance->InsertEdges(edgesFromList(edges));
+}
+
+int64 KCoreMaintenanceWrapper::removeEdges(py::list edges) {
+	return maintenance->RemoveEdges(edgesFromList(edges));
+}
+
+py::list KCoreMaintenanceWrapper::cores() const {
+	return vectorToPythonList<unsigned int>(
+			reciever->toOriginalOrder(maintenance->GetCores()));
+}
+
+int64 KCoreMaintenanceWrapper::touchedNodes() const {
+	return maintenance->GetNumberOfTouchedNodes();
+}
+
+KCoreMaintenanceWrapper::~KCoreMaintenanceWrapper() {
+	delete maintenance;
+	delete reciever;
+}
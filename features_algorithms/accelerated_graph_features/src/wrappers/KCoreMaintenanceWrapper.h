@@ -0,0 +1,36 @@
+/*
+ * KCoreMaintenanceWrapper.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef WRAPPERS_KCOREMAINTENANCEWRAPPER_H_
+#define WRAPPERS_KCOREMAINTENANCEWRAPPER_H_
+
+#include "WrapperIncludes.h"
+#include "../includes/KCoreMaintenance.h"
+
+void BoostDefKCoreMaintenance();
+
+/*
+ The KCoreMaintenance class exposed to Python: it is created from a converted graph, and is then
+ given batches of edges (lists of (source, target) tuples) to insert or remove.
+ The nodes are in their original IDs, even if the graph was relabeled.
+ */
+class KCoreMaintenanceWrapper {
+public:
+	KCoreMaintenanceWrapper(dict converted_graph);
+	int64 insertEdges(py::list edges);
+	int64 removeEdges(py::list edges);
+	py::list cores() const;
+	int64 touchedNodes() const;
+	virtual ~KCoreMaintenanceWrapper();
+
+private:
+	std::vector<KCoreMaintenance::Edge> edgesFromList(py::list edges) const;
+
+	ConvertedGNXReciever* reciever;
+	KCoreMaintenance* maintenance;
+};
+
+#endif /* WRAPPERS_KCOREMAINTENANCEWRAPPER_H_ */
@@ -11,11 +11,24 @@ void BoostDefKCore() {
 	def("k_core",KCoreCalculatorWrapper);
 }
 
+/*
+ Runs the calculator on the graph in whichever index widths the reciever picked for it.
+ */
+struct KCoreDispatch {
+	typedef std::vector<unsigned int> result_type;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		KCoreFeatureCalculatorT<GraphT> calc;
+		calc.setGraph(&graph);
+		std::vector<typename GraphT::node_type> cores = calc.Calculate();
+		return result_type(cores.begin(), cores.end());
+	}
+};
+
 boost::python::list KCoreCalculatorWrapper(dict converted_graph) {
 	ConvertedGNXReciever reciever(converted_graph);
-	KCoreFeatureCalculator calc;
-	calc.setGraph(reciever.getCacheGraph());
-	std::vector<unsigned short> vecResults = calc.Calculate();
+	std::vector<unsigned int> vecResults = reciever.toOriginalOrder(
+			reciever.dispatch(KCoreDispatch()));
 //	std::cout<< "After k_core calc"<<std::endl;
-	return vectorToPythonList<unsigned short>(vecResults);
+	return vectorToPythonList<unsigned int>(vecResults);
 }
@@ -16,8 +16,10 @@ py::list MotifCalculatorWrapper(dict converted_dict,int level) {
 //	std::cout << directed <<std::endl;
 	ConvertedGNXReciever reciever(converted_dict);
 	MotifCalculator calc(level,directed);
+	calc.setUseNeighborIndex(extract<bool>(converted_dict.get("neighbor_index", true)));
 	calc.setGraph(reciever.getCacheGraph());
 	vector<vector<unsigned int>*>* res = calc.Calculate();
+	*res = reciever.toOriginalOrder(*res);
 	py::list motif_counters = convertVectorOfVectorsTo2DList(res);
 	for(auto p:*res){
 		delete p;
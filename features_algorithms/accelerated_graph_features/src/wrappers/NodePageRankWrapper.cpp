@@ -9,12 +9,127 @@
 
 void BoostDefNodePageRank() {
 	def("node_page_rank", NodePageRankWrapper);
+	def("node_page_rank", NodePageRankWithToleranceWrapper);
+	def("personalized_page_rank", PersonalizedPageRankWrapper);
+	def("personalized_page_rank_push", PersonalizedPageRankPushWrapper);
 }
 
+/*
+ Runs the calculator on the graph in whichever index widths the reciever picked for it.
+ */
+struct NodePageRankDispatch {
+	typedef std::vector<float> result_type;
+	float dumping;
+	unsigned int numOfIterations;
+	double tolerance;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		NodePageRankFeatureCalculatorT<GraphT> calc(dumping, numOfIterations,
+				tolerance);
+		calc.setGraph(&graph);
+		return calc.Calculate();
+	}
+};
+
 py::list NodePageRankWrapper(dict converted_graph, float dumping, unsigned int numOfIterations) {
+	return NodePageRankWithToleranceWrapper(converted_graph, dumping,
+			numOfIterations, 1e-6);
+}
+
+py::list NodePageRankWithToleranceWrapper(dict converted_graph, float dumping,
+		unsigned int numOfIterations, double tolerance) {
 	ConvertedGNXReciever reciever(converted_graph);
-	NodePageRankFeatureCalculator calc(dumping,numOfIterations);
-	calc.setGraph(reciever.getCacheGraph());
-	std::vector<float> res = calc.Calculate();
+	NodePageRankDispatch dispatch = { dumping, numOfIterations, tolerance };
+	std::vector<float> res = reciever.toOriginalOrder(reciever.dispatch(dispatch));
 	return vectorToPythonList<float>(res);
 }
+
+/*
+ The personalized page ranks are computed on the (possibly relabeled) graph, so the seeds are
+ mapped to the new IDs on the way in, and the results back to the original IDs on the way out.
+ */
+static std::vector<std::vector<unsigned int> > SeedSetsFromList(
+		const ConvertedGNXReciever& reciever, const py::list& seedSets) {
+	std::vector<std::vector<unsigned int> > sets(len(seedSets));
+	for (unsigned int set = 0; set < sets.size(); ++set) {
+		py::list seeds = extract<py::list>(seedSets[set]);
+		for (int i = 0; i < len(seeds); ++i)
+			sets[set].push_back(
+					reciever.toNewId(extract<unsigned int>(seeds[i])));
+	}
+	return sets;
+}
+
+struct PersonalizedPageRankDispatch {
+	typedef std::vector<std::vector<float> > result_type;
+	float dumping;
+	unsigned int numOfIterations;
+	double tolerance;
+	const std::vector<std::vector<unsigned int> >* seedSets;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		typedef typename GraphT::node_type NodeId;
+		std::vector<std::vector<NodeId> > sets;
+		for (const std::vector<unsigned int>& set : *seedSets)
+			sets.push_back(std::vector<NodeId>(set.begin(), set.end()));
+		NodePageRankFeatureCalculatorT<GraphT> calc(dumping, numOfIterations,
+				tolerance);
+		calc.setGraph(&graph);
+		return calc.CalculatePersonalized(sets);
+	}
+};
+
+struct PersonalizedPageRankPushDispatch {
+	typedef std::vector<std::vector<std::pair<unsigned int, float> > > result_type;
+	float dumping;
+	double epsilon;
+	const std::vector<std::vector<unsigned int> >* seedSets;
+	template<typename GraphT>
+	result_type operator()(const GraphT& graph) const {
+		typedef typename GraphT::node_type NodeId;
+		std::vector<std::vector<NodeId> > sets;
+		for (const std::vector<unsigned int>& set : *seedSets)
+			sets.push_back(std::vector<NodeId>(set.begin(), set.end()));
+		NodePageRankFeatureCalculatorT<GraphT> calc(dumping, 0);
+		calc.setGraph(&graph);
+		std::vector<std::vector<std::pair<NodeId, float> > > ranks =
+				calc.CalculatePersonalizedPush(sets, epsilon);
+		result_type res(ranks.size());
+		for (unsigned int set = 0; set < ranks.size(); ++set)
+			res[set].assign(ranks[set].begin(), ranks[set].end());
+		return res;
+	}
+};
+
+py::list PersonalizedPageRankWrapper(dict converted_graph, py::list seedSets,
+		float dumping, unsigned int numOfIterations, double tolerance) {
+	ConvertedGNXReciever reciever(converted_graph);
+	std::vector<std::vector<unsigned int> > sets = SeedSetsFromList(reciever,
+			seedSets);
+	PersonalizedPageRankDispatch dispatch = { dumping, numOfIterations,
+			tolerance, &sets };
+	std::vector<std::vector<float> > ranks = reciever.dispatch(dispatch);
+	py::list res;
+	for (unsigned int set = 0; set < ranks.size(); ++set)
+		res.append(vectorToPythonList<float>(reciever.toOriginalOrder(ranks[set])));
+	return res;
+}
+
+py::list PersonalizedPageRankPushWrapper(dict converted_graph,
+		py::list seedSets, float dumping, double epsilon) {
+	ConvertedGNXReciever reciever(converted_graph);
+	std::vector<std::vector<unsigned int> > sets = SeedSetsFromList(reciever,
+			seedSets);
+	PersonalizedPageRankPushDispatch dispatch = { dumping, epsilon, &sets };
+	std::vector<std::vector<std::pair<unsigned int, float> > > ranks =
+			reciever.dispatch(dispatch);
+	py::list res;
+	for (unsigned int set = 0; set < ranks.size(); ++set) {
+		py::dict setRanks;
+		for (unsigned int i = 0; i < ranks[set].size(); ++i)
+			setRanks[reciever.toOriginalId(ranks[set][i].first)] =
+					ranks[set][i].second;
+		res.append(setRanks);
+	}
+	return res;
+}
@@ -13,6 +13,12 @@
 
 void BoostDefNodePageRank();
 py::list NodePageRankWrapper(dict converted_graph,float dumping, unsigned int numOfIterations);
+py::list NodePageRankWithToleranceWrapper(dict converted_graph, float dumping,
+		unsigned int numOfIterations, double tolerance);
+py::list PersonalizedPageRankWrapper(dict converted_graph, py::list seedSets,
+		float dumping, unsigned int numOfIterations, double tolerance);
+py::list PersonalizedPageRankPushWrapper(dict converted_graph,
+		py::list seedSets, float dumping, double epsilon);
 
 
 